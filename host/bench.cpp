@@ -0,0 +1,41 @@
+/*
+ * Host benchmark driver
+ * Boots the sketch on the host shim and prints the same table the device
+ * prints with BENCHMARK_AT_BOOT. Host "cycles" are nanoseconds (the shim's
+ * ESP.getCycleCount() runs at a nominal 1000 MHz).
+ *
+ * Usage: bench [iterations] [eeprom_file]
+ */
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include "host_hal.h"
+#include "config.h"
+#include "bench.h"
+#include <stdlib.h>
+
+void setup();
+
+// Sketch objects (telescope_altimeter.ino)
+extern TelescopeSensor sensor;
+extern CalibrationManager calibration;
+extern TelescopeDisplay displayManager;
+
+int main(int argc, char** argv) {
+  uint32_t iterations = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 10) : 1000000;
+  if (argc > 2) {
+    // Benchmark against a stored calibration (e.g. from a replay run)
+    EEPROM.hostSetBackingFile(argv[2]);
+  }
+
+  hostSetMpuIntPin(MPU_INT_PIN);
+  hostSetSerialOutput(nullptr);
+  setup();
+
+  // Time the firmware's own work only, not simulated bus transfers
+  hostSetI2cTiming(false);
+  hostSetSerialOutput(stdout);
+
+  runBenchmarks(Serial, iterations, sensor, calibration, displayManager);
+  return 0;
+}
@@ -0,0 +1,125 @@
+/*
+ * Host stress test for the azimuth encoder
+ * Sweeps the simulated encoder's edge rate against the firmware ISR, with a
+ * modelled GPIO interrupt service time and quadrature phase error. Each run
+ * turns forward from rest, then back, and compares the counted ticks with
+ * the true position. A reader thread polls the lock-free counter meanwhile
+ * and checks it never steps backwards while the encoder turns forward.
+ *
+ * Usage: encoder_stress [isr_us] [phase_error] [seconds_per_run]
+ */
+
+#include <Arduino.h>
+#include "host_hal.h"
+#include "azimuth.h"
+#include <atomic>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+
+#define STRESS_PIN_A D6
+#define STRESS_PIN_B D7
+
+// Spin-up from rest before each half of a run
+#define START_TICKS_PER_S 1000.0
+#define START_US 5000
+
+// Edge rates swept (ticks per second)
+static const double rates[] = {1e3, 1e4, 5e4, 1e5, 2e5, 3e5, 4e5, 5e5, 7e5, 1e6};
+
+// Odd while the direction changes; the reader only checks within one epoch
+static std::atomic<uint32_t> epoch(0);
+static std::atomic<int> direction(0);
+static std::atomic<bool> reading(true);
+
+static void reader(uint64_t* reads, uint64_t* backwards) {
+  int32_t previous = azimuthTicks();
+  uint32_t previousEpoch = epoch.load();
+
+  while (reading.load(std::memory_order_relaxed)) {
+    uint32_t before = epoch.load(std::memory_order_acquire);
+    int dir = direction.load(std::memory_order_relaxed);
+    int32_t ticks = azimuthTicks();
+    uint32_t after = epoch.load(std::memory_order_acquire);
+    (*reads)++;
+
+    if (before == after && !(before & 1) && before == previousEpoch && dir > 0 && ticks < previous) {
+      (*backwards)++;
+    }
+    previous = ticks;
+    previousEpoch = after;
+  }
+}
+
+static void setRate(double ticksPerSecond) {
+  epoch.fetch_add(1, std::memory_order_acq_rel);
+  direction.store(ticksPerSecond > 0.0 ? 1 : ticksPerSecond < 0.0 ? -1 : 0);
+  hostSetEncoderRate(ticksPerSecond);
+  epoch.fetch_add(1, std::memory_order_acq_rel);
+}
+
+// Turn at a rate from rest and stop. A shaft speeds up (and reverses)
+// through slow speeds, where single steps set the direction that double
+// edges are counted in.
+static void turn(double ticksPerSecond, uint64_t us) {
+  setRate(ticksPerSecond > 0.0 ? START_TICKS_PER_S : -START_TICKS_PER_S);
+  hostAdvanceMicros(START_US);
+  setRate(ticksPerSecond);
+  hostAdvanceMicros(us);
+  setRate(0.0);
+  hostAdvanceMicros(100);  // Let a pending interrupt finish
+}
+
+int main(int argc, char** argv) {
+  uint32_t isrUs = argc > 1 ? (uint32_t)atoi(argv[1]) : 3;
+  double phaseError = argc > 2 ? atof(argv[2]) : 0.1;
+  double seconds = argc > 3 ? atof(argv[3]) : 0.2;
+
+  hostSetEncoderPins(STRESS_PIN_A, STRESS_PIN_B);
+  hostSetEncoderPhaseError(phaseError);
+  hostSetIsrServiceMicros(isrUs);
+
+  AzimuthEncoder encoder(STRESS_PIN_A, STRESS_PIN_B);
+  encoder.begin();
+
+  uint64_t reads = 0;
+  uint64_t backwards = 0;
+  std::thread thread(reader, &reads, &backwards);
+
+  printf("ISR service %u us, phase error %.2f, %.2f s per run\n", isrUs, phaseError, seconds);
+  printf("%10s %10s %12s %12s %10s %6s\n", "ticks/s", "edges", "fwd error", "back error", "recovered", "lost");
+
+  uint64_t runUs = (uint64_t)(seconds * 1e6);
+  int failedRuns = 0;
+  double highestClean = 0.0;
+
+  for (double rate : rates) {
+    encoder.resetStats();
+    uint64_t edgesBefore = hostEncoderEdges();
+    int64_t offset = azimuthTicks() - hostEncoderPosition();
+
+    turn(rate, runUs / 2);
+    int64_t forwardError = azimuthTicks() - hostEncoderPosition() - offset;
+
+    turn(-rate, runUs / 2);
+    int64_t backError = azimuthTicks() - hostEncoderPosition() - offset - forwardError;
+
+    AzimuthStats stats;
+    encoder.getStats(stats);
+    printf("%10.0f %10llu %12lld %12lld %10u %6u\n", rate, (unsigned long long)(hostEncoderEdges() - edgesBefore),
+           (long long)forwardError, (long long)backError, stats.recovered, stats.lost);
+
+    if (forwardError != 0 || backError != 0) {
+      failedRuns++;
+    } else if (failedRuns == 0) {
+      highestClean = rate;
+    }
+  }
+
+  reading.store(false);
+  thread.join();
+
+  printf("counted exactly up to %.0f ticks/s; reader: %llu reads, %llu backward steps\n", highestClean,
+         (unsigned long long)reads, (unsigned long long)backwards);
+  return 0;
+}
@@ -0,0 +1,388 @@
+/*
+ * Flash trace replay
+ * Memory-maps the trace recorder's blocks - the segment files copied off
+ * the device, or a serial capture of "rec dump" - and feeds every recorded
+ * sample back through the sketch's own readSensor() and updateFilter(),
+ * each at its recorded time through the simulated MPU6050's FIFO and
+ * data-ready interrupt. At every filter record it compares the raw angle
+ * and filtered altitude with the device's, bit for bit.
+ *
+ * Comparison starts at the first filter state record of a session (each
+ * block carries one), after the calibration is known; missing blocks and
+ * dropped records pause it until the next one.
+ *
+ * Usage: flash_replay [options] FILE...
+ *   --csv FILE   write the samples as CSV for replay --trace
+ *   --events     print buttons, UI and power modes and calibrations
+ */
+
+#include <Arduino.h>
+#include "host_hal.h"
+#include "config.h"
+#include "calibration.h"
+#include "filter.h"
+#include "power.h"
+#include "azimuth.h"
+#include "recorder.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#define MAX_REPORTED_MISMATCHES 10
+
+void setup();
+void readSensor();
+void updateFilter();
+
+// Sketch state (telescope_altimeter.ino)
+extern CalibrationManager calibration;
+extern AltitudeFilter altitudeFilter;
+extern PowerManager power;
+extern AzimuthEncoder azimuthEncoder;
+extern TraceRecorder recorder;
+extern float rawAngle;
+extern float filteredAltitude;
+extern float pendingAngleSum;
+extern long pendingRateSum;
+extern int pendingAngleCount;
+extern uint32_t filteredSampleUs;
+
+struct Block {
+  uint32_t sequence;
+  const uint8_t* data;
+};
+
+static const char* buttonNames[] = {"press", "release", "short press", "long press", "double press"};
+
+static uint32_t bits(float value) {
+  uint32_t b;
+  memcpy(&b, &value, sizeof(b));
+  return b;
+}
+
+static bool sameState(const AltitudeFilterState& a, const AltitudeFilterState& b) {
+  return a.state == b.state && a.warmupCount == b.warmupCount && a.biasKnown == b.biasKnown &&
+         a.atRest == b.atRest && bits(a.altitude) == bits(b.altitude) &&
+         bits(a.lastAccelAngle) == bits(b.lastAccelAngle) && bits(a.gyroBias) == bits(b.gyroBias) &&
+         bits(a.speed) == bits(b.speed);
+}
+
+// Valid blocks anywhere in the file: segment files hold nothing else, a
+// capture has text around them
+static bool scanFile(const char* path, std::vector<Block>& blocks) {
+  int fd = open(path, O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) < 0) {
+    fprintf(stderr, "Cannot open %s\n", path);
+    return false;
+  }
+  if (st.st_size < TRACE_BLOCK_SIZE) {
+    close(fd);
+    return true;
+  }
+
+  void* mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    fprintf(stderr, "Cannot map %s\n", path);
+    return false;
+  }
+
+  const uint8_t* data = (const uint8_t*)mapped;
+  size_t size = st.st_size;
+  size_t found = 0;
+  for (size_t offset = 0; offset + TRACE_BLOCK_SIZE <= size;) {
+    uint32_t sequence;
+    if (traceCheckBlock(data + offset, sequence) >= 0) {
+      blocks.push_back({sequence, data + offset});
+      offset += TRACE_BLOCK_SIZE;
+      found++;
+    } else {
+      offset++;
+    }
+  }
+  fprintf(stderr, "%s: %zu blocks\n", path, found);
+  return true;
+}
+
+static void usage() {
+  fprintf(stderr, "Usage: flash_replay [--csv FILE] [--events] FILE...\n");
+}
+
+int main(int argc, char** argv) {
+  FILE* csv = nullptr;
+  bool events = false;
+  std::vector<Block> blocks;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--csv") && i + 1 < argc) {
+      csv = fopen(argv[++i], "w");
+      if (!csv) {
+        fprintf(stderr, "Cannot create %s\n", argv[i]);
+        return 1;
+      }
+    } else if (!strcmp(argv[i], "--events")) {
+      events = true;
+    } else if (argv[i][0] == '-') {
+      usage();
+      return 2;
+    } else if (!scanFile(argv[i], blocks)) {
+      return 1;
+    }
+  }
+  if (blocks.empty()) {
+    usage();
+    return 2;
+  }
+
+#if DECIMATION_RATIO > 1
+  // The trace holds decimator outputs; fed back in they would be decimated again
+  fprintf(stderr, "flash_replay needs a build with OVERSAMPLING 0\n");
+  return 1;
+#endif
+
+  // Oldest first; a block can be in both a segment file and a capture
+  std::stable_sort(blocks.begin(), blocks.end(),
+                   [](const Block& a, const Block& b) { return a.sequence < b.sequence; });
+  blocks.erase(std::unique(blocks.begin(), blocks.end(),
+                           [](const Block& a, const Block& b) { return a.sequence == b.sequence; }),
+               blocks.end());
+
+  // The sketch as on the device, then the sensor on the recorded clock
+  hostSetSerialOutput(nullptr);
+  hostSetMpuIntPin(MPU_INT_PIN);
+  setup();
+  recorder.stop();
+  power.setEnabled(false);
+  hostSetMpuHeld(true);
+  readSensor();
+  pendingAngleSum = 0.0;
+  pendingRateSum = 0;
+  pendingAngleCount = 0;
+
+  // Device micros() + offset = host micros(); only differences reach the filter
+  bool mapped = false;
+  uint32_t offset = 0;
+  auto mapTime = [&](uint32_t deviceUs) {
+    offset = (uint32_t)micros() + 1000 - deviceUs;
+    mapped = true;
+  };
+
+  // Session time for the CSV and the event log
+  uint64_t sessionUs = 0;
+  uint32_t lastDeviceUs = 0;
+  bool haveTime = false;
+  auto logTime = [&](uint32_t deviceUs) {
+    if (haveTime) {
+      int32_t step = (int32_t)(deviceUs - lastDeviceUs);
+      sessionUs += step > 0 ? step : 0;
+    }
+    lastDeviceUs = deviceUs;
+    haveTime = true;
+    return sessionUs / 1e6;
+  };
+
+  int undrained = 0;
+  auto drain = [&]() {
+    if (undrained > 0) {
+      readSensor();
+      undrained = 0;
+    }
+  };
+  auto discardPending = [&]() {
+    drain();
+    pendingAngleSum = 0.0;
+    pendingRateSum = 0;
+    pendingAngleCount = 0;
+  };
+
+  bool haveCalibration = false;
+  bool synced = false;
+  uint64_t samples = 0;
+  uint64_t filterRuns = 0;
+  uint64_t compared = 0;
+  uint64_t exact = 0;
+  uint64_t resyncs = 0;
+  uint64_t missingBlocks = 0;
+  uint64_t droppedRecords = 0;
+
+  if (csv) {
+    fprintf(csv, "time_us,ax,ay,az,gx,gy,gz\n");
+  }
+
+  for (size_t b = 0; b < blocks.size(); b++) {
+    if (b > 0 && blocks[b].sequence != blocks[b - 1].sequence + 1) {
+      missingBlocks += blocks[b].sequence - blocks[b - 1].sequence - 1;
+      synced = false;
+    }
+
+    TraceBlockReader reader(blocks[b].data);
+    TraceRecord r;
+    while (reader.next(r)) {
+      switch (r.type) {
+        case TRACE_RECORD_KEYFRAME:
+        case TRACE_RECORD_SAMPLE: {
+          if (!mapped) {
+            mapTime(r.timeUs);
+          }
+          int32_t ahead = (int32_t)(r.timeUs + offset - (uint32_t)micros());
+          if (ahead < 0) {
+            // Time went backwards (a reboot the trace did not mark)
+            discardPending();
+            mapTime(r.timeUs);
+            ahead = 1000;
+            synced = false;
+          }
+          hostAdvanceMicros(ahead);
+
+          const RawSample& raw = r.sample.raw;
+          int16_t counts[6] = {raw.ax, raw.ay, raw.az, raw.gx, raw.gy, raw.gz};
+          hostMpuEmitSample(counts);
+          samples++;
+          if (++undrained >= FIFO_BURST_SAMPLES) {
+            drain();
+          }
+
+          double t = logTime(r.timeUs);
+          if (csv) {
+            fprintf(csv, "%llu,%d,%d,%d,%d,%d,%d\n", (unsigned long long)(t * 1e6 + 0.5), raw.ax, raw.ay, raw.az,
+                    raw.gx, raw.gy, raw.gz);
+          }
+          break;
+        }
+
+        case TRACE_RECORD_FILTER:
+        case TRACE_RECORD_FILTER_STATE:
+          filterRuns++;
+          drain();
+          if (synced) {
+            // The same samples in the same batch: the same bits
+            compared++;
+            bool same = false;
+            if (pendingAngleCount > 0) {
+              updateFilter();
+              same = bits(rawAngle) == bits(r.rawAngle) && bits(filteredAltitude) == bits(r.filteredAltitude);
+              if (r.type == TRACE_RECORD_FILTER_STATE) {
+                AltitudeFilterState state;
+                altitudeFilter.getState(state);
+                same = same && sameState(state, r.filter) && filteredSampleUs == r.filteredSampleUs + offset;
+              }
+            }
+            if (same) {
+              exact++;
+            } else if (compared - exact <= MAX_REPORTED_MISMATCHES) {
+              printf("block %u: raw %.6f vs %.6f, filtered %.6f vs %.6f (host vs device)\n", blocks[b].sequence,
+                     rawAngle, r.rawAngle, filteredAltitude, r.filteredAltitude);
+            }
+          } else if (r.type == TRACE_RECORD_FILTER_STATE && haveCalibration) {
+            // Pick the filter up where the device had it
+            if (!mapped) {
+              mapTime(r.filteredSampleUs);
+            }
+            discardPending();
+            altitudeFilter.setState(r.filter);
+            rawAngle = r.rawAngle;
+            filteredAltitude = r.filteredAltitude;
+            filteredSampleUs = r.filteredSampleUs + offset;
+            synced = true;
+            resyncs++;
+          } else {
+            discardPending();
+          }
+          break;
+
+        case TRACE_RECORD_SEGMENT:
+          if (r.kind & TRACE_SEGMENT_SESSION) {
+            // Rebooted or restarted: a new clock and no filter history
+            discardPending();
+            mapped = false;
+            synced = false;
+            haveTime = false;
+            sessionUs += 1000000;
+          }
+          if (events) {
+            printf("%10.3f s  segment (block %u)%s\n", logTime(r.timeUs), blocks[b].sequence,
+                   (r.kind & TRACE_SEGMENT_SESSION) ? ", new session" : "");
+          }
+          break;
+
+        case TRACE_RECORD_CALIBRATION:
+          drain();
+          calibration.restoreRecord(r.calibration);
+          azimuthEncoder.setCalibration(r.calibration.azimuth);
+          haveCalibration = true;
+          if (events) {
+            printf("%10.3f s  calibration: %s, zero %.4f, stops %.4f / %.4f, %d ticks/rev\n", logTime(r.timeUs),
+                   calibration.isCalibrated() ? "calibrated" : "not calibrated", r.calibration.zeroOffset,
+                   r.calibration.stopA_raw, r.calibration.stopB_raw, (int)r.calibration.azimuth.ticksPerRev);
+          }
+          break;
+
+        case TRACE_RECORD_FILTER_RESET:
+          drain();
+          altitudeFilter.reset();
+          if (events) {
+            printf("%10.3f s  filter reset\n", logTime(r.timeUs));
+          }
+          break;
+
+        case TRACE_RECORD_POWER:
+          drain();
+          if (r.previous == POWER_IDLE) {
+            // As onPowerModeChange(): the FIFO restarted at this time
+            if (!mapped) {
+              mapTime(r.timeUs);
+            }
+            discardPending();
+            filteredSampleUs = r.timeUs + offset;
+          }
+          if (events && r.previous < POWER_MODE_COUNT && r.kind < POWER_MODE_COUNT) {
+            printf("%10.3f s  power %s -> %s\n", logTime(r.timeUs), powerModeName((PowerMode)r.previous),
+                   powerModeName((PowerMode)r.kind));
+          }
+          break;
+
+        case TRACE_RECORD_BUTTON:
+          if (events && r.kind < sizeof(buttonNames) / sizeof(buttonNames[0])) {
+            printf("%10.3f s  button %s", logTime(r.timeUs), buttonNames[r.kind]);
+            if (r.kind == BUTTON_RELEASE || r.kind == BUTTON_SHORT_PRESS) {
+              printf(" (%u ms)", r.amount);
+            }
+            printf("\n");
+          }
+          break;
+
+        case TRACE_RECORD_UI_MODE:
+          if (events) {
+            printf("%10.3f s  UI mode %u\n", logTime(r.timeUs), r.kind);
+          }
+          break;
+
+        case TRACE_RECORD_GAP:
+          droppedRecords += r.amount;
+          synced = false;
+          if (events) {
+            printf("           %u records dropped on the device\n", r.amount);
+          }
+          break;
+      }
+    }
+  }
+
+  if (csv) {
+    fclose(csv);
+  }
+
+  printf("%zu blocks (%u..%u, %llu missing), %llu samples, %llu records dropped on the device\n", blocks.size(),
+         blocks.front().sequence, blocks.back().sequence, (unsigned long long)missingBlocks,
+         (unsigned long long)samples, (unsigned long long)droppedRecords);
+  printf("%llu filter runs, %llu compared after %llu resyncs: %llu bit-exact, %llu differ\n",
+         (unsigned long long)filterRuns, (unsigned long long)compared, (unsigned long long)resyncs,
+         (unsigned long long)exact, (unsigned long long)(compared - exact));
+  return compared == exact ? 0 : 1;
+}
@@ -0,0 +1,37 @@
+# Code and static data of each pipeline preset (run by the footprint target)
+# size(1) on each preset binary: text is code and constants (flash on the
+# device), data + bss the statically allocated RAM. The binaries are x86-64
+# and include the host shim, so compare presets with each other; the
+# Arduino build prints the ESP8266 figures.
+
+if(NOT SIZE_TOOL)
+  message(FATAL_ERROR "size(1) not found")
+endif()
+
+message("Preset            Code (B)   Static RAM (B)")
+list(LENGTH PRESETS COUNT)
+math(EXPR LAST "${COUNT} - 1")
+foreach(INDEX RANGE ${LAST})
+  list(GET PRESETS ${INDEX} PRESET)
+  list(GET FILES ${INDEX} FILE)
+  execute_process(COMMAND ${SIZE_TOOL} ${FILE}
+                  OUTPUT_VARIABLE OUTPUT
+                  RESULT_VARIABLE RESULT)
+  if(NOT RESULT EQUAL 0)
+    message(FATAL_ERROR "size failed on ${FILE}")
+  endif()
+
+  # Second line: text data bss dec hex filename
+  string(STRIP "${OUTPUT}" OUTPUT)
+  string(REGEX MATCH "[^\n]*$" TOTALS "${OUTPUT}")
+  string(REGEX MATCHALL "[0-9]+" FIELDS "${TOTALS}")
+  list(GET FIELDS 0 TEXT)
+  list(GET FIELDS 1 DATA)
+  list(GET FIELDS 2 BSS)
+  math(EXPR RAM "${DATA} + ${BSS}")
+
+  string(LENGTH "${PRESET}" LENGTH)
+  math(EXPR PAD "18 - ${LENGTH}")
+  string(REPEAT " " ${PAD} SPACES)
+  message("${PRESET}${SPACES}${TEXT}     ${RAM}")
+endforeach()
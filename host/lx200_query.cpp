@@ -0,0 +1,139 @@
+/*
+ * LX200 query tool
+ * Sends LX200 commands to a serial device (the real altimeter, or the host
+ * build's pseudo-terminal from 'replay --pty') and prints each reply with
+ * its round-trip time
+ *
+ * Usage: lx200_query [--count N] [--interval MS] DEVICE [COMMAND...]
+ *   COMMAND defaults to :GA#; "ACK" sends 0x06. Commands without a reply
+ *   (e.g. :U#) are sent and not waited for.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// Replies end in '#', except the one-character ACK reply
+#define REPLY_TIMEOUT_MS 1000
+
+static bool expectsReply(const std::string& command) {
+  return command == "ACK" || command == ":GA#" || command == ":GZ#" || command == ":GVP#" || command == ":GVN#";
+}
+
+// Read one reply; returns false on timeout. Text lines the firmware prints
+// (log output) are skipped.
+static bool readReply(int fd, bool ack, std::string& reply) {
+  reply.clear();
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(REPLY_TIMEOUT_MS);
+
+  while (std::chrono::steady_clock::now() < deadline) {
+    struct pollfd p = {fd, POLLIN, 0};
+    int left = (int)std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+    if (poll(&p, 1, std::max(left, 0)) <= 0) {
+      break;
+    }
+
+    char c;
+    if (read(fd, &c, 1) != 1) {
+      continue;
+    }
+    if (c == '\n' || c == '\r') {
+      reply.clear();  // End of a log line, not a reply
+      continue;
+    }
+    reply.push_back(c);
+    if (c == '#' || (ack && reply == "A")) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int main(int argc, char** argv) {
+  int count = 1;
+  int intervalMs = 100;
+  const char* device = nullptr;
+  std::vector<std::string> commands;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--count") && i + 1 < argc) {
+      count = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--interval") && i + 1 < argc) {
+      intervalMs = atoi(argv[++i]);
+    } else if (!device) {
+      device = argv[i];
+    } else {
+      commands.push_back(argv[i]);
+    }
+  }
+  if (!device) {
+    fprintf(stderr, "Usage: lx200_query [--count N] [--interval MS] DEVICE [COMMAND...]\n");
+    return 2;
+  }
+  if (commands.empty()) {
+    commands.push_back(":GA#");
+  }
+
+  int fd = open(device, O_RDWR | O_NOCTTY);
+  if (fd < 0) {
+    fprintf(stderr, "Cannot open %s\n", device);
+    return 1;
+  }
+  struct termios tio;
+  if (tcgetattr(fd, &tio) == 0) {
+    cfmakeraw(&tio);
+    cfsetspeed(&tio, B115200);
+    tcsetattr(fd, TCSANOW, &tio);
+  }
+  tcflush(fd, TCIFLUSH);
+
+  std::vector<double> roundTrips;
+  int timeouts = 0;
+
+  for (int n = 0; n < count; n++) {
+    for (const std::string& command : commands) {
+      bool ack = command == "ACK";
+      const char ackByte = 0x06;
+      auto start = std::chrono::steady_clock::now();
+      if (ack) {
+        write(fd, &ackByte, 1);
+      } else {
+        write(fd, command.data(), command.size());
+      }
+      if (!expectsReply(command)) {
+        continue;
+      }
+
+      std::string reply;
+      if (!readReply(fd, ack, reply)) {
+        printf("%-6s (no reply)\n", command.c_str());
+        timeouts++;
+        continue;
+      }
+      double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      roundTrips.push_back(ms);
+      printf("%-6s %-22s %7.2f ms\n", command.c_str(), reply.c_str(), ms);
+    }
+    if (n + 1 < count) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+    }
+  }
+
+  close(fd);
+
+  if (!roundTrips.empty()) {
+    std::sort(roundTrips.begin(), roundTrips.end());
+    fprintf(stderr, "%zu replies, %d timeouts; round trip min %.2f / p50 %.2f / max %.2f ms\n", roundTrips.size(), timeouts,
+            roundTrips.front(), roundTrips[roundTrips.size() / 2], roundTrips.back());
+  }
+  return timeouts > 0 ? 1 : 0;
+}
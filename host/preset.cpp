@@ -0,0 +1,26 @@
+/*
+ * Pipeline preset build
+ * The sketch on its own, as the ESP8266 core runs it: setup(), then loop().
+ * CMakeLists.txt builds it once per preset and links it with unused
+ * sections dropped, like the device build, to measure what each
+ * configuration puts in the binary. Running it prints the boot report
+ * (sensor scales and the selected pipeline) against the simulated sensor.
+ */
+
+#include <Arduino.h>
+#include "host_hal.h"
+
+// Loop pass cost on the virtual clock (as replay's --loop-us default)
+#define PRESET_LOOP_US 250
+
+void setup();
+void loop();
+
+int main() {
+  setup();
+  while (millis() < 3000) {
+    loop();
+    hostAdvanceMicros(PRESET_LOOP_US);
+  }
+  return 0;
+}
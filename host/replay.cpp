@@ -0,0 +1,377 @@
+/*
+ * Host replay driver
+ * Runs the real sketch (setup/loop, scheduler, sensor, filter, UI) against
+ * a recorded or synthetic motion trace and a scripted button, as fast as
+ * the host allows, and writes the displayed altitude as CSV
+ *
+ * Usage: replay [options]
+ *   --trace FILE        recorded CSV trace (time_us,ax,ay,az,gx,gy,gz)
+ *   --profile SPEC      synthetic profile, e.g. hold:10:5,slew:10:40:5,hold:40:5
+ *   --noise G:DPS       synthetic accel/gyro noise RMS (default 0.004:0.05)
+ *   --noise-density UG:MDPS  model noise inside the sensor instead (shaped by
+ *                       its DLPF; MPU6050 typical 400:5), replacing --noise
+ *   --gyro-bias DPS     synthetic gyro bias about the tilt axis
+ *   --roll DEG          synthetic sensor roll about the tube
+ *   --seed N            noise seed (synthetic and in-sensor)
+ *   --press MS:HOLD     press the button at MS for HOLD ms (repeatable)
+ *   --send MS:TEXT      type a serial command line at MS (repeatable)
+ *   --encoder MS:RATE   turn the simulated azimuth encoder at RATE ticks/s
+ *                       from MS on (repeatable); adds encoder (true ticks),
+ *                       ticks (counted) and azimuth columns
+ *   --isr-us US         GPIO interrupt service time for the encoder (default 3)
+ *   --no-int            leave the MPU6050 INT line unconnected
+ *   --duration S        simulated seconds (default: trace length + 1)
+ *   --every MS          output interval (default 100)
+ *   --loop-us US        virtual time per idle loop() pass (default 250)
+ *   --eeprom FILE       persist EEPROM contents in FILE
+ *   --flash DIR         keep LittleFS files (the flash trace) in DIR
+ *   --serial            echo firmware Serial output to stderr
+ *   --serial-file FILE  write firmware Serial output (e.g. telemetry) to FILE
+ *   --pty               connect firmware Serial to a new pseudo-terminal (its
+ *                       path is printed) and run in real time, so a
+ *                       planetarium program or host/lx200_query can talk to it
+ *   --realtime          pace the virtual clock to the wall clock
+ */
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include "host_hal.h"
+#include "config.h"
+#include "display.h"
+#include "azimuth.h"
+#include "trace.h"
+#include <chrono>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+void setup();
+void loop();
+
+// Sketch state (telescope_altimeter.ino)
+extern float rawAngle;
+extern float filteredAltitude;
+extern float currentAzimuth;
+extern UIMode currentMode;
+
+struct Press {
+  uint64_t atMs;
+  uint64_t holdMs;
+};
+
+struct EncoderStep {
+  uint64_t atMs;
+  double ticksPerSecond;
+};
+
+struct Command {
+  uint64_t atMs;
+  std::string text;
+};
+
+static void usage() {
+  fprintf(stderr,
+          "Usage: replay [--trace FILE | --profile SPEC] [--noise G:DPS] [--noise-density UG:MDPS]\n"
+          "              [--gyro-bias DPS] [--roll DEG] [--seed N]\n"
+          "              [--press MS:HOLD]... [--send MS:TEXT]... [--encoder MS:RATE]... [--isr-us US]\n"
+          "              [--duration S] [--every MS] [--loop-us US] [--eeprom FILE] [--flash DIR]\n"
+          "              [--serial | --serial-file FILE | --pty] [--realtime] [--no-int]\n");
+}
+
+// Open a pseudo-terminal for the firmware's Serial. The slave end stays
+// open in raw mode (no echo or line editing, as on a real UART), which also
+// keeps the master readable before a client connects.
+static int openSerialPty() {
+  int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0) {
+    return -1;
+  }
+
+  const char* slavePath = ptsname(master);
+  int slave = slavePath ? open(slavePath, O_RDWR | O_NOCTTY) : -1;
+  if (slave < 0) {
+    close(master);
+    return -1;
+  }
+  struct termios tio;
+  tcgetattr(slave, &tio);
+  cfmakeraw(&tio);
+  tcsetattr(slave, TCSANOW, &tio);
+
+  fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+  fprintf(stderr, "Serial on %s\n", slavePath);
+  return master;
+}
+
+int main(int argc, char** argv) {
+  RecordedTrace recorded;
+  SyntheticTrace synthetic;
+  bool useRecorded = false;
+  bool haveProfile = false;
+  std::vector<Press> presses;
+  std::vector<Command> commands;
+  std::vector<EncoderStep> encoderSteps;
+  uint32_t isrUs = 3;
+  double durationS = 0.0;
+  uint64_t everyMs = 100;
+  uint64_t loopUs = 250;
+  FILE* serialFile = nullptr;
+  bool realtime = false;
+  bool intWired = true;
+  bool noiseDensity = false;
+  double densityAccel = 0.0;
+  double densityGyro = 0.0;
+
+  // stdout carries the CSV; firmware Serial output is opt-in
+  hostSetSerialOutput(nullptr);
+
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+    if (!strcmp(arg, "--serial")) {
+      hostSetSerialOutput(stderr);
+      continue;
+    }
+    if (!strcmp(arg, "--pty")) {
+      int fd = openSerialPty();
+      if (fd < 0) {
+        fprintf(stderr, "Cannot open a pseudo-terminal\n");
+        return 1;
+      }
+      hostSetSerialFd(fd);
+      realtime = true;
+      continue;
+    }
+    if (!strcmp(arg, "--realtime")) {
+      realtime = true;
+      continue;
+    }
+    if (!strcmp(arg, "--no-int")) {
+      intWired = false;
+      continue;
+    }
+    if (!value) {
+      usage();
+      return 2;
+    }
+    i++;
+
+    if (!strcmp(arg, "--trace")) {
+      if (!recorded.load(value)) {
+        fprintf(stderr, "Cannot read trace %s\n", value);
+        return 1;
+      }
+      useRecorded = true;
+    } else if (!strcmp(arg, "--profile")) {
+      if (!synthetic.parse(value)) {
+        return 1;
+      }
+      haveProfile = true;
+    } else if (!strcmp(arg, "--noise")) {
+      double accelG = 0.0, gyroDps = 0.0;
+      sscanf(value, "%lf:%lf", &accelG, &gyroDps);
+      synthetic.setNoise(accelG, gyroDps);
+    } else if (!strcmp(arg, "--noise-density")) {
+      double accelMicroG = 0.0, gyroMilliDps = 0.0;
+      sscanf(value, "%lf:%lf", &accelMicroG, &gyroMilliDps);
+      noiseDensity = true;
+      densityAccel = accelMicroG;
+      densityGyro = gyroMilliDps;
+    } else if (!strcmp(arg, "--gyro-bias")) {
+      synthetic.setGyroBias(atof(value));
+    } else if (!strcmp(arg, "--roll")) {
+      synthetic.setRoll(atof(value));
+    } else if (!strcmp(arg, "--seed")) {
+      synthetic.setSeed((uint32_t)strtoul(value, nullptr, 10));
+      hostSetMpuNoiseSeed((uint32_t)strtoul(value, nullptr, 10));
+    } else if (!strcmp(arg, "--press")) {
+      Press press;
+      unsigned long long atMs, holdMs;
+      if (sscanf(value, "%llu:%llu", &atMs, &holdMs) != 2) {
+        usage();
+        return 2;
+      }
+      press.atMs = atMs;
+      press.holdMs = holdMs;
+      presses.push_back(press);
+    } else if (!strcmp(arg, "--send")) {
+      const char* colon = strchr(value, ':');
+      if (!colon) {
+        usage();
+        return 2;
+      }
+      Command command;
+      command.atMs = strtoull(value, nullptr, 10);
+      command.text = std::string(colon + 1) + "\n";
+      commands.push_back(command);
+    } else if (!strcmp(arg, "--encoder")) {
+      EncoderStep step;
+      unsigned long long atMs;
+      if (sscanf(value, "%llu:%lf", &atMs, &step.ticksPerSecond) != 2) {
+        usage();
+        return 2;
+      }
+      step.atMs = atMs;
+      encoderSteps.push_back(step);
+    } else if (!strcmp(arg, "--isr-us")) {
+      isrUs = (uint32_t)strtoul(value, nullptr, 10);
+    } else if (!strcmp(arg, "--duration")) {
+      durationS = atof(value);
+    } else if (!strcmp(arg, "--every")) {
+      everyMs = strtoull(value, nullptr, 10);
+    } else if (!strcmp(arg, "--loop-us")) {
+      loopUs = strtoull(value, nullptr, 10);
+    } else if (!strcmp(arg, "--serial-file")) {
+      serialFile = fopen(value, "wb");
+      if (!serialFile) {
+        fprintf(stderr, "Cannot create %s\n", value);
+        return 1;
+      }
+      hostSetSerialOutput(serialFile);
+    } else if (!strcmp(arg, "--eeprom")) {
+      EEPROM.hostSetBackingFile(value);
+    } else if (!strcmp(arg, "--flash")) {
+      hostSetFsDirectory(value);
+    } else {
+      usage();
+      return 2;
+    }
+  }
+
+  if (!useRecorded && !haveProfile) {
+    synthetic.parse("hold:0:10");
+  }
+
+  uint64_t traceUs = useRecorded ? recorded.durationUs() : synthetic.durationUs();
+  uint64_t endUs = durationS > 0.0 ? (uint64_t)(durationS * 1e6) : traceUs + 1000000;
+  if (everyMs == 0) everyMs = 1;
+  if (loopUs == 0) loopUs = 1;
+
+  if (useRecorded) {
+    hostSetSampleSource([&](uint64_t us, int16_t s[6]) { recorded.sampleAt(us, s); });
+  } else {
+    hostSetSampleSource([&](uint64_t us, int16_t s[6]) { synthetic.sampleAt(us, s); });
+  }
+  if (intWired) {
+    hostSetMpuIntPin(MPU_INT_PIN);
+  }
+  if (noiseDensity) {
+    synthetic.setNoise(0.0, 0.0);
+    hostSetMpuNoiseDensity(densityAccel, densityGyro);
+  }
+
+  bool encoder = !encoderSteps.empty();
+  if (encoder) {
+    hostSetEncoderPins(AZIMUTH_PIN_A, AZIMUTH_PIN_B);
+    hostSetEncoderPhaseError(0.1);
+    hostSetIsrServiceMicros(isrUs);
+  }
+
+  auto wallStart = std::chrono::steady_clock::now();
+
+  setup();
+
+  if (useRecorded) {
+    printf("time_ms,raw,filtered,mode%s\n", encoder ? ",encoder,ticks,azimuth" : "");
+  } else {
+    printf("time_ms,truth,raw,filtered,mode%s\n", encoder ? ",encoder,ticks,azimuth" : "");
+  }
+
+  uint64_t nextOutMs = hostNowMicros() / 1000;
+  size_t nextPress = 0;
+  size_t nextCommand = 0;
+  size_t nextEncoderStep = 0;
+  bool pressed = false;
+  uint64_t releaseMs = 0;
+
+  // Button and serial script (active low, internal pull-up)
+  auto runScript = [&]() {
+    uint64_t nowMs = hostNowMicros() / 1000;
+    if (pressed && nowMs >= releaseMs) {
+      hostSetPin(BUTTON_PIN, HIGH);
+      pressed = false;
+    }
+    if (!pressed && nextPress < presses.size() && nowMs >= presses[nextPress].atMs) {
+      hostSetPin(BUTTON_PIN, LOW);
+      pressed = true;
+      releaseMs = nowMs + presses[nextPress].holdMs;
+      nextPress++;
+    }
+
+    if (nextCommand < commands.size() && nowMs >= commands[nextCommand].atMs) {
+      hostSerialInject(commands[nextCommand].text.c_str(), commands[nextCommand].text.size());
+      nextCommand++;
+    }
+
+    if (nextEncoderStep < encoderSteps.size() && nowMs >= encoderSteps[nextEncoderStep].atMs) {
+      hostSetEncoderRate(encoderSteps[nextEncoderStep].ticksPerSecond);
+      nextEncoderStep++;
+    }
+  };
+
+  // Output on the virtual clock, which keeps running in light sleep
+  auto writeOutput = [&]() {
+    uint64_t nowMs = hostNowMicros() / 1000;
+    if (nowMs >= nextOutMs) {
+      if (useRecorded) {
+        printf("%llu,%.4f,%.4f,%d", (unsigned long long)nowMs, rawAngle, filteredAltitude, (int)currentMode);
+      } else {
+        printf("%llu,%.4f,%.4f,%.4f,%d", (unsigned long long)nowMs, synthetic.altitudeAt(nowMs / 1000.0),
+               rawAngle, filteredAltitude, (int)currentMode);
+      }
+      if (encoder) {
+        printf(",%lld,%d,%.4f", (long long)hostEncoderPosition(), (int)azimuthTicks(), currentAzimuth);
+      }
+      printf("\n");
+      nextOutMs = nowMs + everyMs;
+    }
+  };
+
+  // Stay in step with the wall clock (a client times out otherwise)
+  auto pace = [&]() {
+    if (realtime) {
+      auto due = wallStart + std::chrono::microseconds(hostNowMicros());
+      if (due > std::chrono::steady_clock::now()) {
+        std::this_thread::sleep_until(due);
+      }
+    }
+  };
+
+  // The script and the output keep going while the firmware sleeps
+  hostSetSleepHook([&]() {
+    runScript();
+    writeOutput();
+    pace();
+    return hostNowMicros() < endUs;
+  });
+
+  while (hostNowMicros() < endUs) {
+    runScript();
+    loop();
+    hostAdvanceMicros(loopUs);
+    writeOutput();
+
+    pace();
+  }
+
+  double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  double simS = hostNowMicros() / 1e6;
+  fprintf(stderr,
+          "Simulated %.1f s in %.3f s wall (%.0fx real time), %llu samples, %llu I2C bytes, %u EEPROM commits, "
+          "%.1f s in light sleep, %.2f s writing flash\n",
+          simS, wallS, wallS > 0.0 ? simS / wallS : 0.0, (unsigned long long)hostMpuSamplesProduced(),
+          (unsigned long long)hostI2cBytes(), EEPROM.hostCommitCount(), hostSleptMicros() / 1e6,
+          hostFlashBusyMicros() / 1e6);
+
+  if (serialFile) {
+    fclose(serialFile);
+  }
+  return 0;
+}
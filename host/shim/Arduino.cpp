@@ -0,0 +1,438 @@
+/*
+ * Host stand-in for the ESP8266 Arduino core - implementation
+ */
+
+#include "Arduino.h"
+#include "host_hal.h"
+#include "user_interface.h"
+#include "gpio.h"
+#include <chrono>
+#include <deque>
+#include <errno.h>
+#include <stdio.h>
+#include <unistd.h>
+
+// Implemented by the simulated MPU6050 and quadrature encoder
+void hostMpuAdvanceTo(uint64_t nowUs);
+void hostEncoderAdvanceTo(uint64_t nowUs);
+uint64_t hostEncoderNextEventUs();
+
+HardwareSerial Serial;
+EspClass ESP;
+
+// ==================== VIRTUAL CLOCK ====================
+
+static uint64_t nowUs = 0;
+static uint64_t pendingUs = 0;
+static bool advancing = false;
+static uint32_t yieldUs = 20;
+static bool i2cTiming = true;
+static uint32_t i2cClockHz = 400000;
+static uint64_t i2cBytes = 0;
+static uint64_t sleptUs = 0;  // System timer stands still in light sleep
+
+static void lightSleep();
+static bool lightSleepArmed = false;
+
+uint64_t hostNowMicros() {
+  return nowUs;
+}
+
+void hostAdvanceMicros(uint64_t us) {
+  if (advancing) {
+    // Called from a simulated peripheral or ISR - settle after the current step
+    pendingUs += us;
+    return;
+  }
+
+  advancing = true;
+  uint64_t target = nowUs + us;
+  while (nowUs < target) {
+    // Step in small increments so peripherals see a monotonic clock
+    uint64_t step = target - nowUs;
+    if (step > 100) step = 100;
+
+    // ...and stop at each encoder edge, so its ISR sees the edge's time
+    uint64_t encoderUs = hostEncoderNextEventUs();
+    if (encoderUs > nowUs && encoderUs - nowUs < step) {
+      step = encoderUs - nowUs;
+    }
+    nowUs += step;
+    hostMpuAdvanceTo(nowUs);
+    hostEncoderAdvanceTo(nowUs);
+
+    target += pendingUs;
+    pendingUs = 0;
+  }
+  advancing = false;
+}
+
+void hostSetYieldMicros(uint32_t us) {
+  yieldUs = us;
+}
+
+void hostSetI2cClock(uint32_t hz) {
+  i2cClockHz = hz ? hz : 100000;
+}
+
+void hostChargeI2c(uint32_t bytes) {
+  i2cBytes += bytes;
+  if (i2cTiming) {
+    // 9 clock cycles per byte (8 data bits + ACK)
+    hostAdvanceMicros((uint64_t)bytes * 9 * 1000000 / i2cClockHz);
+  }
+}
+
+void hostSetI2cTiming(bool enabled) {
+  i2cTiming = enabled;
+}
+
+uint64_t hostI2cBytes() {
+  return i2cBytes;
+}
+
+unsigned long millis() {
+  return (unsigned long)(uint32_t)((nowUs - sleptUs) / 1000);
+}
+
+unsigned long micros() {
+  return (unsigned long)(uint32_t)(nowUs - sleptUs);
+}
+
+void delay(unsigned long ms) {
+  // The SDK enters a requested forced light sleep from the idle task, i.e.
+  // inside delay(); the delay itself only runs on after the wake-up
+  if (lightSleepArmed) {
+    lightSleep();
+  }
+  hostAdvanceMicros((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us) {
+  hostAdvanceMicros(us);
+}
+
+void yield() {
+  hostAdvanceMicros(yieldUs);
+}
+
+// ==================== GPIO ====================
+
+#define HOST_NUM_PINS 17
+
+static int pinLevels[HOST_NUM_PINS];
+static void (*pinHandlers[HOST_NUM_PINS])(void);
+static int pinHandlerModes[HOST_NUM_PINS];
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (pin < HOST_NUM_PINS && mode == INPUT_PULLUP) {
+    pinLevels[pin] = HIGH;
+  }
+}
+
+int digitalRead(uint8_t pin) {
+  return pin < HOST_NUM_PINS ? pinLevels[pin] : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  if (pin < HOST_NUM_PINS) {
+    pinLevels[pin] = value ? HIGH : LOW;
+  }
+}
+
+void attachInterrupt(uint8_t interruptNum, void (*handler)(void), int mode) {
+  if (interruptNum < HOST_NUM_PINS) {
+    pinHandlers[interruptNum] = handler;
+    pinHandlerModes[interruptNum] = mode;
+  }
+}
+
+void detachInterrupt(uint8_t interruptNum) {
+  if (interruptNum < HOST_NUM_PINS) {
+    pinHandlers[interruptNum] = nullptr;
+  }
+}
+
+uint32_t hostGpioInputs() {
+  uint32_t levels = 0;
+  for (int pin = 0; pin < HOST_NUM_PINS; pin++) {
+    if (pinLevels[pin] == HIGH) {
+      levels |= 1UL << pin;
+    }
+  }
+  return levels;
+}
+
+void hostRaiseInterrupt(uint8_t pin) {
+  if (pin < HOST_NUM_PINS && pinHandlers[pin]) {
+    pinHandlers[pin]();
+  }
+}
+
+void hostSetPin(uint8_t pin, int level, bool interrupt) {
+  if (pin >= HOST_NUM_PINS) {
+    return;
+  }
+
+  int previous = pinLevels[pin];
+  pinLevels[pin] = level ? HIGH : LOW;
+
+  void (*handler)(void) = pinHandlers[pin];
+  if (!interrupt || !handler || previous == pinLevels[pin]) {
+    return;
+  }
+
+  int mode = pinHandlerModes[pin];
+  bool rising = pinLevels[pin] == HIGH;
+  if (mode == CHANGE || (mode == RISING && rising) || (mode == FALLING && !rising)) {
+    handler();
+  }
+}
+
+// ==================== ESP SDK (light sleep) ====================
+
+// RTC period: ~150 kHz, in us as Q12 like system_rtc_clock_cali_proc()
+#define HOST_RTC_CALI 27307
+
+static enum sleep_type fpmSleepType = NONE_SLEEP_T;
+static bool fpmOpen = false;
+static uint32_t lightSleepUs = 0;
+static fpm_wakeup_cb wakeupCallback = nullptr;
+static int wakeLevels[HOST_NUM_PINS];
+static bool wakeEnabled[HOST_NUM_PINS];
+static HostSleepHook sleepHook;
+
+void hostSetSleepHook(HostSleepHook hook) {
+  sleepHook = hook;
+}
+
+uint64_t hostSleptMicros() {
+  return sleptUs;
+}
+
+static bool wakePinActive() {
+  for (int pin = 0; pin < HOST_NUM_PINS; pin++) {
+    if (wakeEnabled[pin] && pinLevels[pin] == wakeLevels[pin]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void lightSleep() {
+  lightSleepArmed = false;
+
+  // Peripherals (and the driver's hook) keep running; the CPU does not
+  uint64_t start = nowUs;
+  uint64_t limit = lightSleepUs == FPM_SLEEP_MAX_TIME ? UINT64_MAX : start + lightSleepUs;
+  while (!wakePinActive() && nowUs < limit) {
+    hostAdvanceMicros(100);
+    if (sleepHook && !sleepHook()) {
+      break;
+    }
+  }
+  sleptUs += nowUs - start;
+
+  if (wakeupCallback) {
+    wakeupCallback();
+  }
+}
+
+bool wifi_set_opmode_current(uint8 opmode) {
+  (void)opmode;
+  return true;
+}
+
+void wifi_fpm_set_sleep_type(enum sleep_type type) {
+  fpmSleepType = type;
+}
+
+void wifi_fpm_open(void) {
+  fpmOpen = true;
+}
+
+void wifi_fpm_close(void) {
+  fpmOpen = false;
+  lightSleepArmed = false;
+}
+
+sint8 wifi_fpm_do_sleep(uint32 sleepTimeUs) {
+  if (!fpmOpen) {
+    return -1;
+  }
+  if (fpmSleepType == LIGHT_SLEEP_T) {
+    lightSleepArmed = true;
+    lightSleepUs = sleepTimeUs;
+  }
+  return 0;
+}
+
+void wifi_fpm_do_wakeup(void) {
+  lightSleepArmed = false;
+}
+
+void wifi_fpm_set_wakeup_cb(fpm_wakeup_cb callback) {
+  wakeupCallback = callback;
+}
+
+uint32 system_get_rtc_time(void) {
+  return (uint32)(nowUs * 4096 / HOST_RTC_CALI);
+}
+
+uint32 system_rtc_clock_cali_proc(void) {
+  return HOST_RTC_CALI;
+}
+
+void gpio_pin_wakeup_enable(uint32 pin, GPIO_INT_TYPE state) {
+  if (pin < HOST_NUM_PINS && (state == GPIO_PIN_INTR_LOLEVEL || state == GPIO_PIN_INTR_HILEVEL)) {
+    wakeEnabled[pin] = true;
+    wakeLevels[pin] = state == GPIO_PIN_INTR_HILEVEL ? HIGH : LOW;
+  }
+}
+
+void gpio_pin_wakeup_disable(void) {
+  for (int pin = 0; pin < HOST_NUM_PINS; pin++) {
+    wakeEnabled[pin] = false;
+  }
+}
+
+// ==================== PRINT ====================
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+  size_t n = 0;
+  while (size--) {
+    n += write(*buffer++);
+  }
+  return n;
+}
+
+size_t Print::printNumber(unsigned long n, int base) {
+  char buf[8 * sizeof(long) + 1];
+  char* str = &buf[sizeof(buf) - 1];
+  *str = '\0';
+  if (base < 2) base = 10;
+
+  do {
+    unsigned long digit = n % base;
+    n /= base;
+    *--str = digit < 10 ? '0' + digit : 'A' + digit - 10;
+  } while (n);
+
+  return write(str);
+}
+
+size_t Print::printSigned(long n, int base) {
+  if (base == 10 && n < 0) {
+    return print('-') + printNumber(-(unsigned long)n, base);
+  }
+  return printNumber((unsigned long)n, base);
+}
+
+size_t Print::print(double n, int digits) {
+  char buf[48];
+  snprintf(buf, sizeof(buf), "%.*f", digits, n);
+  return write(buf);
+}
+
+// ==================== SERIAL ====================
+
+// ESP8266 UART TX FIFO; writes block while it is full
+#define SERIAL_TX_FIFO 128
+
+static FILE* serialOut = stdout;
+static int serialFd = -1;
+static std::deque<uint8_t> serialIn;
+static unsigned long serialBaud = 115200;
+static double txLevel = 0.0;
+static uint64_t txStampUs = 0;
+
+// Empty the TX FIFO at the line rate (10 bits per byte: start, 8 data, stop)
+static void drainTx() {
+  double sent = (nowUs - txStampUs) * (serialBaud / 10.0) / 1e6;
+  txLevel = sent >= txLevel ? 0.0 : txLevel - sent;
+  txStampUs = nowUs;
+}
+
+void hostSetSerialOutput(FILE* out) {
+  serialOut = out;
+}
+
+void hostSetSerialFd(int fd) {
+  serialFd = fd;
+}
+
+void hostSerialInject(const char* data, size_t length) {
+  serialIn.insert(serialIn.end(), data, data + length);
+}
+
+static void pollSerialFd() {
+  if (serialFd < 0) {
+    return;
+  }
+
+  uint8_t buf[64];
+  ssize_t n = ::read(serialFd, buf, sizeof(buf));
+  if (n > 0) {
+    serialIn.insert(serialIn.end(), buf, buf + n);
+  }
+}
+
+void HardwareSerial::begin(unsigned long baud) {
+  drainTx();
+  serialBaud = baud ? baud : 115200;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  // Block (in virtual time) until the FIFO has room for the whole write
+  drainTx();
+  txLevel += size;
+  if (txLevel > SERIAL_TX_FIFO) {
+    hostAdvanceMicros((uint64_t)((txLevel - SERIAL_TX_FIFO) * 10.0 * 1e6 / serialBaud) + 1);
+    drainTx();
+  }
+
+  if (serialFd >= 0) {
+    ssize_t n = ::write(serialFd, buffer, size);
+    return n > 0 ? (size_t)n : 0;
+  }
+  if (serialOut) {
+    return fwrite(buffer, 1, size, serialOut);
+  }
+  return size;
+}
+
+int HardwareSerial::availableForWrite() {
+  drainTx();
+  return SERIAL_TX_FIFO - (int)ceil(txLevel);
+}
+
+int HardwareSerial::available() {
+  pollSerialFd();
+  return (int)serialIn.size();
+}
+
+int HardwareSerial::read() {
+  pollSerialFd();
+  if (serialIn.empty()) {
+    return -1;
+  }
+  int c = serialIn.front();
+  serialIn.pop_front();
+  return c;
+}
+
+int HardwareSerial::peek() {
+  pollSerialFd();
+  return serialIn.empty() ? -1 : serialIn.front();
+}
+
+// ==================== ESP ====================
+
+uint32_t EspClass::getCycleCount() {
+  using namespace std::chrono;
+  return (uint32_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,175 @@
+/*
+ * Host stand-in for the ESP8266 Arduino core
+ * Provides the subset of the Arduino API used by the firmware, backed by
+ * a virtual clock and simulated GPIO (see host_hal.h)
+ */
+
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+using std::abs;
+using std::min;
+using std::max;
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+// ==================== CONSTANTS ====================
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x00
+#define OUTPUT       0x01
+#define INPUT_PULLUP 0x02
+
+#define RISING  0x01
+#define FALLING 0x02
+#define CHANGE  0x03
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI 6.283185307179586476925286766559
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+#define F_CPU 80000000L
+
+// NodeMCU pin names (GPIO numbers)
+#define D0 16
+#define D1 5
+#define D2 4
+#define D3 0
+#define D4 2
+#define D5 14
+#define D6 12
+#define D7 13
+#define D8 15
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// ==================== MEMORY ATTRIBUTES ====================
+
+#define IRAM_ATTR
+#define ICACHE_RAM_ATTR
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+#define pgm_read_float(addr) (*(const float*)(addr))
+#define pgm_read_ptr(addr) (*(const void* const*)(addr))
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+
+// ==================== TIMING ====================
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+// ==================== GPIO ====================
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+#define digitalPinToInterrupt(p) (p)
+void attachInterrupt(uint8_t interruptNum, void (*handler)(void), int mode);
+void detachInterrupt(uint8_t interruptNum);
+// GPIO input register: one bit per pin, all read in one access
+uint32_t hostGpioInputs();
+#define GPI hostGpioInputs()
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+// ==================== PRINT / STREAM ====================
+
+#define DEC 10
+#define HEX 16
+#define BIN 2
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size);
+  size_t write(const char* str) { return str ? write((const uint8_t*)str, strlen(str)) : 0; }
+  virtual int availableForWrite() { return 0; }
+
+  size_t print(const char* s) { return write(s); }
+  size_t print(const __FlashStringHelper* s) { return write((const char*)s); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(unsigned char n, int base = DEC) { return printNumber(n, base); }
+  size_t print(int n, int base = DEC) { return printSigned(n, base); }
+  size_t print(unsigned int n, int base = DEC) { return printNumber(n, base); }
+  size_t print(long n, int base = DEC) { return printSigned(n, base); }
+  size_t print(unsigned long n, int base = DEC) { return printNumber(n, base); }
+  size_t print(double n, int digits = 2);
+
+  size_t println() { return write("\r\n"); }
+  template <typename T> size_t println(T value) { size_t n = print(value); return n + println(); }
+  template <typename T> size_t println(T value, int format) { size_t n = print(value, format); return n + println(); }
+
+private:
+  size_t printNumber(unsigned long n, int base);
+  size_t printSigned(long n, int base);
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+};
+
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long baud);
+  void end() {}
+  void flush() {}
+  operator bool() const { return true; }
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+  int availableForWrite() override;
+
+  int available() override;
+  int read() override;
+  int peek() override;
+};
+
+extern HardwareSerial Serial;
+
+// ==================== ESP ====================
+
+class EspClass {
+public:
+  // Host stand-in: nanoseconds of the steady clock, i.e. a nominal 1000 MHz counter
+  uint32_t getCycleCount();
+  uint32_t getCpuFreqMHz() { return 1000; }
+  uint32_t getFreeHeap() { return 0; }
+};
+
+extern EspClass ESP;
+
+#endif // ARDUINO_H
@@ -0,0 +1,59 @@
+/*
+ * Host stand-in for the ESP8266 EEPROM emulation - implementation
+ */
+
+#include "EEPROM.h"
+#include <stdio.h>
+
+EEPROMClass EEPROM;
+
+void EEPROMClass::begin(size_t requestedSize) {
+  size = requestedSize < sizeof(data) ? requestedSize : sizeof(data);
+
+  // Erased flash reads back as 0xFF
+  memset(data, 0xFF, sizeof(data));
+
+  if (backingFile) {
+    FILE* f = fopen(backingFile, "rb");
+    if (f) {
+      size_t n = fread(data, 1, size, f);
+      (void)n;
+      fclose(f);
+    }
+  }
+}
+
+bool EEPROMClass::commit() {
+  commits++;
+
+  // A commit erases and rewrites the whole flash sector (~30 ms on the ESP8266)
+  delay(30);
+
+  if (backingFile) {
+    FILE* f = fopen(backingFile, "wb");
+    if (!f) {
+      return false;
+    }
+    fwrite(data, 1, size, f);
+    fclose(f);
+  }
+  return true;
+}
+
+bool EEPROMClass::end() {
+  return commit();
+}
+
+uint8_t EEPROMClass::read(int address) const {
+  return (address >= 0 && (size_t)address < size) ? data[address] : 0;
+}
+
+void EEPROMClass::write(int address, uint8_t value) {
+  if (address >= 0 && (size_t)address < size) {
+    data[address] = value;
+  }
+}
+
+void EEPROMClass::hostSetBackingFile(const char* path) {
+  backingFile = path;
+}
@@ -0,0 +1,50 @@
+/*
+ * Host stand-in for the ESP8266 EEPROM emulation
+ * Backed by RAM, optionally persisted to a file between runs
+ */
+
+#ifndef EEPROM_H
+#define EEPROM_H
+
+#include "Arduino.h"
+
+class EEPROMClass {
+public:
+  void begin(size_t size);
+  bool commit();
+  bool end();
+
+  uint8_t read(int address) const;
+  void write(int address, uint8_t value);
+
+  template <typename T> T& get(int address, T& value) const {
+    if (address >= 0 && address + sizeof(T) <= size) {
+      memcpy(&value, &data[address], sizeof(T));
+    }
+    return value;
+  }
+
+  template <typename T> const T& put(int address, const T& value) {
+    if (address >= 0 && address + sizeof(T) <= size) {
+      memcpy(&data[address], &value, sizeof(T));
+    }
+    return value;
+  }
+
+  uint8_t* getDataPtr() { return data; }
+  size_t length() const { return size; }
+
+  // Host controls
+  void hostSetBackingFile(const char* path);
+  uint32_t hostCommitCount() const { return commits; }
+
+private:
+  uint8_t data[4096];
+  size_t size = 0;
+  uint32_t commits = 0;
+  const char* backingFile = nullptr;
+};
+
+extern EEPROMClass EEPROM;
+
+#endif // EEPROM_H
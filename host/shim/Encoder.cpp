@@ -0,0 +1,146 @@
+/*
+ * Simulated quadrature encoder
+ * Turns at a scripted rate and drives two GPIO pins through the Gray
+ * sequence. GPIO interrupts are modelled with a service time: the handler
+ * runs that long after the edge that raised it and sees whatever the pins
+ * read by then, as on the chip (see hostSetIsrServiceMicros()).
+ */
+
+#include "Arduino.h"
+#include "host_hal.h"
+#include <math.h>
+
+// The pull-ups read 11 before the first edge: start at the Gray code for 11
+#define ENCODER_START 2
+
+static bool wired = false;
+static uint8_t pinA = 0;
+static uint8_t pinB = 0;
+
+// Continuous position x(t) = baseTicks + rate * (t - baseUs)
+static double rate = 0.0;
+static double baseTicks = ENCODER_START;
+static uint64_t baseUs = 0;
+static double phaseError = 0.0;
+
+// Position of the last edge driven onto the pins
+static int64_t position = ENCODER_START;
+static uint64_t edges = 0;
+static uint64_t nextEdgeUs = UINT64_MAX;
+
+// Interrupt raised but not serviced yet
+static uint32_t serviceUs = 0;
+static bool isrPending = false;
+static uint64_t isrAtUs = 0;
+static uint8_t isrPin = 0;
+
+// Position at which the edge into tick k happens (odd edges late by the phase error)
+static double threshold(int64_t k) {
+  return (double)k + ((k & 1) ? phaseError : 0.0);
+}
+
+static void scheduleEdge() {
+  if (rate == 0.0) {
+    nextEdgeUs = UINT64_MAX;
+    return;
+  }
+
+  double target = rate > 0.0 ? threshold(position + 1) : threshold(position);
+  double us = (target - baseTicks) / rate * 1e6;
+  nextEdgeUs = baseUs + (uint64_t)ceil(us > 0.0 ? us : 0.0);
+}
+
+// A:B for a position: 00, 01, 11, 10
+static void pinLevels(int64_t p, int& a, int& b) {
+  static const uint8_t gray[4] = {0x0, 0x1, 0x3, 0x2};
+  uint8_t code = gray[p & 3];
+  a = (code >> 1) & 1;
+  b = code & 1;
+}
+
+static void driveEdge(uint64_t timeUs) {
+  int oldA, oldB;
+  pinLevels(position, oldA, oldB);
+  position += rate > 0.0 ? 1 : -1;
+  edges++;
+
+  int a, b;
+  pinLevels(position, a, b);
+  uint8_t pin = a != oldA ? pinA : pinB;
+  hostSetPin(pinA, a, false);
+  hostSetPin(pinB, b, false);
+
+  if (serviceUs == 0) {
+    hostRaiseInterrupt(pin);
+  } else if (!isrPending) {
+    isrPending = true;
+    isrAtUs = timeUs + serviceUs;
+    isrPin = pin;
+  }
+}
+
+void hostEncoderAdvanceTo(uint64_t nowUs) {
+  if (!wired) {
+    return;
+  }
+
+  for (;;) {
+    if (isrPending && isrAtUs <= nowUs && isrAtUs <= nextEdgeUs) {
+      isrPending = false;
+      hostRaiseInterrupt(isrPin);
+    } else if (nextEdgeUs <= nowUs) {
+      driveEdge(nextEdgeUs);
+      scheduleEdge();
+    } else {
+      break;
+    }
+  }
+}
+
+uint64_t hostEncoderNextEventUs() {
+  if (!wired) {
+    return UINT64_MAX;
+  }
+  return isrPending && isrAtUs < nextEdgeUs ? isrAtUs : nextEdgeUs;
+}
+
+void hostSetEncoderPins(uint8_t a, uint8_t b) {
+  wired = true;
+  pinA = a;
+  pinB = b;
+
+  int levelA, levelB;
+  pinLevels(position, levelA, levelB);
+  hostSetPin(pinA, levelA, false);
+  hostSetPin(pinB, levelB, false);
+}
+
+static void rebase() {
+  uint64_t now = hostNowMicros();
+  baseTicks += rate * (double)(now - baseUs) / 1e6;
+  baseUs = now;
+}
+
+void hostSetEncoderRate(double ticksPerSecond) {
+  rebase();
+  rate = ticksPerSecond;
+  scheduleEdge();
+}
+
+void hostSetEncoderPhaseError(double fraction) {
+  rebase();
+  phaseError = fraction;
+  scheduleEdge();
+}
+
+void hostSetIsrServiceMicros(uint32_t us) {
+  serviceUs = us;
+}
+
+int64_t hostEncoderPosition() {
+  return position - ENCODER_START;
+}
+
+uint64_t hostEncoderEdges() {
+  return edges;
+}
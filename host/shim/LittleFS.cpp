@@ -0,0 +1,249 @@
+/*
+ * Host stand-in for the ESP8266 LittleFS file system - implementation
+ */
+
+#include "LittleFS.h"
+#include "host_hal.h"
+#include <map>
+#include <sys/stat.h>
+#include <vector>
+
+// NOR flash timing (typical, 25Q32-class parts on ESP8266 modules) and the
+// geometry the ESP8266 core gives LittleFS
+#define FLASH_PAGE_BYTES 256
+#define FLASH_PAGE_PROGRAM_US 400
+#define FLASH_BLOCK_BYTES 8192           // Two 4 KB sectors
+#define FLASH_BLOCK_ERASE_US 50000       // Two sector erases
+#define FLASH_FS_BYTES (2 * 1024 * 1024)  // "4MB (FS:2MB)" board setting
+
+struct HostFile {
+  std::vector<uint8_t> data;
+  size_t syncedBytes = 0;     // Bytes written up to the last sync
+  size_t unsyncedBytes = 0;   // Bytes written since (overwrites count too)
+  size_t blocks = 0;          // Flash blocks allocated to the data
+  bool dirty = false;
+};
+
+FS LittleFS;
+
+static std::map<std::string, std::shared_ptr<HostFile>> files;
+static std::string directory;
+static uint64_t busyUs = 0;
+
+static std::string diskPath(const std::string& path) {
+  std::string name = path;
+  for (char& c : name) {
+    if (c == '/') c = '_';
+  }
+  return directory + "/" + (name[0] == '_' ? name.substr(1) : name);
+}
+
+static void store(const std::string& path, const HostFile& file) {
+  if (directory.empty()) {
+    return;
+  }
+  FILE* f = fopen(diskPath(path).c_str(), "wb");
+  if (f) {
+    fwrite(file.data.data(), 1, file.data.size(), f);
+    fclose(f);
+  }
+}
+
+static std::shared_ptr<HostFile> lookup(const std::string& path) {
+  auto it = files.find(path);
+  if (it != files.end()) {
+    return it->second;
+  }
+  if (directory.empty()) {
+    return nullptr;
+  }
+
+  FILE* f = fopen(diskPath(path).c_str(), "rb");
+  if (!f) {
+    return nullptr;
+  }
+  auto file = std::make_shared<HostFile>();
+  uint8_t buffer[4096];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) {
+    file->data.insert(file->data.end(), buffer, buffer + n);
+  }
+  fclose(f);
+  file->syncedBytes = file->data.size();
+  file->blocks = (file->data.size() + FLASH_BLOCK_BYTES - 1) / FLASH_BLOCK_BYTES;
+  files[path] = file;
+  return file;
+}
+
+static void charge(uint64_t us) {
+  busyUs += us;
+  // The CPU waits for the flash (the cache is off while it is busy)
+  while (us > 0) {
+    unsigned int step = us > 10000 ? 10000 : (unsigned int)us;
+    delayMicroseconds(step);
+    us -= step;
+  }
+}
+
+void hostSetFsDirectory(const char* path) {
+  directory = path ? path : "";
+  files.clear();
+  if (!directory.empty()) {
+    mkdir(directory.c_str(), 0755);
+  }
+}
+
+uint64_t hostFlashBusyMicros() {
+  return busyUs;
+}
+
+// ==================== FILE ====================
+
+File::File(std::shared_ptr<HostFile> file, const std::string& path, size_t position, bool writable)
+  : file(file), path(path), pos(position), writable(writable) {
+}
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+  if (!file || !writable) {
+    return 0;
+  }
+  if (pos + size > file->data.size()) {
+    file->data.resize(pos + size);
+  }
+  memcpy(&file->data[pos], buffer, size);
+  pos += size;
+  file->unsyncedBytes += size;
+  file->dirty = true;
+  return size;
+}
+
+size_t File::read(uint8_t* buffer, size_t size) {
+  if (!file || pos >= file->data.size()) {
+    return 0;
+  }
+  size_t n = std::min(size, file->data.size() - pos);
+  memcpy(buffer, &file->data[pos], n);
+  pos += n;
+  return n;
+}
+
+int File::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+bool File::seek(uint32_t position, SeekMode mode) {
+  if (!file) {
+    return false;
+  }
+  size_t base = mode == SeekSet ? 0 : (mode == SeekCur ? pos : file->data.size());
+  if (base + position > file->data.size()) {
+    return false;
+  }
+  pos = base + position;
+  return true;
+}
+
+size_t File::size() const {
+  return file ? file->data.size() : 0;
+}
+
+void File::flush() {
+  if (!file || !file->dirty) {
+    return;
+  }
+
+  // New data pages, one metadata commit, and an erase for every block the
+  // file grew into
+  size_t pages = (file->unsyncedBytes + FLASH_PAGE_BYTES - 1) / FLASH_PAGE_BYTES + 1;
+  size_t blocks = (file->data.size() + FLASH_BLOCK_BYTES - 1) / FLASH_BLOCK_BYTES;
+  uint64_t us = pages * FLASH_PAGE_PROGRAM_US;
+  if (blocks > file->blocks) {
+    us += (blocks - file->blocks) * FLASH_BLOCK_ERASE_US;
+    file->blocks = blocks;
+  }
+
+  file->syncedBytes = file->data.size();
+  file->unsyncedBytes = 0;
+  file->dirty = false;
+  store(path, *file);
+  charge(us);
+}
+
+void File::close() {
+  flush();
+  file.reset();
+}
+
+// ==================== FS ====================
+
+bool FS::begin() {
+  return true;
+}
+
+void FS::end() {
+}
+
+bool FS::format() {
+  for (auto& entry : files) {
+    if (!directory.empty()) {
+      ::remove(diskPath(entry.first).c_str());
+    }
+  }
+  files.clear();
+  return true;
+}
+
+bool FS::info(FSInfo& info) {
+  size_t used = 0;
+  for (auto& entry : files) {
+    used += entry.second->blocks * FLASH_BLOCK_BYTES;
+  }
+  info.totalBytes = FLASH_FS_BYTES;
+  info.usedBytes = used;
+  info.blockSize = FLASH_BLOCK_BYTES;
+  info.pageSize = FLASH_PAGE_BYTES;
+  info.maxOpenFiles = 5;
+  info.maxPathLength = 32;
+  return true;
+}
+
+File FS::open(const char* path, const char* mode) {
+  std::string name = path;
+  bool plus = strchr(mode, '+') != nullptr;
+  std::shared_ptr<HostFile> file = lookup(name);
+
+  if (mode[0] == 'r') {
+    return file ? File(file, name, 0, plus) : File();
+  }
+
+  if (!file) {
+    file = std::make_shared<HostFile>();
+    files[name] = file;
+  }
+  if (mode[0] == 'w') {
+    // Truncating frees the blocks; growing again erases fresh ones
+    file->data.clear();
+    file->blocks = 0;
+    file->syncedBytes = 0;
+    file->unsyncedBytes = 0;
+    file->dirty = true;
+  }
+  return File(file, name, mode[0] == 'a' ? file->data.size() : 0, true);
+}
+
+bool FS::exists(const char* path) {
+  return lookup(path) != nullptr;
+}
+
+bool FS::remove(const char* path) {
+  std::string name = path;
+  if (!lookup(name)) {
+    return false;
+  }
+  files.erase(name);
+  if (!directory.empty()) {
+    ::remove(diskPath(name).c_str());
+  }
+  return true;
+}
@@ -0,0 +1,75 @@
+/*
+ * Host stand-in for the ESP8266 LittleFS file system
+ * Files live in RAM, or in a host directory (hostSetFsDirectory()). Syncs
+ * charge the virtual clock for the flash pages programmed and the blocks
+ * erased, as LittleFS would on the chip.
+ */
+
+#ifndef LITTLEFS_H
+#define LITTLEFS_H
+
+#include "Arduino.h"
+#include <memory>
+#include <string>
+
+enum SeekMode {
+  SeekSet = 0,
+  SeekCur = 1,
+  SeekEnd = 2
+};
+
+struct FSInfo {
+  size_t totalBytes;
+  size_t usedBytes;
+  size_t blockSize;
+  size_t pageSize;
+  size_t maxOpenFiles;
+  size_t maxPathLength;
+};
+
+struct HostFile;
+
+class File {
+public:
+  File() {}
+  File(std::shared_ptr<HostFile> file, const std::string& path, size_t position, bool writable);
+
+  operator bool() const { return (bool)file; }
+
+  size_t write(uint8_t c) { return write(&c, 1); }
+  size_t write(const uint8_t* buffer, size_t size);
+  size_t read(uint8_t* buffer, size_t size);
+  int read();
+
+  bool seek(uint32_t position, SeekMode mode = SeekSet);
+  size_t position() const { return pos; }
+  size_t size() const;
+  const char* name() const { return path.c_str(); }
+
+  // Commit the data written so far (programs the pages, erases new blocks)
+  void flush();
+  void close();
+
+private:
+  std::shared_ptr<HostFile> file;
+  std::string path;
+  size_t pos = 0;
+  bool writable = false;
+};
+
+class FS {
+public:
+  bool begin();
+  void end();
+  bool format();
+  bool info(FSInfo& info);
+
+  // Modes as fopen: "r", "r+", "w", "w+", "a", "a+"
+  File open(const char* path, const char* mode);
+  bool exists(const char* path);
+  bool remove(const char* path);
+};
+
+extern FS LittleFS;
+
+#endif // LITTLEFS_H
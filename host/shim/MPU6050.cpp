@@ -0,0 +1,373 @@
+/*
+ * Host stand-in for the MPU6050 library - simulated sensor
+ */
+
+#include "MPU6050.h"
+#include "host_hal.h"
+#include <deque>
+#include <random>
+
+#define MPU_FIFO_SIZE 1024
+#define MPU_NO_PIN 0xFF
+
+static struct {
+  bool awake = false;
+  uint8_t accelRange = MPU6050_ACCEL_FS_2;
+  uint8_t gyroRange = MPU6050_GYRO_FS_250;
+  uint8_t dlpf = MPU6050_DLPF_BW_256;
+  uint8_t rateDivider = 0;
+
+  bool fifoEnabled = false;
+  bool accelFifo = false;
+  bool tempFifo = false;
+  bool gyroFifo[3] = {false, false, false};
+  std::deque<uint8_t> fifo;
+
+  bool intDataReady = false;
+  bool intOverflow = false;
+  bool intMotion = false;
+  bool intActiveLow = false;
+  bool intLatch = false;  // INT held active until INT_STATUS is read
+  uint8_t intStatus = 0;
+
+  uint8_t motionThreshold = 0;
+  uint8_t motionDuration = 1;
+  uint8_t motionCount = 0;
+  int16_t motionReference[3] = {0, 0, 0};
+
+  bool held = false;  // No samples of its own (hostSetMpuHeld)
+
+  bool cycle = false;
+  uint8_t wakeFrequency = MPU6050_WAKE_FREQ_1P25;
+  bool gyroStandby = false;
+
+  int16_t data[6] = {0, 16384, 0, 0, 0, 0};
+  double nextSampleUs = 0;
+  uint64_t produced = 0;
+  uint8_t intPin = MPU_NO_PIN;
+  HostSampleSource source;
+} sim;
+
+// Optional analog noise model: white noise at the internal ADC rate shaped by
+// the DLPF, so sample-to-sample correlation follows the configured bandwidth
+static struct {
+  bool enabled = false;
+  double density[6] = {0, 0, 0, 0, 0, 0};  // Counts per sqrt(Hz) at +-2 g / +-250 dps
+  double state[6] = {0, 0, 0, 0, 0, 0};
+  bool primed = false;
+  double nextTickUs = 0;
+  std::mt19937 rng{7};
+  std::normal_distribution<double> gauss{0.0, 1.0};
+} noise;
+
+// INT_STATUS bits
+#define INT_DATA_RDY (1 << MPU6050_INTERRUPT_DATA_RDY_BIT)
+#define INT_FIFO_OFLOW (1 << MPU6050_INTERRUPT_FIFO_OFLOW_BIT)
+#define INT_MOT (1 << MPU6050_INTERRUPT_MOT_BIT)
+
+static double samplePeriodUs() {
+  if (sim.cycle) {
+    static const double wakeHz[] = {1.25, 5.0, 20.0, 40.0};
+    return 1e6 / wakeHz[sim.wakeFrequency & 0x03];
+  }
+  double gyroOutputHz = (sim.dlpf == 0 || sim.dlpf == 7) ? 8000.0 : 1000.0;
+  return (1 + sim.rateDivider) * 1e6 / gyroOutputHz;
+}
+
+static int16_t saturate(int32_t v) {
+  return v > 32767 ? 32767 : (v < -32768 ? -32768 : (int16_t)v);
+}
+
+static void setIntPin(bool active) {
+  if (sim.intPin == MPU_NO_PIN) {
+    return;
+  }
+  hostSetPin(sim.intPin, active != sim.intActiveLow ? HIGH : LOW);
+}
+
+static void pulseIntPin() {
+  setIntPin(true);
+  if (!sim.intLatch) {
+    setIntPin(false);  // 50 us pulse
+  }
+}
+
+// Any INT_STATUS read clears every bit and releases a latched INT line
+static uint8_t readIntStatus() {
+  hostChargeI2c(4);
+  uint8_t status = sim.intStatus;
+  sim.intStatus = 0;
+  if (sim.intLatch) {
+    setIntPin(false);
+  }
+  return status;
+}
+
+static void pushFifo(int16_t value) {
+  sim.fifo.push_back((uint8_t)((uint16_t)value >> 8));
+  sim.fifo.push_back((uint8_t)(value & 0xFF));
+}
+
+static void readSource(uint64_t timeUs, int16_t s[6]) {
+  s[0] = 0;
+  s[1] = 16384;
+  s[2] = 0;
+  s[3] = 0;
+  s[4] = 0;
+  s[5] = 0;
+  if (sim.source) {
+    sim.source(timeUs, s);
+  }
+}
+
+static void emitSample(const int16_t s[6]);
+
+static void produceSample(uint64_t timeUs) {
+  int16_t s[6];
+  readSource(timeUs, s);
+  emitSample(s);
+}
+
+// Accelerometer DLPF bandwidth (Hz) per DLPF_CFG
+static double dlpfBandwidthHz() {
+  static const double bandwidth[] = {260.0, 184.0, 94.0, 44.0, 21.0, 10.0, 5.0, 260.0};
+  return bandwidth[sim.dlpf & 0x07];
+}
+
+// Internal ADC ticks: noisy source samples through a one-pole DLPF; output
+// samples are taken from the filter state at the configured sample rate
+static void advanceNoiseModel(uint64_t nowUs) {
+  double fs = (sim.dlpf == 0 || sim.dlpf == 7) ? 8000.0 : 1000.0;
+  double tickUs = 1e6 / fs;
+  double alpha = 1.0 - exp(-2.0 * M_PI * dlpfBandwidthHz() / fs);
+  double whiteScale = sqrt(fs / 2.0);
+
+  while (noise.nextTickUs <= (double)nowUs) {
+    int16_t s[6];
+    readSource((uint64_t)noise.nextTickUs, s);
+    for (int i = 0; i < 6; i++) {
+      double x = s[i] + noise.density[i] * whiteScale * noise.gauss(noise.rng);
+      noise.state[i] = noise.primed ? noise.state[i] + alpha * (x - noise.state[i]) : s[i];
+    }
+    noise.primed = true;
+
+    while (sim.nextSampleUs <= noise.nextTickUs) {
+      int16_t out[6];
+      for (int i = 0; i < 6; i++) {
+        out[i] = saturate(lround(noise.state[i]));
+      }
+      emitSample(out);
+      sim.nextSampleUs += samplePeriodUs();
+    }
+    noise.nextTickUs += tickUs;
+  }
+}
+
+static void emitSample(const int16_t s[6]) {
+  // The source speaks +-2 g / +-250 dps counts; rescale to the configured ranges
+  for (int i = 0; i < 3; i++) {
+    sim.data[i] = saturate(s[i] >> sim.accelRange);
+    sim.data[i + 3] = (sim.cycle || sim.gyroStandby) ? 0 : saturate(s[i + 3] >> sim.gyroRange);
+  }
+  sim.produced++;
+
+  if (sim.fifoEnabled) {
+    if (sim.accelFifo) {
+      for (int i = 0; i < 3; i++) pushFifo(sim.data[i]);
+    }
+    if (sim.tempFifo) {
+      pushFifo(0);
+    }
+    for (int i = 0; i < 3; i++) {
+      if (sim.gyroFifo[i]) pushFifo(sim.data[i + 3]);
+    }
+    if (sim.fifo.size() > MPU_FIFO_SIZE) {
+      // Hardware overwrites the oldest bytes, losing frame alignment
+      sim.fifo.erase(sim.fifo.begin(), sim.fifo.begin() + (sim.fifo.size() - MPU_FIFO_SIZE));
+      sim.intStatus |= INT_FIFO_OFLOW;
+    }
+  }
+
+  bool fire = false;
+  sim.intStatus |= INT_DATA_RDY;
+  if (sim.intDataReady) {
+    fire = true;
+  }
+
+  if (sim.intMotion) {
+    // Motion detection compares against the previous sample (high-pass held)
+    int32_t threshold = (int32_t)sim.motionThreshold * 32 >> sim.accelRange;  // 2 mg/LSB at +-2 g
+    bool exceeded = false;
+    for (int i = 0; i < 3; i++) {
+      if (abs(sim.data[i] - sim.motionReference[i]) > threshold) exceeded = true;
+      sim.motionReference[i] = sim.data[i];
+    }
+    sim.motionCount = exceeded ? sim.motionCount + 1 : 0;
+    if (sim.motionCount >= sim.motionDuration) {
+      sim.intStatus |= INT_MOT;
+      fire = true;
+    }
+  }
+
+  if (fire) {
+    pulseIntPin();
+  }
+}
+
+void hostMpuAdvanceTo(uint64_t nowUs) {
+  if (!sim.awake || sim.held) {
+    sim.nextSampleUs = (double)nowUs;
+    noise.nextTickUs = (double)nowUs;
+    return;
+  }
+  if (noise.enabled) {
+    advanceNoiseModel(nowUs);
+    return;
+  }
+  while (sim.nextSampleUs <= (double)nowUs) {
+    produceSample((uint64_t)sim.nextSampleUs);
+    sim.nextSampleUs += samplePeriodUs();
+  }
+}
+
+void hostSetMpuNoiseDensity(double accelMicroG, double gyroMilliDps) {
+  noise.enabled = accelMicroG > 0.0 || gyroMilliDps > 0.0;
+  for (int i = 0; i < 3; i++) {
+    noise.density[i] = accelMicroG * 1e-6 * 16384.0;
+    noise.density[i + 3] = gyroMilliDps * 1e-3 * 131.0;
+  }
+  noise.primed = false;
+  noise.nextTickUs = (double)hostNowMicros();
+}
+
+void hostSetMpuNoiseSeed(uint32_t seed) {
+  noise.rng.seed(seed);
+  noise.gauss.reset();
+}
+
+void hostSetSampleSource(HostSampleSource source) {
+  sim.source = source;
+}
+
+void hostSetMpuIntPin(uint8_t pin) {
+  sim.intPin = pin;
+}
+
+uint64_t hostMpuSamplesProduced() {
+  return sim.produced;
+}
+
+void hostSetMpuHeld(bool held) {
+  sim.held = held;
+  sim.nextSampleUs = (double)hostNowMicros();
+  noise.nextTickUs = sim.nextSampleUs;
+}
+
+void hostMpuEmitSample(const int16_t sample[6]) {
+  emitSample(sample);
+}
+
+// ==================== MPU6050 API ====================
+
+void MPU6050::initialize() {
+  sim.awake = true;
+  sim.nextSampleUs = (double)hostNowMicros();
+  noise.nextTickUs = sim.nextSampleUs;
+  hostChargeI2c(12);
+}
+
+bool MPU6050::testConnection() {
+  hostChargeI2c(4);
+  return true;
+}
+
+void MPU6050::setFullScaleAccelRange(uint8_t range) { sim.accelRange = range & 0x03; }
+void MPU6050::setFullScaleGyroRange(uint8_t range) { sim.gyroRange = range & 0x03; }
+void MPU6050::setDLPFMode(uint8_t mode) { sim.dlpf = mode & 0x07; }
+void MPU6050::setDHPFMode(uint8_t mode) { (void)mode; }
+void MPU6050::setRate(uint8_t rate) { sim.rateDivider = rate; }
+uint8_t MPU6050::getRate() { return sim.rateDivider; }
+
+void MPU6050::getMotion6(int16_t* ax, int16_t* ay, int16_t* az, int16_t* gx, int16_t* gy, int16_t* gz) {
+  hostChargeI2c(18);
+  *ax = sim.data[0];
+  *ay = sim.data[1];
+  *az = sim.data[2];
+  *gx = sim.data[3];
+  *gy = sim.data[4];
+  *gz = sim.data[5];
+}
+
+void MPU6050::getAcceleration(int16_t* x, int16_t* y, int16_t* z) {
+  hostChargeI2c(10);
+  *x = sim.data[0];
+  *y = sim.data[1];
+  *z = sim.data[2];
+}
+
+void MPU6050::setFIFOEnabled(bool enabled) { sim.fifoEnabled = enabled; }
+void MPU6050::setAccelFIFOEnabled(bool enabled) { sim.accelFifo = enabled; }
+void MPU6050::setXGyroFIFOEnabled(bool enabled) { sim.gyroFifo[0] = enabled; }
+void MPU6050::setYGyroFIFOEnabled(bool enabled) { sim.gyroFifo[1] = enabled; }
+void MPU6050::setZGyroFIFOEnabled(bool enabled) { sim.gyroFifo[2] = enabled; }
+void MPU6050::setTempFIFOEnabled(bool enabled) { sim.tempFifo = enabled; }
+
+void MPU6050::resetFIFO() {
+  hostChargeI2c(3);
+  sim.fifo.clear();
+  sim.intStatus &= ~INT_FIFO_OFLOW;
+}
+
+uint16_t MPU6050::getFIFOCount() {
+  hostChargeI2c(5);
+  return (uint16_t)sim.fifo.size();
+}
+
+void MPU6050::getFIFOBytes(uint8_t* data, uint8_t length) {
+  hostChargeI2c(3 + length);
+  for (uint8_t i = 0; i < length; i++) {
+    if (sim.fifo.empty()) {
+      data[i] = 0;
+    } else {
+      data[i] = sim.fifo.front();
+      sim.fifo.pop_front();
+    }
+  }
+}
+
+void MPU6050::setInterruptMode(bool mode) { sim.intActiveLow = mode; }
+void MPU6050::setInterruptDrive(bool drive) { (void)drive; }
+void MPU6050::setInterruptLatch(bool latch) {
+  sim.intLatch = latch;
+  if (!latch) {
+    setIntPin(false);
+  }
+}
+
+void MPU6050::setInterruptLatchClear(bool clear) { (void)clear; }
+void MPU6050::setIntDataReadyEnabled(bool enabled) { sim.intDataReady = enabled; }
+void MPU6050::setIntFIFOBufferOverflowEnabled(bool enabled) { sim.intOverflow = enabled; }
+void MPU6050::setIntMotionEnabled(bool enabled) { sim.intMotion = enabled; }
+
+uint8_t MPU6050::getIntStatus() {
+  return readIntStatus();
+}
+
+bool MPU6050::getIntFIFOBufferOverflowStatus() {
+  return (readIntStatus() & INT_FIFO_OFLOW) != 0;
+}
+
+bool MPU6050::getIntMotionStatus() {
+  return (readIntStatus() & INT_MOT) != 0;
+}
+
+void MPU6050::setMotionDetectionThreshold(uint8_t threshold) { sim.motionThreshold = threshold; }
+void MPU6050::setMotionDetectionDuration(uint8_t duration) { sim.motionDuration = duration ? duration : 1; }
+
+void MPU6050::setSleepEnabled(bool enabled) { sim.awake = !enabled; }
+void MPU6050::setWakeCycleEnabled(bool enabled) { sim.cycle = enabled; }
+void MPU6050::setWakeFrequency(uint8_t frequency) { sim.wakeFrequency = frequency; }
+void MPU6050::setTempSensorEnabled(bool enabled) { (void)enabled; }
+void MPU6050::setStandbyXGyroEnabled(bool enabled) { sim.gyroStandby = enabled; }
+void MPU6050::setStandbyYGyroEnabled(bool enabled) { sim.gyroStandby = enabled; }
+void MPU6050::setStandbyZGyroEnabled(bool enabled) { sim.gyroStandby = enabled; }
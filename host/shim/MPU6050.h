@@ -0,0 +1,110 @@
+/*
+ * Host stand-in for the MPU6050 library (Electronic Cats / i2cdevlib API)
+ * Simulates the sample-rate generator, FIFO, interrupt pin and power modes;
+ * motion data comes from the source installed with hostSetSampleSource()
+ */
+
+#ifndef MPU6050_H
+#define MPU6050_H
+
+#include "Arduino.h"
+
+#define MPU6050_ACCEL_FS_2  0x00
+#define MPU6050_ACCEL_FS_4  0x01
+#define MPU6050_ACCEL_FS_8  0x02
+#define MPU6050_ACCEL_FS_16 0x03
+
+#define MPU6050_GYRO_FS_250  0x00
+#define MPU6050_GYRO_FS_500  0x01
+#define MPU6050_GYRO_FS_1000 0x02
+#define MPU6050_GYRO_FS_2000 0x03
+
+#define MPU6050_DLPF_BW_256 0x00
+#define MPU6050_DLPF_BW_188 0x01
+#define MPU6050_DLPF_BW_98  0x02
+#define MPU6050_DLPF_BW_42  0x03
+#define MPU6050_DLPF_BW_20  0x04
+#define MPU6050_DLPF_BW_10  0x05
+#define MPU6050_DLPF_BW_5   0x06
+
+#define MPU6050_DHPF_RESET 0x00
+#define MPU6050_DHPF_5     0x01
+#define MPU6050_DHPF_2P5   0x02
+#define MPU6050_DHPF_1P25  0x03
+#define MPU6050_DHPF_0P63  0x04
+#define MPU6050_DHPF_HOLD  0x07
+
+#define MPU6050_WAKE_FREQ_1P25 0x0
+#define MPU6050_WAKE_FREQ_5    0x1
+#define MPU6050_WAKE_FREQ_20   0x2
+#define MPU6050_WAKE_FREQ_40   0x3
+
+#define MPU6050_INTMODE_ACTIVEHIGH 0x00
+#define MPU6050_INTMODE_ACTIVELOW  0x01
+#define MPU6050_INTDRV_PUSHPULL    0x00
+#define MPU6050_INTDRV_OPENDRAIN   0x01
+#define MPU6050_INTLATCH_50USPULSE 0x00
+#define MPU6050_INTLATCH_WAITCLEAR 0x01
+#define MPU6050_INTCLEAR_STATUSREAD 0x00
+#define MPU6050_INTCLEAR_ANYREAD    0x01
+
+// INT_STATUS / INT_ENABLE bit positions
+#define MPU6050_INTERRUPT_DATA_RDY_BIT 0
+#define MPU6050_INTERRUPT_FIFO_OFLOW_BIT 4
+#define MPU6050_INTERRUPT_MOT_BIT 6
+
+class MPU6050 {
+public:
+  MPU6050(uint8_t address = 0x68) { (void)address; }
+
+  void initialize();
+  bool testConnection();
+
+  void setFullScaleAccelRange(uint8_t range);
+  void setFullScaleGyroRange(uint8_t range);
+  void setDLPFMode(uint8_t mode);
+  void setDHPFMode(uint8_t mode);
+  void setRate(uint8_t rate);
+  uint8_t getRate();
+
+  void getMotion6(int16_t* ax, int16_t* ay, int16_t* az, int16_t* gx, int16_t* gy, int16_t* gz);
+  void getAcceleration(int16_t* x, int16_t* y, int16_t* z);
+
+  // FIFO
+  void setFIFOEnabled(bool enabled);
+  void setAccelFIFOEnabled(bool enabled);
+  void setXGyroFIFOEnabled(bool enabled);
+  void setYGyroFIFOEnabled(bool enabled);
+  void setZGyroFIFOEnabled(bool enabled);
+  void setTempFIFOEnabled(bool enabled);
+  void resetFIFO();
+  uint16_t getFIFOCount();
+  void getFIFOBytes(uint8_t* data, uint8_t length);
+
+  // Interrupts
+  void setInterruptMode(bool mode);
+  void setInterruptDrive(bool drive);
+  void setInterruptLatch(bool latch);
+  void setInterruptLatchClear(bool clear);
+  void setIntDataReadyEnabled(bool enabled);
+  void setIntFIFOBufferOverflowEnabled(bool enabled);
+  void setIntMotionEnabled(bool enabled);
+  uint8_t getIntStatus();
+  bool getIntFIFOBufferOverflowStatus();
+  bool getIntMotionStatus();
+
+  // Motion detection
+  void setMotionDetectionThreshold(uint8_t threshold);
+  void setMotionDetectionDuration(uint8_t duration);
+
+  // Power management
+  void setSleepEnabled(bool enabled);
+  void setWakeCycleEnabled(bool enabled);
+  void setWakeFrequency(uint8_t frequency);
+  void setTempSensorEnabled(bool enabled);
+  void setStandbyXGyroEnabled(bool enabled);
+  void setStandbyYGyroEnabled(bool enabled);
+  void setStandbyZGyroEnabled(bool enabled);
+};
+
+#endif // MPU6050_H
@@ -0,0 +1,164 @@
+/*
+ * Host stand-in for the U8g2 library - implementation
+ */
+
+#include "U8g2lib.h"
+#include "host_hal.h"
+
+static const u8g2_cb_t rotation0 = {0};
+const u8g2_cb_t* const U8G2_R0 = &rotation0;
+
+const uint8_t u8g2_font_6x10_tf[] = {6, 7, 2};
+const uint8_t u8g2_font_7x13_tf[] = {7, 9, 2};
+const uint8_t u8g2_font_9x18_tf[] = {9, 12, 3};
+const uint8_t u8g2_font_10x20_tf[] = {10, 14, 4};
+const uint8_t u8g2_font_logisoso22_tn[] = {14, 22, 0};
+
+// Command/addressing overhead per SSD1306 page transfer
+#define PAGE_OVERHEAD_BYTES 6
+
+U8G2::U8G2(uint8_t* buffer, uint8_t tileRowsInBuffer)
+  : buffer(buffer),
+    tileRows(tileRowsInBuffer),
+    panel(1024, 0),
+    currentFont(u8g2_font_6x10_tf) {
+  memset(buffer, 0, tileRows * 128);
+}
+
+bool U8G2::begin() {
+  hostChargeI2c(30);  // Controller init sequence
+  clearDisplay();
+  return true;
+}
+
+void U8G2::clearBuffer() {
+  memset(buffer, 0, tileRows * 128);
+}
+
+void U8G2::sendTiles(uint8_t tx, uint8_t ty, uint8_t tw, uint8_t th, const uint8_t* src, uint8_t srcFirstRow) {
+  for (uint8_t row = ty; row < ty + th && row < 8; row++) {
+    const uint8_t* line = src + (row - srcFirstRow) * 128 + tx * 8;
+    memcpy(panel.data() + row * 128 + tx * 8, line, tw * 8);
+    hostChargeI2c(PAGE_OVERHEAD_BYTES + tw * 8);
+    bytesSent += PAGE_OVERHEAD_BYTES + tw * 8;
+  }
+  transfers++;
+}
+
+void U8G2::sendBuffer() {
+  sendTiles(0, currTileRow, 16, tileRows, buffer, currTileRow);
+}
+
+void U8G2::updateDisplay() {
+  sendBuffer();
+}
+
+void U8G2::updateDisplayArea(uint8_t tx, uint8_t ty, uint8_t tw, uint8_t th) {
+  if (tx >= 16 || ty < currTileRow || ty >= currTileRow + tileRows) {
+    return;
+  }
+  if (tx + tw > 16) tw = 16 - tx;
+  if (ty + th > currTileRow + tileRows) th = currTileRow + tileRows - ty;
+  sendTiles(tx, ty, tw, th, buffer, currTileRow);
+}
+
+void U8G2::clearDisplay() {
+  uint8_t savedRow = currTileRow;
+  for (uint8_t row = 0; row < 8; row += tileRows) {
+    currTileRow = row;
+    clearBuffer();
+    sendBuffer();
+  }
+  currTileRow = savedRow;
+}
+
+void U8G2::firstPage() {
+  currTileRow = 0;
+  clearBuffer();
+}
+
+uint8_t U8G2::nextPage() {
+  sendBuffer();
+  currTileRow += tileRows;
+  if (currTileRow >= 8) {
+    currTileRow = 0;
+    return 0;
+  }
+  clearBuffer();
+  return 1;
+}
+
+void U8G2::drawPixel(int x, int y) {
+  int firstY = currTileRow * 8;
+  if (x < 0 || x >= 128 || y < firstY || y >= firstY + tileRows * 8) {
+    return;
+  }
+
+  uint8_t* cell = &buffer[((y - firstY) >> 3) * 128 + x];
+  uint8_t mask = 1 << (y & 7);
+  if (drawColor == 0) {
+    *cell &= ~mask;
+  } else if (drawColor == 2) {
+    *cell ^= mask;
+  } else {
+    *cell |= mask;
+  }
+}
+
+void U8G2::drawBox(int x, int y, int w, int h) {
+  for (int yy = y; yy < y + h; yy++) {
+    for (int xx = x; xx < x + w; xx++) {
+      drawPixel(xx, yy);
+    }
+  }
+}
+
+void U8G2::drawXBM(int x, int y, int w, int h, const uint8_t* bitmap) {
+  int stride = (w + 7) / 8;
+  for (int yy = 0; yy < h; yy++) {
+    for (int xx = 0; xx < w; xx++) {
+      if (bitmap[yy * stride + xx / 8] & (1 << (xx & 7))) {
+        drawPixel(x + xx, y + yy);
+      }
+    }
+  }
+}
+
+int U8G2::drawGlyph(int x, int y, uint16_t encoding) {
+  int width = currentFont[0];
+  int ascent = currentFont[1];
+  int descent = currentFont[2];
+
+  // Deterministic pseudo-glyph: a pattern unique to the character and font
+  if (encoding != ' ') {
+    for (int dy = -ascent; dy < descent; dy++) {
+      for (int dx = 0; dx < width - 1; dx++) {
+        uint32_t h = encoding * 2654435761u ^ (uint32_t)(dx * 73856093) ^ (uint32_t)(dy * 19349663) ^ width;
+        if ((h >> 7) % 3 == 0) {
+          drawPixel(x + dx, y + dy);
+        }
+      }
+    }
+  }
+  return width;
+}
+
+int U8G2::drawStr(int x, int y, const char* s) {
+  int start = x;
+  while (*s) {
+    x += drawGlyph(x, y, (uint8_t)*s++);
+  }
+  return x - start;
+}
+
+int U8G2::getStrWidth(const char* s) const {
+  return (int)strlen(s) * currentFont[0];
+}
+
+size_t U8G2::write(uint8_t c) {
+  if (c == '\n' || c == '\r') {
+    return 1;
+  }
+  cursorX += drawGlyph(cursorX, cursorY, c);
+  return 1;
+}
@@ -0,0 +1,132 @@
+/*
+ * Host stand-in for the U8g2 library (SSD1306 128x64, HW I2C)
+ * Renders into a real tile buffer using synthetic fixed-width glyphs, and
+ * keeps a copy of the panel RAM so host drivers can inspect what was sent
+ */
+
+#ifndef U8G2LIB_H
+#define U8G2LIB_H
+
+#include "Arduino.h"
+#include <vector>
+
+#define U8X8_PIN_NONE 255
+
+typedef uint8_t u8g2_uint_t;
+
+// Rotation placeholder (only R0 is used)
+struct u8g2_cb_t { int rotation; };
+extern const u8g2_cb_t* const U8G2_R0;
+
+// Synthetic fonts: { advance width, ascent, descent }
+extern const uint8_t u8g2_font_6x10_tf[];
+extern const uint8_t u8g2_font_7x13_tf[];
+extern const uint8_t u8g2_font_9x18_tf[];
+extern const uint8_t u8g2_font_10x20_tf[];
+extern const uint8_t u8g2_font_logisoso22_tn[];
+
+class U8G2 : public Print {
+public:
+  virtual ~U8G2() {}
+
+  bool begin();
+  void setPowerSave(uint8_t isEnable) { powerSave = isEnable != 0; }
+  void setContrast(uint8_t value) { (void)value; }
+
+  // Buffer
+  void clearBuffer();
+  void sendBuffer();
+  void clearDisplay();
+  void updateDisplay();
+  void updateDisplayArea(uint8_t tx, uint8_t ty, uint8_t tw, uint8_t th);
+  uint8_t* getBufferPtr() { return buffer; }
+  uint8_t getBufferTileWidth() const { return 16; }
+  uint8_t getBufferTileHeight() const { return tileRows; }
+  uint8_t getBufferCurrTileRow() const { return currTileRow; }
+  void setBufferCurrTileRow(uint8_t row) { currTileRow = row; }
+
+  // Page mode
+  void firstPage();
+  uint8_t nextPage();
+
+  // Drawing
+  void setFont(const uint8_t* font) { currentFont = font; }
+  void setDrawColor(uint8_t color) { drawColor = color; }
+  void setFontMode(uint8_t mode) { (void)mode; }
+  void setBitmapMode(uint8_t mode) { (void)mode; }
+  void drawPixel(int x, int y);
+  void drawBox(int x, int y, int w, int h);
+  void drawHLine(int x, int y, int w) { drawBox(x, y, w, 1); }
+  void drawXBM(int x, int y, int w, int h, const uint8_t* bitmap);
+  void drawXBMP(int x, int y, int w, int h, const uint8_t* bitmap) { drawXBM(x, y, w, h, bitmap); }
+  int drawStr(int x, int y, const char* s);
+  int drawGlyph(int x, int y, uint16_t encoding);
+  int getStrWidth(const char* s) const;
+  int getMaxCharHeight() const { return currentFont[1] + currentFont[2]; }
+  int getAscent() const { return currentFont[1]; }
+  int getDescent() const { return -currentFont[2]; }
+  int getDisplayWidth() const { return 128; }
+  int getDisplayHeight() const { return 64; }
+  void setCursor(int x, int y) { cursorX = x; cursorY = y; }
+
+  size_t write(uint8_t c) override;
+  using Print::write;
+
+  // Host inspection
+  const uint8_t* hostPanel() const { return panel.data(); }
+  uint32_t hostBytesSent() const { return bytesSent; }
+  uint32_t hostTransfers() const { return transfers; }
+
+protected:
+  // The buffer is the driver's own, sized like U8g2's (1, 2 or 8 tile rows)
+  U8G2(uint8_t* buffer, uint8_t tileRowsInBuffer);
+
+private:
+  uint8_t* buffer;
+  uint8_t tileRows;
+  uint8_t currTileRow = 0;
+
+  std::vector<uint8_t> panel;  // Simulated controller RAM (on the heap: not the ESP8266's)
+  uint32_t bytesSent = 0;
+  uint32_t transfers = 0;
+  bool powerSave = false;
+
+  const uint8_t* currentFont;
+  uint8_t drawColor = 1;
+  int cursorX = 0;
+  int cursorY = 0;
+
+  void sendTiles(uint8_t tx, uint8_t ty, uint8_t tw, uint8_t th, const uint8_t* src, uint8_t srcFirstRow);
+};
+
+class U8G2_SSD1306_128X64_NONAME_F_HW_I2C : public U8G2 {
+public:
+  U8G2_SSD1306_128X64_NONAME_F_HW_I2C(const u8g2_cb_t* rotation, uint8_t reset = U8X8_PIN_NONE,
+                                      uint8_t clock = U8X8_PIN_NONE, uint8_t data = U8X8_PIN_NONE)
+    : U8G2(storage, 8) { (void)rotation; (void)reset; (void)clock; (void)data; }
+
+private:
+  uint8_t storage[8 * 128];
+};
+
+class U8G2_SSD1306_128X64_NONAME_1_HW_I2C : public U8G2 {
+public:
+  U8G2_SSD1306_128X64_NONAME_1_HW_I2C(const u8g2_cb_t* rotation, uint8_t reset = U8X8_PIN_NONE,
+                                      uint8_t clock = U8X8_PIN_NONE, uint8_t data = U8X8_PIN_NONE)
+    : U8G2(storage, 1) { (void)rotation; (void)reset; (void)clock; (void)data; }
+
+private:
+  uint8_t storage[1 * 128];
+};
+
+class U8G2_SSD1306_128X64_NONAME_2_HW_I2C : public U8G2 {
+public:
+  U8G2_SSD1306_128X64_NONAME_2_HW_I2C(const u8g2_cb_t* rotation, uint8_t reset = U8X8_PIN_NONE,
+                                      uint8_t clock = U8X8_PIN_NONE, uint8_t data = U8X8_PIN_NONE)
+    : U8G2(storage, 2) { (void)rotation; (void)reset; (void)clock; (void)data; }
+
+private:
+  uint8_t storage[2 * 128];
+};
+
+#endif // U8G2LIB_H
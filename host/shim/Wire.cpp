@@ -0,0 +1,7 @@
+/*
+ * Host stand-in for the Arduino Wire (I2C) library - implementation
+ */
+
+#include "Wire.h"
+
+TwoWire Wire;
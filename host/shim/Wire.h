@@ -0,0 +1,21 @@
+/*
+ * Host stand-in for the Arduino Wire (I2C) library
+ * Only tracks the bus clock; devices are simulated at a higher level
+ */
+
+#ifndef WIRE_H
+#define WIRE_H
+
+#include "Arduino.h"
+#include "host_hal.h"
+
+class TwoWire {
+public:
+  void begin() {}
+  void begin(int sda, int scl) { (void)sda; (void)scl; }
+  void setClock(uint32_t hz) { hostSetI2cClock(hz); }
+};
+
+extern TwoWire Wire;
+
+#endif // WIRE_H
@@ -0,0 +1,34 @@
+/*
+ * Host stand-in for the ESP8266 NONOS SDK gpio.h
+ * Only the light-sleep wake-up pins
+ */
+
+#ifndef GPIO_H
+#define GPIO_H
+
+#include "user_interface.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GPIO_ID_PIN(n) (n)
+
+typedef enum {
+  GPIO_PIN_INTR_DISABLE = 0,
+  GPIO_PIN_INTR_POSEDGE = 1,
+  GPIO_PIN_INTR_NEGEDGE = 2,
+  GPIO_PIN_INTR_ANYEDGE = 3,
+  GPIO_PIN_INTR_LOLEVEL = 4,
+  GPIO_PIN_INTR_HILEVEL = 5
+} GPIO_INT_TYPE;
+
+// Level that wakes the chip from light sleep (level types only)
+void gpio_pin_wakeup_enable(uint32 pin, GPIO_INT_TYPE state);
+void gpio_pin_wakeup_disable(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GPIO_H
@@ -0,0 +1,129 @@
+/*
+ * Host simulation controls
+ * Lets a host driver steer the virtual clock, GPIO pins, serial streams
+ * and the simulated MPU6050 that sit behind the Arduino stand-ins
+ */
+
+#ifndef HOST_HAL_H
+#define HOST_HAL_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <functional>
+
+// ==================== VIRTUAL CLOCK ====================
+
+// Current virtual time in microseconds (64-bit, never wraps)
+uint64_t hostNowMicros();
+
+// Advance virtual time, stepping every simulated peripheral on the way
+void hostAdvanceMicros(uint64_t us);
+
+// Time charged to the virtual clock by a yield() (busy-wait granularity)
+void hostSetYieldMicros(uint32_t us);
+
+// Bus clock used for I2C time accounting (set by Wire.setClock)
+void hostSetI2cClock(uint32_t hz);
+
+// Charge I2C bus time for a transfer of the given number of bytes
+void hostChargeI2c(uint32_t bytes);
+
+// Enable or disable I2C bus time accounting (enabled by default)
+void hostSetI2cTiming(bool enabled);
+
+// Total bytes moved over the simulated I2C bus
+uint64_t hostI2cBytes();
+
+// ==================== LIGHT SLEEP ====================
+
+// Called every 100 us of virtual time while the chip is in forced light
+// sleep (so drivers can keep scripting inputs); return false to wake it
+// early, e.g. when the simulation is over
+typedef std::function<bool()> HostSleepHook;
+void hostSetSleepHook(HostSleepHook hook);
+
+// Virtual time spent in light sleep. As on the ESP8266, millis() and
+// micros() stand still while asleep; only the RTC keeps counting.
+uint64_t hostSleptMicros();
+
+// ==================== GPIO ====================
+
+// Drive an input pin from outside. Edges fire the attached interrupt unless
+// interrupt is false (the handler then only sees the level when it next runs).
+void hostSetPin(uint8_t pin, int level, bool interrupt = true);
+
+// Run the handler attached to a pin now, as the GPIO interrupt would
+void hostRaiseInterrupt(uint8_t pin);
+
+// ==================== QUADRATURE ENCODER ====================
+
+// Drive two pins from a simulated quadrature encoder (Gray sequence
+// 00 -> 01 -> 11 -> 10 on A:B for increasing position). Each pin edge is one
+// tick. The clock stops at every edge, so handlers see exact edge times.
+void hostSetEncoderPins(uint8_t pinA, uint8_t pinB);
+
+// Turn at a constant rate in ticks per second (negative turns back)
+void hostSetEncoderRate(double ticksPerSecond);
+
+// Quadrature phase error: every other edge comes this fraction of a tick
+// late, so edges arrive in closer pairs (datasheets allow about 0.1-0.25)
+void hostSetEncoderPhaseError(double fraction);
+
+// GPIO interrupt service time: the handler reads the pins this long after
+// the edge that raised it, and edges in between only show up as the level
+// it reads (on the ESP8266: interrupt entry plus the handler up to its read)
+void hostSetIsrServiceMicros(uint32_t us);
+
+// True encoder position in ticks, and the pin edges produced so far
+int64_t hostEncoderPosition();
+uint64_t hostEncoderEdges();
+
+// ==================== SERIAL ====================
+
+// Destination of Serial output (nullptr discards it)
+void hostSetSerialOutput(FILE* out);
+
+// Redirect Serial to a file descriptor (e.g. a pseudo-terminal master)
+void hostSetSerialFd(int fd);
+
+// Queue bytes as if they had been received on Serial
+void hostSerialInject(const char* data, size_t length);
+
+// ==================== MPU6050 ====================
+
+// One sample in native MPU6050 counts: ax, ay, az, gx, gy, gz
+typedef std::function<void(uint64_t timeUs, int16_t sample[6])> HostSampleSource;
+
+// Source the simulated MPU6050 reads its motion data from
+void hostSetSampleSource(HostSampleSource source);
+
+// Wire the simulated MPU6050 INT output to a GPIO pin
+void hostSetMpuIntPin(uint8_t pin);
+
+// Model sensor noise inside the chip: white noise of the given density
+// (accel ug/sqrt(Hz), gyro mdps/sqrt(Hz); MPU6050 typical 400 and 5) at the
+// internal ADC rate, shaped by the configured DLPF. 0, 0 turns it off.
+void hostSetMpuNoiseDensity(double accelMicroG, double gyroMilliDps);
+
+// Restart the noise model's random sequence
+void hostSetMpuNoiseSeed(uint32_t seed);
+
+// Number of samples the simulated sensor has produced so far
+uint64_t hostMpuSamplesProduced();
+
+// Stop the simulated sensor's own sample clock (while held it produces
+// nothing by itself), and produce one sample now: into the FIFO, with a
+// data-ready pulse. Lets a driver reproduce recorded sample times exactly.
+void hostSetMpuHeld(bool held);
+void hostMpuEmitSample(const int16_t sample[6]);
+
+// ==================== FLASH FILE SYSTEM ====================
+
+// Keep LittleFS files in a host directory (created if missing) instead of
+// RAM, so they outlive the run; "/trace0.bin" is stored as DIR/trace0.bin
+void hostSetFsDirectory(const char* path);
+
+// Virtual time LittleFS has spent programming and erasing flash
+uint64_t hostFlashBusyMicros();
+
+#endif // HOST_HAL_H
@@ -0,0 +1,54 @@
+/*
+ * Host stand-in for the ESP8266 NONOS SDK user_interface.h
+ * Only the radio mode, forced light sleep and RTC calls the firmware uses;
+ * light sleep is simulated by the shim's delay() (see host_hal.h)
+ */
+
+#ifndef USER_INTERFACE_H
+#define USER_INTERFACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint8_t uint8;
+typedef int8_t sint8;
+typedef uint32_t uint32;
+
+#define NULL_MODE 0x00
+#define STATION_MODE 0x01
+#define SOFTAP_MODE 0x02
+#define STATIONAP_MODE 0x03
+
+enum sleep_type {
+  NONE_SLEEP_T = 0,
+  LIGHT_SLEEP_T,
+  MODEM_SLEEP_T
+};
+
+// wifi_fpm_do_sleep() with this duration sleeps until a GPIO wakes the chip
+#define FPM_SLEEP_MAX_TIME 0xFFFFFFF
+
+typedef void (*fpm_wakeup_cb)(void);
+
+bool wifi_set_opmode_current(uint8 opmode);
+
+void wifi_fpm_set_sleep_type(enum sleep_type type);
+void wifi_fpm_open(void);
+void wifi_fpm_close(void);
+sint8 wifi_fpm_do_sleep(uint32 sleepTimeUs);
+void wifi_fpm_do_wakeup(void);
+void wifi_fpm_set_wakeup_cb(fpm_wakeup_cb callback);
+
+// RTC counter (keeps running in light sleep) and its period in us, Q12
+uint32 system_get_rtc_time(void);
+uint32 system_rtc_clock_cali_proc(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // USER_INTERFACE_H
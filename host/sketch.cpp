@@ -0,0 +1,8 @@
+/*
+ * Host build of the sketch
+ * The .ino is plain C++ once its prototypes are declared; compile it as a
+ * translation unit so drivers can call setup() and loop()
+ */
+
+#include <Arduino.h>
+#include "telescope_altimeter.ino"
@@ -0,0 +1,247 @@
+/*
+ * Telemetry decoder
+ * Splits a captured serial stream into COBS frames, decodes the sample
+ * records (see telemetry.h) and writes them as CSV or as a binary columnar
+ * file. Power mode changes go to a separate CSV. Text interleaved with the
+ * frames is skipped.
+ *
+ * Usage: telemetry_decode [--columnar] [-o OUTPUT] [--power FILE] [INPUT]
+ *   INPUT defaults to stdin, OUTPUT to stdout; power changes are only
+ *   counted unless --power is given
+ *
+ * Columnar layout (little-endian):
+ *   char[8]  "TLMCOL1\0"
+ *   uint32   row count
+ *   uint32   column count
+ *   per column: char[24] name, char[4] type ("u32", "i16" or "f32")
+ *   per column: row count values, one column after another
+ */
+
+#include "telemetry.h"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+struct SampleRow {
+  uint32_t sequence;  // 16-bit counter unwrapped across rollovers
+  uint32_t timestampUs;
+  int16_t raw[6];
+  float rawAngle;
+  float filteredAltitude;
+};
+
+struct PowerRow {
+  uint32_t sequence;
+  uint32_t timestampUs;
+  uint8_t from;
+  uint8_t to;
+  float averageMilliamps;
+  float savingPercent;
+};
+
+static uint16_t getU16(const uint8_t* p) {
+  return p[0] | (p[1] << 8);
+}
+
+static uint32_t getU32(const uint8_t* p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static float getFloat(const uint8_t* p) {
+  uint32_t bits = getU32(p);
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+static void writeColumnHeader(FILE* out, const char* name, const char* type) {
+  // Zero-padded fixed fields; names are cut to leave a terminator
+  char field[24] = {0};
+  char code[4] = {0};
+  memcpy(field, name, std::min(strlen(name), sizeof(field) - 1));
+  memcpy(code, type, std::min(strlen(type), sizeof(code) - 1));
+  fwrite(field, 1, sizeof(field), out);
+  fwrite(code, 1, sizeof(code), out);
+}
+
+static void writeColumnar(FILE* out, const std::vector<SampleRow>& rows) {
+  static const char* const rawNames[6] = {"ax", "ay", "az", "gx", "gy", "gz"};
+  uint32_t rowCount = rows.size();
+  uint32_t columnCount = 10;
+
+  fwrite("TLMCOL1", 1, 8, out);
+  fwrite(&rowCount, sizeof(rowCount), 1, out);
+  fwrite(&columnCount, sizeof(columnCount), 1, out);
+
+  writeColumnHeader(out, "sequence", "u32");
+  writeColumnHeader(out, "timestamp_us", "u32");
+  for (int c = 0; c < 6; c++) {
+    writeColumnHeader(out, rawNames[c], "i16");
+  }
+  writeColumnHeader(out, "raw_angle", "f32");
+  writeColumnHeader(out, "filtered_altitude", "f32");
+
+  for (const SampleRow& row : rows) fwrite(&row.sequence, sizeof(row.sequence), 1, out);
+  for (const SampleRow& row : rows) fwrite(&row.timestampUs, sizeof(row.timestampUs), 1, out);
+  for (int c = 0; c < 6; c++) {
+    for (const SampleRow& row : rows) fwrite(&row.raw[c], sizeof(row.raw[c]), 1, out);
+  }
+  for (const SampleRow& row : rows) fwrite(&row.rawAngle, sizeof(row.rawAngle), 1, out);
+  for (const SampleRow& row : rows) fwrite(&row.filteredAltitude, sizeof(row.filteredAltitude), 1, out);
+}
+
+static void writeCsv(FILE* out, const std::vector<SampleRow>& rows) {
+  fprintf(out, "sequence,timestamp_us,ax,ay,az,gx,gy,gz,raw_angle,filtered_altitude\n");
+  for (const SampleRow& row : rows) {
+    fprintf(out, "%u,%u,%d,%d,%d,%d,%d,%d,%.5f,%.5f\n", row.sequence, row.timestampUs, row.raw[0], row.raw[1],
+            row.raw[2], row.raw[3], row.raw[4], row.raw[5], row.rawAngle, row.filteredAltitude);
+  }
+}
+
+static void writePowerCsv(FILE* out, const std::vector<PowerRow>& rows) {
+  static const int modeCount = POWER_MODE_COUNT;
+  fprintf(out, "sequence,timestamp_us,from,to,average_ma,saving_percent\n");
+  for (const PowerRow& row : rows) {
+    fprintf(out, "%u,%u,%s,%s,%.3f,%.1f\n", row.sequence, row.timestampUs,
+            row.from < modeCount ? powerModeName((PowerMode)row.from) : "?",
+            row.to < modeCount ? powerModeName((PowerMode)row.to) : "?", row.averageMilliamps, row.savingPercent);
+  }
+}
+
+int main(int argc, char** argv) {
+  const char* inputPath = nullptr;
+  const char* outputPath = nullptr;
+  const char* powerPath = nullptr;
+  bool columnar = false;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--columnar")) {
+      columnar = true;
+    } else if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+      outputPath = argv[++i];
+    } else if (!strcmp(argv[i], "--power") && i + 1 < argc) {
+      powerPath = argv[++i];
+    } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+      fprintf(stderr, "Usage: telemetry_decode [--columnar] [-o OUTPUT] [--power FILE] [INPUT]\n");
+      return 2;
+    } else {
+      inputPath = argv[i];
+    }
+  }
+
+  FILE* in = inputPath && strcmp(inputPath, "-") ? fopen(inputPath, "rb") : stdin;
+  if (!in) {
+    fprintf(stderr, "Cannot open %s\n", inputPath);
+    return 1;
+  }
+
+  std::vector<SampleRow> rows;
+  std::vector<PowerRow> powerRows;
+  std::vector<uint8_t> frame;
+  uint8_t record[TELEMETRY_SAMPLE_BYTES + 1];
+  unsigned long badFrames = 0;
+  unsigned long gaps = 0;
+  unsigned long missing = 0;
+  uint32_t unwrapped = 0;
+  bool haveLast = false;
+  uint16_t lastSequence = 0;
+
+  int c;
+  while ((c = fgetc(in)) != EOF) {
+    if (c != 0) {
+      // Anything longer than a sample frame is text, not telemetry
+      if (frame.size() <= TELEMETRY_FRAME_BYTES) {
+        frame.push_back((uint8_t)c);
+      }
+      continue;
+    }
+
+    if (frame.empty()) {
+      continue;
+    }
+
+    size_t length = frame.size() <= TELEMETRY_FRAME_BYTES ? cobsDecode(frame.data(), frame.size(), record, sizeof(record)) : 0;
+    frame.clear();
+    bool isSample = length == TELEMETRY_SAMPLE_BYTES && record[0] == TELEMETRY_RECORD_SAMPLE;
+    bool isPower = length == TELEMETRY_POWER_BYTES && record[0] == TELEMETRY_RECORD_POWER;
+    if (!isSample && !isPower) {
+      badFrames++;
+      continue;
+    }
+
+    uint16_t sequence = getU16(&record[1]);
+    if (!haveLast) {
+      unwrapped = sequence;
+    } else {
+      uint16_t step = sequence - lastSequence;
+      if (sequence == 0 && step != 1) {
+        // Stream restarted ('tel on' again): continue numbering, not a gap
+        unwrapped++;
+      } else {
+        unwrapped += step;
+        if (step != 1) {
+          gaps++;
+          missing += step - 1;
+        }
+      }
+    }
+    haveLast = true;
+    lastSequence = sequence;
+
+    if (isPower) {
+      PowerRow row;
+      row.sequence = unwrapped;
+      row.timestampUs = getU32(&record[3]);
+      row.from = record[7];
+      row.to = record[8];
+      row.averageMilliamps = getFloat(&record[9]);
+      row.savingPercent = getFloat(&record[13]);
+      powerRows.push_back(row);
+      continue;
+    }
+
+    SampleRow row;
+    row.sequence = unwrapped;
+    row.timestampUs = getU32(&record[3]);
+    for (int i = 0; i < 6; i++) {
+      row.raw[i] = (int16_t)getU16(&record[7 + 2 * i]);
+    }
+    row.rawAngle = getFloat(&record[19]);
+    row.filteredAltitude = getFloat(&record[23]);
+    rows.push_back(row);
+  }
+
+  if (in != stdin) {
+    fclose(in);
+  }
+
+  FILE* out = outputPath ? fopen(outputPath, "wb") : stdout;
+  if (!out) {
+    fprintf(stderr, "Cannot create %s\n", outputPath);
+    return 1;
+  }
+  if (columnar) {
+    writeColumnar(out, rows);
+  } else {
+    writeCsv(out, rows);
+  }
+  if (out != stdout) {
+    fclose(out);
+  }
+
+  if (powerPath) {
+    FILE* power = fopen(powerPath, "w");
+    if (!power) {
+      fprintf(stderr, "Cannot create %s\n", powerPath);
+      return 1;
+    }
+    writePowerCsv(power, powerRows);
+    fclose(power);
+  }
+
+  double spanS = rows.size() > 1 ? (uint32_t)(rows.back().timestampUs - rows.front().timestampUs) / 1e6 : 0.0;
+  fprintf(stderr, "%zu records over %.2f s (%.1f Hz), %zu power changes, %lu gaps (%lu records missing), %lu bad frames\n",
+          rows.size(), spanS, spanS > 0.0 ? (rows.size() - 1) / spanS : 0.0, powerRows.size(), gaps, missing, badFrames);
+  return 0;
+}
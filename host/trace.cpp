@@ -0,0 +1,168 @@
+/*
+ * Motion traces for host drivers - implementation
+ */
+
+#include "trace.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ACCEL_COUNTS_PER_G 16384.0
+#define GYRO_COUNTS_PER_DPS 131.0
+
+static int16_t toCounts(double value) {
+  double counts = lround(value);
+  if (counts > 32767) counts = 32767;
+  if (counts < -32768) counts = -32768;
+  return (int16_t)counts;
+}
+
+// ==================== RECORDED TRACE ====================
+
+bool RecordedTrace::load(const char* path) {
+  FILE* f = fopen(path, "r");
+  if (!f) {
+    return false;
+  }
+
+  rows.clear();
+  cursor = 0;
+
+  char line[256];
+  int lineNumber = 0;
+  while (fgets(line, sizeof(line), f)) {
+    lineNumber++;
+    if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') {
+      continue;
+    }
+
+    Row row;
+    unsigned long long timeUs;
+    int v[6];
+    if (sscanf(line, "%llu,%d,%d,%d,%d,%d,%d", &timeUs, &v[0], &v[1], &v[2], &v[3], &v[4], &v[5]) != 7) {
+      // Allow a header row
+      if (rows.empty() && lineNumber == 1) {
+        continue;
+      }
+      fprintf(stderr, "%s:%d: expected time_us,ax,ay,az,gx,gy,gz\n", path, lineNumber);
+      fclose(f);
+      return false;
+    }
+
+    row.timeUs = timeUs;
+    for (int i = 0; i < 6; i++) {
+      row.sample[i] = toCounts(v[i]);
+    }
+    rows.push_back(row);
+  }
+
+  fclose(f);
+  return !rows.empty();
+}
+
+void RecordedTrace::sampleAt(uint64_t timeUs, int16_t sample[6]) {
+  if (rows.empty()) {
+    return;
+  }
+
+  // The simulated sensor asks in increasing time order - walk forward
+  if (cursor < rows.size() && rows[cursor].timeUs > timeUs) {
+    cursor = 0;
+  }
+  while (cursor + 1 < rows.size() && rows[cursor + 1].timeUs <= timeUs) {
+    cursor++;
+  }
+  memcpy(sample, rows[cursor].sample, sizeof(rows[cursor].sample));
+}
+
+// ==================== SYNTHETIC PROFILE ====================
+
+SyntheticTrace::SyntheticTrace()
+  : totalSeconds(0.0), accelNoise(0.004), gyroNoise(0.05), gyroBias(0.0), rollDeg(0.0), rng(1), gauss(0.0, 1.0) {
+}
+
+bool SyntheticTrace::parse(const char* spec) {
+  segments.clear();
+  totalSeconds = 0.0;
+
+  const char* p = spec;
+  while (*p) {
+    Segment segment;
+    double a, b, c;
+    int used = 0;
+
+    if (sscanf(p, "hold:%lf:%lf%n", &a, &b, &used) == 2 && b > 0) {
+      segment.from = a;
+      segment.rate = 0.0;
+      segment.length = b;
+    } else if (sscanf(p, "slew:%lf:%lf:%lf%n", &a, &b, &c, &used) == 3 && c > 0 && a != b) {
+      segment.from = a;
+      segment.rate = b > a ? c : -c;
+      segment.length = fabs(b - a) / c;
+    } else {
+      fprintf(stderr, "Bad profile segment: %s\n", p);
+      return false;
+    }
+
+    segment.start = totalSeconds;
+    totalSeconds += segment.length;
+    segments.push_back(segment);
+
+    p += used;
+    if (*p == ',') {
+      p++;
+    } else if (*p) {
+      fprintf(stderr, "Bad profile segment: %s\n", p);
+      return false;
+    }
+  }
+
+  return !segments.empty();
+}
+
+const SyntheticTrace::Segment* SyntheticTrace::segmentAt(double seconds) const {
+  for (size_t i = 0; i < segments.size(); i++) {
+    if (seconds < segments[i].start + segments[i].length) {
+      return &segments[i];
+    }
+  }
+  return segments.empty() ? nullptr : &segments.back();
+}
+
+double SyntheticTrace::altitudeAt(double seconds) const {
+  const Segment* segment = segmentAt(seconds);
+  if (!segment) {
+    return 0.0;
+  }
+  double elapsed = std::min(std::max(seconds - segment->start, 0.0), segment->length);
+  return segment->from + segment->rate * elapsed;
+}
+
+double SyntheticTrace::rateAt(double seconds) const {
+  const Segment* segment = segmentAt(seconds);
+  if (!segment || seconds >= totalSeconds) {
+    return 0.0;
+  }
+  return segment->rate;
+}
+
+void SyntheticTrace::sampleAt(uint64_t timeUs, int16_t sample[6]) {
+  double seconds = timeUs / 1e6;
+  double altitude = altitudeAt(seconds) * M_PI / 180.0;
+  double rate = rateAt(seconds);
+  double roll = rollDeg * M_PI / 180.0;
+
+  // Tube along sensor X, tilt axis along Z; the sensor may be rolled about the tube
+  double level = cos(altitude);
+  double gravity[3] = {sin(altitude), level * cos(roll), level * sin(roll)};
+  double omega[3] = {0.0, -rate * sin(roll), rate * cos(roll)};
+
+  for (int i = 0; i < 3; i++) {
+    sample[i] = toCounts(ACCEL_COUNTS_PER_G * (gravity[i] + accelNoise * gauss(rng)));
+  }
+  for (int i = 0; i < 3; i++) {
+    double bias = i == 2 ? gyroBias : 0.0;
+    sample[3 + i] = toCounts(GYRO_COUNTS_PER_DPS * (omega[i] + bias + gyroNoise * gauss(rng)));
+  }
+}
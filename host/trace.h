@@ -0,0 +1,84 @@
+/*
+ * Motion traces for host drivers
+ * Feeds the simulated MPU6050 from a recorded CSV trace or from a
+ * synthetic altitude profile (holds and constant-rate slews)
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "host_hal.h"
+#include <random>
+#include <string>
+#include <vector>
+
+// ==================== RECORDED TRACE ====================
+
+// CSV rows: time_us,ax,ay,az,gx,gy,gz in native counts (+-2 g / +-250 dps).
+// Blank lines and lines starting with '#' are ignored.
+class RecordedTrace {
+public:
+  bool load(const char* path);
+
+  // Sample at or before the given time (holds the last row past the end)
+  void sampleAt(uint64_t timeUs, int16_t sample[6]);
+
+  uint64_t durationUs() const { return rows.empty() ? 0 : rows.back().timeUs; }
+  size_t size() const { return rows.size(); }
+
+private:
+  struct Row {
+    uint64_t timeUs;
+    int16_t sample[6];
+  };
+
+  std::vector<Row> rows;
+  size_t cursor = 0;
+};
+
+// ==================== SYNTHETIC PROFILE ====================
+
+// Segments separated by commas:
+//   hold:ALT:SECONDS        stay at ALT degrees
+//   slew:FROM:TO:DEG_PER_S  move at a constant rate
+class SyntheticTrace {
+public:
+  SyntheticTrace();
+
+  bool parse(const char* spec);
+
+  // Sensor imperfections
+  void setNoise(double accelG, double gyroDps) { accelNoise = accelG; gyroNoise = gyroDps; }
+  void setGyroBias(double dps) { gyroBias = dps; }
+  void setRoll(double degrees) { rollDeg = degrees; }
+  void setSeed(uint32_t seed) { rng.seed(seed); }
+
+  // True tube altitude (degrees) and its rate (deg/s) at a given time
+  double altitudeAt(double seconds) const;
+  double rateAt(double seconds) const;
+
+  void sampleAt(uint64_t timeUs, int16_t sample[6]);
+
+  uint64_t durationUs() const { return (uint64_t)(totalSeconds * 1e6); }
+
+private:
+  struct Segment {
+    double start;     // Seconds from trace start
+    double length;    // Seconds
+    double from;      // Degrees
+    double rate;      // Deg/s
+  };
+
+  const Segment* segmentAt(double seconds) const;
+
+  std::vector<Segment> segments;
+  double totalSeconds;
+  double accelNoise;
+  double gyroNoise;
+  double gyroBias;
+  double rollDeg;
+  std::mt19937 rng;
+  std::normal_distribution<double> gauss;
+};
+
+#endif // TRACE_H
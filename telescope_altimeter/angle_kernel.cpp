@@ -0,0 +1,159 @@
+/*
+ * Angle kernel implementation for Telescope Altimeter
+ */
+
+#include "angle_kernel.h"
+#include <Arduino.h>
+
+// ==================== REFERENCE FRAME ====================
+
+static float dot3(const float a[3], const float b[3]) {
+  return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+static void cross3(const float a[3], const float b[3], float out[3]) {
+  out[0] = a[1] * b[2] - a[2] * b[1];
+  out[1] = a[2] * b[0] - a[0] * b[2];
+  out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+static bool normalize3(float v[3]) {
+  float mag = sqrt(dot3(v, v));
+  if (!(mag > 1e-3)) {
+    return false;  // Also catches NaN from blank EEPROM
+  }
+  v[0] /= mag;
+  v[1] /= mag;
+  v[2] /= mag;
+  return true;
+}
+
+bool buildReferenceFrame(ReferenceFrame& frame, const float levelGravity[3], const float tiltAxis[3]) {
+  float level[3] = {levelGravity[0], levelGravity[1], levelGravity[2]};
+  float axis[3] = {tiltAxis[0], tiltAxis[1], tiltAxis[2]};
+  if (!normalize3(level)) {
+    return false;
+  }
+
+  // Remove any component of the axis along gravity so the basis is orthonormal
+  float along = dot3(axis, level);
+  axis[0] -= along * level[0];
+  axis[1] -= along * level[1];
+  axis[2] -= along * level[2];
+  if (!normalize3(axis)) {
+    return false;
+  }
+
+  // up = axis x level, so that level x up = axis
+  float up[3];
+  cross3(axis, level, up);
+
+  for (int i = 0; i < 3; i++) {
+    frame.level[i] = level[i];
+    frame.up[i] = up[i];
+    frame.axis[i] = axis[i];
+    frame.levelQ15[i] = (int16_t)lroundf(level[i] * 32767.0f);
+    frame.upQ15[i] = (int16_t)lroundf(up[i] * 32767.0f);
+    frame.axisQ15[i] = (int16_t)lroundf(axis[i] * 32767.0f);
+  }
+  return true;
+}
+
+bool measureTiltAxis(const float levelGravity[3], const float raisedGravity[3], float tiltAxis[3]) {
+  // level x raised = sin(altitude) * axis; needs a few degrees of separation
+  cross3(levelGravity, raisedGravity, tiltAxis);
+  float sinAngleScaled = sqrt(dot3(tiltAxis, tiltAxis));
+  float scale = sqrt(dot3(levelGravity, levelGravity) * dot3(raisedGravity, raisedGravity));
+  if (!(scale > 1e-3) || sinAngleScaled / scale < 0.087) {  // sin(5 deg)
+    return false;
+  }
+  return normalize3(tiltAxis);
+}
+
+void provisionalTiltAxis(const float levelGravity[3], float tiltAxis[3]) {
+  // Matches the original sign heuristic: (ref x current).z < 0 is "up"
+  tiltAxis[0] = 0.0;
+  tiltAxis[1] = 0.0;
+  tiltAxis[2] = -1.0;
+
+  float level[3] = {levelGravity[0], levelGravity[1], levelGravity[2]};
+  if (normalize3(level) && fabs(level[2]) > 0.95) {
+    // Gravity along Z: fall back to -X
+    tiltAxis[0] = -1.0;
+    tiltAxis[2] = 0.0;
+  }
+}
+
+// ==================== FLOAT KERNEL ====================
+
+float angleKernelFloat(const ReferenceFrame& frame, float ax, float ay, float az) {
+  float x = ax * frame.level[0] + ay * frame.level[1] + az * frame.level[2];
+  float y = ax * frame.up[0] + ay * frame.up[1] + az * frame.up[2];
+
+  return atan2(y, x) * (180.0 / PI);
+}
+
+// ==================== CORDIC KERNEL ====================
+
+#define CORDIC_ITERATIONS 18
+
+// atan(2^-i) in binary angle units
+static const int32_t cordicAtan[CORDIC_ITERATIONS] = {
+  536870912, 316933406, 167458907, 85004756,
+  42667331, 21354465, 10679838, 5340245,
+  2670163, 1335087, 667544, 333772,
+  166886, 83443, 41722, 20861,
+  10430, 5215
+};
+
+#define BAM_90_DEGREES (1L << 30)
+
+// atan2(y, x) in binary angle units, full circle.
+// |x|, |y| must stay below 2^29 so the CORDIC gain (1.65 * sqrt 2) fits int32.
+static int32_t cordicAtan2(int32_t y, int32_t x) {
+  int32_t z = 0;
+
+  // Pre-rotate into the right half-plane
+  if (x < 0) {
+    int32_t t = x;
+    if (y >= 0) {
+      x = y;
+      y = -t;
+      z = BAM_90_DEGREES;
+    } else {
+      x = -y;
+      y = t;
+      z = -BAM_90_DEGREES;
+    }
+  }
+
+  for (int i = 0; i < CORDIC_ITERATIONS; i++) {
+    int32_t dx = y >> i;
+    int32_t dy = x >> i;
+    if (y > 0) {
+      x += dx;
+      y -= dy;
+      z += cordicAtan[i];
+    } else {
+      x -= dx;
+      y += dy;
+      z -= cordicAtan[i];
+    }
+  }
+  return z;
+}
+
+int32_t angleKernelCordic(const ReferenceFrame& frame, int16_t ax, int16_t ay, int16_t az) {
+  // Counts x Q15 unit vector: |sum| <= |a| * 2^15 < 2^30.8; scale down for CORDIC headroom
+  int32_t x = ((int32_t)ax * frame.levelQ15[0] + (int32_t)ay * frame.levelQ15[1] + (int32_t)az * frame.levelQ15[2]) >> 3;
+  int32_t y = ((int32_t)ax * frame.upQ15[0] + (int32_t)ay * frame.upQ15[1] + (int32_t)az * frame.upQ15[2]) >> 3;
+
+  return cordicAtan2(y, x);
+}
+
+// ==================== GYRO RATE ====================
+
+int32_t tiltRateKernel(const ReferenceFrame& frame, int16_t gx, int16_t gy, int16_t gz) {
+  int32_t rotation = (int32_t)gx * frame.axisQ15[0] + (int32_t)gy * frame.axisQ15[1] + (int32_t)gz * frame.axisQ15[2];
+  return -(rotation >> 15);
+}
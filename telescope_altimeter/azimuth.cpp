@@ -0,0 +1,183 @@
+/*
+ * Azimuth encoder implementation for Telescope Altimeter
+ */
+
+#include "azimuth.h"
+#include "config.h"
+#include <atomic>
+
+// Step for (previous A:B << 2) | current A:B, for the Gray sequence
+// 00 -> 01 -> 11 -> 10 counting up. QUADRATURE_SKIP: both phases changed,
+// i.e. two edges landed before the ISR read the pins.
+#define QUADRATURE_SKIP 2
+
+static const int8_t quadratureSteps[16] = {
+  0,  +1, -1, QUADRATURE_SKIP,
+  -1, 0,  QUADRATURE_SKIP, +1,
+  +1, QUADRATURE_SKIP, 0,  -1,
+  QUADRATURE_SKIP, -1, +1, 0
+};
+
+// ISR state (written with interrupts off outside the ISR)
+static uint8_t isrPinA = 0;
+static uint8_t isrPinB = 0;
+static uint8_t phases = 0;     // A:B at the last ISR run
+static int8_t lastStep = 0;    // Direction of the last single step
+static uint32_t lastCountUs = 0;
+
+// Only the ISR writes these, so a load and a store stand in for an
+// increment (the ESP8266 has no atomic read-modify-write)
+static std::atomic<int32_t> tickCount(0);
+static std::atomic<uint32_t> edgeCount(0);
+static std::atomic<uint32_t> recoveredCount(0);
+static std::atomic<uint32_t> lostCount(0);
+static std::atomic<uint32_t> minEdgeUs(UINT32_MAX);
+
+static inline void IRAM_ATTR bump(std::atomic<uint32_t>& counter, uint32_t amount) {
+  counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+static uint8_t IRAM_ATTR readPhases() {
+  // Both phases in one register read, so they are from the same instant
+  uint32_t levels = GPI;
+  return (((levels >> isrPinA) & 1) << 1) | ((levels >> isrPinB) & 1);
+}
+
+static void IRAM_ATTR onEncoderEdge() {
+  uint8_t now = readPhases();
+  int8_t step = quadratureSteps[(phases << 2) | now];
+  phases = now;
+
+  if (step == 0) {
+    return;  // The previous run already counted this edge
+  }
+
+  uint32_t edges = 1;
+  if (step == QUADRATURE_SKIP) {
+    if (lastStep == 0) {
+      bump(lostCount, 1);
+      return;
+    }
+    // Two edges between reads: the shaft cannot reverse that fast
+    step = 2 * lastStep;
+    edges = 2;
+    bump(recoveredCount, 1);
+  } else {
+    lastStep = step;
+  }
+
+  tickCount.store(tickCount.load(std::memory_order_relaxed) + step, std::memory_order_relaxed);
+  bump(edgeCount, edges);
+
+  uint32_t nowUs = micros();
+  uint32_t perEdge = (nowUs - lastCountUs) / edges;
+  lastCountUs = nowUs;
+  if (perEdge < minEdgeUs.load(std::memory_order_relaxed)) {
+    minEdgeUs.store(perEdge, std::memory_order_relaxed);
+  }
+}
+
+// In IRAM: the data-ready ISR latches the count with every sample, and may
+// run while a flash write has the cache off
+int32_t IRAM_ATTR azimuthTicks() {
+  return tickCount.load(std::memory_order_relaxed);
+}
+
+AzimuthEncoder::AzimuthEncoder(uint8_t pinA, uint8_t pinB)
+  : pinA(pinA),
+    pinB(pinB),
+    calibration{AZIMUTH_DEFAULT_TICKS_PER_REV},
+    syncTicks(0),
+    syncDegrees(0.0) {
+}
+
+void AzimuthEncoder::begin() {
+  isrPinA = pinA;
+  isrPinB = pinB;
+  pinMode(pinA, INPUT_PULLUP);
+  pinMode(pinB, INPUT_PULLUP);
+  phases = readPhases();
+  lastCountUs = micros();
+  attachInterrupt(digitalPinToInterrupt(pinA), onEncoderEdge, CHANGE);
+  attachInterrupt(digitalPinToInterrupt(pinB), onEncoderEdge, CHANGE);
+}
+
+bool AzimuthEncoder::rearm() {
+  int32_t before = azimuthTicks();
+  attachInterrupt(digitalPinToInterrupt(pinA), onEncoderEdge, CHANGE);
+  attachInterrupt(digitalPinToInterrupt(pinB), onEncoderEdge, CHANGE);
+
+  noInterrupts();
+  onEncoderEdge();
+  interrupts();
+  return azimuthTicks() != before;
+}
+
+void AzimuthEncoder::setCalibration(const AzimuthCalibration& newCalibration) {
+  calibration = newCalibration;
+}
+
+void AzimuthEncoder::sync(int32_t ticks, float degrees) {
+  syncTicks = ticks;
+  syncDegrees = degrees;
+}
+
+float AzimuthEncoder::toDegrees(int32_t ticks) const {
+  if (!isCalibrated()) {
+    return 0.0;
+  }
+
+  // Within one turn first, so the float keeps its precision
+  int32_t offset = (ticks - syncTicks) % calibration.ticksPerRev;
+  float degrees = syncDegrees + offset * 360.0f / calibration.ticksPerRev;
+  degrees = fmodf(degrees, 360.0f);
+  return degrees < 0.0f ? degrees + 360.0f : degrees;
+}
+
+void AzimuthEncoder::getStats(AzimuthStats& stats) const {
+  stats.edges = edgeCount.load(std::memory_order_relaxed);
+  stats.recovered = recoveredCount.load(std::memory_order_relaxed);
+  stats.lost = lostCount.load(std::memory_order_relaxed);
+  stats.minEdgeUs = minEdgeUs.load(std::memory_order_relaxed);
+}
+
+void AzimuthEncoder::printStats(Print& out) const {
+  int32_t ticks = getTicks();
+  out.print("Azimuth: ");
+  if (isCalibrated()) {
+    out.print(toDegrees(ticks), 2);
+    out.print(" deg (");
+    out.print(ticks);
+    out.print(" ticks, ");
+    out.print(calibration.ticksPerRev);
+    out.println(" ticks/rev)");
+  } else {
+    out.print(ticks);
+    out.println(" ticks (not calibrated: 'az rev' or 'az cpr N')");
+  }
+
+  AzimuthStats stats;
+  getStats(stats);
+  out.print("Encoder: ");
+  out.print(stats.edges);
+  out.print(" edges, fastest ");
+  if (stats.minEdgeUs == UINT32_MAX) {
+    out.print("-");
+  } else {
+    out.print(1000000UL / max(stats.minEdgeUs, (uint32_t)1));
+  }
+  out.print(" edges/s, ");
+  out.print(stats.recovered);
+  out.print(" double edges recovered, ");
+  out.print(stats.lost);
+  out.println(" lost");
+}
+
+void AzimuthEncoder::resetStats() {
+  noInterrupts();
+  edgeCount.store(0, std::memory_order_relaxed);
+  recoveredCount.store(0, std::memory_order_relaxed);
+  lostCount.store(0, std::memory_order_relaxed);
+  minEdgeUs.store(UINT32_MAX, std::memory_order_relaxed);
+  interrupts();
+}
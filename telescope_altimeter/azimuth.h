@@ -0,0 +1,70 @@
+/*
+ * Azimuth encoder for Telescope Altimeter
+ * A pin-change interrupt decodes a quadrature encoder on the azimuth
+ * bearing into a tick counter (one tick per edge of either phase). The ISR
+ * is the counter's only writer, so readers need no lock: one aligned 32-bit
+ * load always sees a whole count. The MPU6050 data-ready interrupt latches
+ * the same counter, so each FIFO sample carries the azimuth of its own
+ * timestamp (TimedSample).
+ */
+
+#ifndef AZIMUTH_H
+#define AZIMUTH_H
+
+#include <Arduino.h>
+
+// Encoder scale, saved with the altitude calibration (calibration.h). The
+// count restarts at 0 on every boot, so the heading itself is set per
+// session (sync()).
+struct AzimuthCalibration {
+  int32_t ticksPerRev;  // Ticks per turn of the bearing; negative when the count falls turning east; 0 = uncalibrated
+};
+
+struct AzimuthStats {
+  uint32_t edges;          // Edges counted
+  uint32_t recovered;      // ISR runs that found both phases changed and counted two edges (direction of the step before)
+  uint32_t lost;           // ...with no direction known yet; the count may be 2 off
+  uint32_t minEdgeUs;      // Shortest time per edge between two counting ISR runs
+};
+
+// Current count; safe to call from an ISR (it is in IRAM)
+int32_t azimuthTicks();
+
+// The interrupt state is static, so there is one encoder per sketch
+class AzimuthEncoder {
+public:
+  AzimuthEncoder(uint8_t pinA, uint8_t pinB);
+
+  // Initialization: pull-ups and the pin-change interrupts
+  void begin();
+
+  // Re-attach after light sleep (which reprograms a pin for level wake-up)
+  // and count what changed meanwhile; returns true when the encoder moved.
+  // Edges during the wake-up itself (a few ms) are missed.
+  bool rearm();
+
+  int32_t getTicks() const { return azimuthTicks(); }
+
+  void setCalibration(const AzimuthCalibration& calibration);
+  const AzimuthCalibration& getCalibration() const { return calibration; }
+  bool isCalibrated() const { return calibration.ticksPerRev != 0; }
+
+  // Session reference: the position at ticks is this azimuth
+  void sync(int32_t ticks, float degrees);
+
+  // Azimuth (0-360 degrees) at a tick count; 0 while uncalibrated
+  float toDegrees(int32_t ticks) const;
+
+  void getStats(AzimuthStats& stats) const;
+  void printStats(Print& out) const;
+  void resetStats();
+
+private:
+  uint8_t pinA;
+  uint8_t pinB;
+  AzimuthCalibration calibration;
+  int32_t syncTicks;
+  float syncDegrees;
+};
+
+#endif // AZIMUTH_H
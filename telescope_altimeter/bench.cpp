@@ -0,0 +1,209 @@
+/*
+ * Benchmarks implementation for Telescope Altimeter
+ */
+
+#include "bench.h"
+#include "angle_kernel.h"
+#include "filter.h"
+#include "decimator.h"
+#include "lx200.h"
+#include "recorder.h"
+#include "pipeline.h"
+
+// Calls timed between cycle-counter reads; keeps each interval far below the
+// 32-bit counter wrap (53 s at 80 MHz) and lets the watchdog be fed between chunks
+#define BENCH_CHUNK 256
+
+// Readings in the accuracy sweep: -10 to +100 degrees in 0.05 degree steps
+#define BENCH_SWEEP_START -10.0
+#define BENCH_SWEEP_STEP 0.05
+#define BENCH_SWEEP_COUNT 2201
+
+// Results are folded in here so the compiler cannot drop the timed calls
+static volatile float benchSink;
+
+// Table of synthetic readings cycled through by the timed loops
+#define BENCH_SAMPLES 64
+static RawSample benchSamples[BENCH_SAMPLES];
+
+// Raw counts of 1 g at the given altitude against the calibrated frame (at
+// the configured ACCEL_RANGE, so the kernel errors include its resolution)
+static RawSample sampleAtAltitude(const ReferenceFrame& frame, double degrees) {
+  double t = degrees * DEG_TO_RAD;
+  double c = cos(t) * AccelScale::lsbPerG;
+  double s = sin(t) * AccelScale::lsbPerG;
+
+  RawSample sample;
+  sample.ax = (int16_t)lround(c * frame.level[0] + s * frame.up[0]);
+  sample.ay = (int16_t)lround(c * frame.level[1] + s * frame.up[1]);
+  sample.az = (int16_t)lround(c * frame.level[2] + s * frame.up[2]);
+  sample.gx = 0;
+  sample.gy = 0;
+  sample.gz = 0;
+  return sample;
+}
+
+// Exact altitude of a quantized reading, so only the kernel's own error counts
+static double referenceAngle(const ReferenceFrame& frame, const RawSample& sample) {
+  double g[3] = {(double)sample.ax, (double)sample.ay, (double)sample.az};
+  double y = g[0] * frame.up[0] + g[1] * frame.up[1] + g[2] * frame.up[2];
+  double x = g[0] * frame.level[0] + g[1] * frame.level[1] + g[2] * frame.level[2];
+  return atan2(y, x) * RAD_TO_DEG;
+}
+
+static double wrapDegrees(double degrees) {
+  while (degrees > 180.0) degrees -= 360.0;
+  while (degrees < -180.0) degrees += 360.0;
+  return degrees;
+}
+
+static float kernelFloat(const ReferenceFrame& frame, const RawSample& sample) {
+  return angleKernelFloat(frame, sample.ax, sample.ay, sample.az);
+}
+
+static float kernelCordic(const ReferenceFrame& frame, const RawSample& sample) {
+  return angleKernelCordic(frame, sample.ax, sample.ay, sample.az) * BAM_TO_DEGREES;
+}
+
+// Worst-case error in arcminutes over the sweep
+static float kernelMaxError(const ReferenceFrame& frame, float (*kernel)(const ReferenceFrame&, const RawSample&)) {
+  double worst = 0.0;
+  for (int i = 0; i < BENCH_SWEEP_COUNT; i++) {
+    RawSample sample = sampleAtAltitude(frame, BENCH_SWEEP_START + i * BENCH_SWEEP_STEP);
+    double error = fabs(wrapDegrees(kernel(frame, sample) - referenceAngle(frame, sample)));
+    if (error > worst) {
+      worst = error;
+    }
+    if (i % BENCH_CHUNK == 0) {
+      yield();
+    }
+  }
+  return worst * 60.0;
+}
+
+// Cycles per call of body(i), timed in chunks
+template <typename Body>
+static float cyclesPerCall(uint32_t iterations, Body body) {
+  uint64_t total = 0;
+  uint32_t done = 0;
+
+  while (done < iterations) {
+    uint32_t chunk = iterations - done < BENCH_CHUNK ? iterations - done : BENCH_CHUNK;
+
+    uint32_t start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < chunk; i++) {
+      body(done + i);
+    }
+    total += (uint32_t)(ESP.getCycleCount() - start);
+
+    done += chunk;
+    yield();
+  }
+
+  return iterations ? (float)total / iterations : 0.0;
+}
+
+static void printRow(Print& out, const char* name, float cycles, float maxErrorArcmin) {
+  char line[64];
+  float us = cycles / ESP.getCpuFreqMHz();
+  if (maxErrorArcmin >= 0.0) {
+    snprintf(line, sizeof(line), "%-24s %10.1f %9.3f %9.3f", name, cycles, us, maxErrorArcmin);
+  } else {
+    snprintf(line, sizeof(line), "%-24s %10.1f %9.3f %9s", name, cycles, us, "-");
+  }
+  out.println(line);
+}
+
+void runBenchmarks(Print& out, uint32_t iterations, TelescopeSensor& sensor,
+                   CalibrationManager& calibration, TelescopeDisplay& display) {
+  const ReferenceFrame& frame = calibration.getReferenceFrame();
+
+  for (int i = 0; i < BENCH_SAMPLES; i++) {
+    benchSamples[i] = sampleAtAltitude(frame, i * (90.0 / BENCH_SAMPLES));
+  }
+
+  out.print("Benchmark: ");
+  out.print((unsigned long)iterations);
+  out.print(" calls per stage, CPU ");
+  out.print((unsigned long)ESP.getCpuFreqMHz());
+  out.println(" MHz");
+  out.println("stage                    cycles/call   us/call  maxerr'");
+
+  float cycles;
+
+  cycles = cyclesPerCall(iterations, [&](uint32_t i) {
+    benchSink = kernelFloat(frame, benchSamples[i % BENCH_SAMPLES]);
+  });
+  printRow(out, "angle kernel float", cycles, kernelMaxError(frame, kernelFloat));
+
+  cycles = cyclesPerCall(iterations, [&](uint32_t i) {
+    benchSink = kernelCordic(frame, benchSamples[i % BENCH_SAMPLES]);
+  });
+  printRow(out, "angle kernel cordic", cycles, kernelMaxError(frame, kernelCordic));
+
+  cycles = cyclesPerCall(iterations, [&](uint32_t i) {
+    benchSink = sensor.calculateRawAngle(benchSamples[i % BENCH_SAMPLES], frame);
+  });
+  printRow(out, "calculateRawAngle", cycles, -1.0);
+
+  cycles = cyclesPerCall(iterations, [&](uint32_t i) {
+    benchSink = calibration.applyCalibratedOffset(i * 0.01);
+  });
+  printRow(out, "applyCalibratedOffset", cycles, -1.0);
+
+  CicDecimator decimator;
+  TimedSample decimated;
+  cycles = cyclesPerCall(iterations, [&](uint32_t i) {
+    TimedSample input;
+    input.timestampUs = i;
+    input.raw = benchSamples[i % BENCH_SAMPLES];
+    if (decimator.push(input, decimated)) {
+      benchSink = decimated.raw.ax;
+    }
+  });
+  printRow(out, "cic decimator (input)", cycles, -1.0);
+
+  AltitudeFilter filter;
+  cycles = cyclesPerCall(iterations, [&](uint32_t i) {
+    benchSink = filter.update(45.0 + (i % 100) * 0.01, 0.5, 0.1);
+  });
+  printRow(out, "altitude filter", cycles, -1.0);
+
+  uint8_t record[TRACE_SAMPLE_MAX_BYTES];
+  cycles = cyclesPerCall(iterations, [&](uint32_t i) {
+    TimedSample previous, sample;
+    previous.timestampUs = i * 5000;
+    previous.azimuthTicks = 0;
+    previous.raw = benchSamples[i % BENCH_SAMPLES];
+    sample.timestampUs = previous.timestampUs + 5000 + (i & 7);
+    sample.azimuthTicks = i & 1;
+    sample.raw = benchSamples[(i + 1) % BENCH_SAMPLES];
+    benchSink = traceEncodeSample(record, sample, previous, 5000);
+  });
+  printRow(out, "trace sample encode", cycles, -1.0);
+
+  char reply[LX200_REPLY_LENGTH];
+  cycles = cyclesPerCall(iterations, [&](uint32_t i) {
+    benchSink = lx200FormatAngle(reply, (int32_t)(i % 648000) - 324000, true, true) + reply[3];
+  });
+  printRow(out, "lx200 :GA# reply", cycles, -1.0);
+
+  // A frame costs far more than the math; scale the call count down
+  uint32_t displayIterations = iterations / 100 > 0 ? iterations / 100 : 1;
+  cycles = cyclesPerCall(displayIterations, [&](uint32_t i) {
+    // A new reading every call, so each frame has changed pages to send
+    display.update(MODE_NORMAL, 30.0 + i * 0.017, 30.0, true);
+    display.flush();
+  });
+  printRow(out, "display update", cycles, -1.0);
+
+  out.print("Display buffer: ");
+  out.print(DISPLAY_BUFFER_BYTES);
+  out.print(" B (");
+  out.print(1024 - DISPLAY_BUFFER_BYTES);
+  out.print(" B saved vs full buffer, ");
+  out.print(DisplayBuffer::full ? 1 : DISPLAY_PAGES);
+  out.print(" redraws per frame), sprites: ");
+  out.print(display.getSpriteBytes());
+  out.println(" B");
+}
@@ -0,0 +1,21 @@
+/*
+ * Benchmarks for Telescope Altimeter
+ * Times the per-frame hot paths with ESP.getCycleCount() and measures the
+ * accuracy of each angle kernel. Runs unchanged on the device and on the
+ * host build, so the tables can be compared directly.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <Arduino.h>
+#include "sensor.h"
+#include "calibration.h"
+#include "display.h"
+
+// Run every benchmark for the given number of calls and print the table.
+// Uses the live calibration (reference frame and offsets) and display.
+void runBenchmarks(Print& out, uint32_t iterations, TelescopeSensor& sensor,
+                   CalibrationManager& calibration, TelescopeDisplay& display);
+
+#endif // BENCH_H
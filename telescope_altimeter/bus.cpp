@@ -0,0 +1,67 @@
+/*
+ * Shared I2C bus scheduler implementation for Telescope Altimeter
+ */
+
+#include "bus.h"
+#include "config.h"
+#include "display.h"  // Slots are sized to DISPLAY_PAGE_ROWS
+
+#define BUS_CYCLE_US ((uint32_t)BUS_SLOT_MS * BUS_SLOTS_PER_CYCLE * 1000UL)
+
+static_assert(SENSOR_TASK_PERIOD_MS % BUS_SLOT_MS == 0, "The sensor period must be a whole number of bus slots");
+static_assert(BUS_SLOTS_PER_CYCLE >= 2, "The display needs at least one slot per cycle");
+
+BusScheduler::BusScheduler()
+  : sensorTransfer(nullptr),
+    displayTransfer(nullptr),
+    slot(0),
+    lastSensorUs(0),
+    maxSensorJitterUs(0),
+    cycles(0),
+    pagesSent(0),
+    idleSlots(0) {
+}
+
+void BusScheduler::runSlot() {
+  if (slot == 0) {
+    uint32_t now = micros();
+    if (cycles > 0) {
+      uint32_t spacing = now - lastSensorUs;
+      uint32_t jitter = spacing > BUS_CYCLE_US ? spacing - BUS_CYCLE_US : BUS_CYCLE_US - spacing;
+      if (jitter > maxSensorJitterUs) {
+        maxSensorJitterUs = jitter;
+      }
+    }
+    lastSensorUs = now;
+    cycles++;
+
+    if (sensorTransfer) {
+      sensorTransfer();
+    }
+  } else if (displayTransfer && displayTransfer()) {
+    pagesSent++;
+  } else {
+    idleSlots++;
+  }
+
+  slot = (slot + 1) % BUS_SLOTS_PER_CYCLE;
+}
+
+void BusScheduler::printStats(Print& out) const {
+  out.print("Bus: ");
+  out.print(cycles);
+  out.print(" cycles, sensor jitter max ");
+  out.print(maxSensorJitterUs);
+  out.print(" us, ");
+  out.print(pagesSent);
+  out.print(" pages, ");
+  out.print(idleSlots);
+  out.println(" idle slots");
+}
+
+void BusScheduler::resetStats() {
+  maxSensorJitterUs = 0;
+  cycles = 0;
+  pagesSent = 0;
+  idleSlots = 0;
+}
@@ -0,0 +1,46 @@
+/*
+ * Shared I2C bus scheduler for Telescope Altimeter
+ * The MPU6050 and the SSD1306 share one bus; this runs their transfers on a
+ * fixed slot plan so a display refresh never locks the sensor out
+ */
+
+#ifndef BUS_H
+#define BUS_H
+
+#include <Arduino.h>
+#include "scheduler.h"
+
+// Moves at most one chunk over the bus; returns false when nothing was pending
+typedef bool (*BusTransfer)();
+
+class BusScheduler {
+public:
+  BusScheduler();
+
+  // Runs in the first slot of every cycle
+  void setSensorTransfer(TaskCallback transfer) { sensorTransfer = transfer; }
+
+  // Runs once in each of the other slots (one display page per call)
+  void setDisplayTransfer(BusTransfer transfer) { displayTransfer = transfer; }
+
+  // Run the next slot - register as a scheduler task every BUS_SLOT_MS
+  void runSlot();
+
+  // Sensor slot spacing and display slot usage
+  void printStats(Print& out) const;
+  void resetStats();
+
+private:
+  TaskCallback sensorTransfer;
+  BusTransfer displayTransfer;
+  uint8_t slot;
+
+  // Statistics
+  uint32_t lastSensorUs;
+  uint32_t maxSensorJitterUs;  // Worst deviation of the sensor slot spacing from the cycle length
+  unsigned long cycles;
+  unsigned long pagesSent;
+  unsigned long idleSlots;     // Display slots with nothing to send
+};
+
+#endif // BUS_H
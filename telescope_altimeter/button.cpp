@@ -4,57 +4,134 @@
 
 #include "button.h"
 #include "config.h"
+#include "ring_buffer.h"
+
+// Debounced events, pushed by the pin-change ISR and popped by the UI
+static SpscRing<ButtonEvent, BUTTON_EVENT_QUEUE_SIZE> buttonEvents;
+
+// ISR state (written with interrupts off outside the ISR)
+static uint8_t isrPin = 0;
+static volatile bool stablePressed = false;
+static volatile uint32_t lastEdgeUs = 0;       // Last accepted edge
+static volatile uint32_t pressUs = 0;          // Start of the current/last press
+static volatile uint32_t lastShortUs = 0;      // Release of the last short press
+static volatile bool shortArmed = false;       // ...which a second press can turn into a double
+static volatile bool doublePress = false;      // The current/last press completed a double
+
+static void IRAM_ATTR queueEvent(ButtonEventType type, uint32_t timestampUs, uint32_t durationMs) {
+  ButtonEvent event;
+  event.type = type;
+  event.timestampUs = timestampUs;
+  event.durationMs = durationMs;
+  buttonEvents.push(event);
+}
+
+static void IRAM_ATTR onButtonEdge() {
+  uint32_t now = micros();
+  bool pressed = digitalRead(isrPin) == LOW;
+
+  // Leading-edge debounce: the first edge counts at once, then the contact
+  // gets DEBOUNCE_DELAY to settle
+  if (pressed == stablePressed || now - lastEdgeUs < DEBOUNCE_DELAY * 1000UL) {
+    return;
+  }
+  lastEdgeUs = now;
+  stablePressed = pressed;
+
+  if (pressed) {
+    pressUs = now;
+    queueEvent(BUTTON_PRESS, now, 0);
+    doublePress = shortArmed && now - lastShortUs < DOUBLE_PRESS_MS * 1000UL;
+    if (doublePress) {
+      queueEvent(BUTTON_DOUBLE_PRESS, now, 0);
+    }
+    return;
+  }
+
+  uint32_t heldMs = (now - pressUs) / 1000;
+  queueEvent(BUTTON_RELEASE, now, heldMs);
+  if (heldMs < LONG_PRESS_TIME) {
+    queueEvent(BUTTON_SHORT_PRESS, now, heldMs);
+
+    // The second press of a double does not start another one
+    shortArmed = !doublePress;
+    lastShortUs = now;
+  } else {
+    shortArmed = false;
+  }
+}
+
+// An edge the ISR dropped inside the lockout (e.g. a release within
+// DEBOUNCE_DELAY of the press) leaves the pin away from the debounced state;
+// run the edge handler once more after the lockout
+static void resync() {
+  noInterrupts();
+  onButtonEdge();
+  interrupts();
+}
 
 ButtonHandler::ButtonHandler(uint8_t pin)
   : buttonPin(pin),
-    lastButtonState(HIGH),
-    buttonPressTime(0),
-    longPressDetected(false),
-    shortPressReady(false),
-    longPressReady(false) {
+    longPressReported(false),
+    heldEvent(),
+    hasHeldEvent(false) {
 }
 
 void ButtonHandler::begin() {
+  isrPin = buttonPin;
   pinMode(buttonPin, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(buttonPin), onButtonEdge, CHANGE);
 }
 
-void ButtonHandler::update() {
-  bool buttonState = digitalRead(buttonPin);
+void ButtonHandler::rearm() {
+  attachInterrupt(digitalPinToInterrupt(buttonPin), onButtonEdge, CHANGE);
+  resync();
+}
 
-  // Clear flags at the start of each update
-  shortPressReady = false;
-  longPressReady = false;
+bool ButtonHandler::isPressed() const {
+  return stablePressed;
+}
 
-  // Detect button press (HIGH to LOW transition)
-  if (buttonState == LOW && lastButtonState == HIGH) {
-    buttonPressTime = millis();
-    longPressDetected = false;
-  }
+uint32_t ButtonHandler::getDroppedEvents() const {
+  return buttonEvents.dropped();
+}
 
-  // Detect long press while button is held
-  if (buttonState == LOW && !longPressDetected) {
-    if (millis() - buttonPressTime > LONG_PRESS_TIME) {
-      longPressDetected = true;
-      longPressReady = true;
-    }
+bool ButtonHandler::nextEvent(ButtonEvent& event) {
+  if (hasHeldEvent) {
+    event = heldEvent;
+    hasHeldEvent = false;
+    return true;
   }
 
-  // Detect button release
-  if (buttonState == HIGH && lastButtonState == LOW) {
-    unsigned long pressDuration = millis() - buttonPressTime;
+  uint32_t now = micros();
+  if (buttonEvents.isEmpty() && (digitalRead(buttonPin) == LOW) != stablePressed &&
+      now - lastEdgeUs >= DEBOUNCE_DELAY * 1000UL) {
+    resync();
+  }
 
-    if (pressDuration < LONG_PRESS_TIME && !longPressDetected) {
-      shortPressReady = true;
+  if (buttonEvents.pop(event)) {
+    if (event.type == BUTTON_PRESS) {
+      longPressReported = false;
+    } else if (event.type == BUTTON_RELEASE && event.durationMs >= LONG_PRESS_TIME && !longPressReported) {
+      // Held through a long stall: report the long press before its release
+      heldEvent = event;
+      hasHeldEvent = true;
+      longPressReported = true;
+      event.type = BUTTON_LONG_PRESS;
+      event.timestampUs = heldEvent.timestampUs - (heldEvent.durationMs - LONG_PRESS_TIME) * 1000UL;
+      event.durationMs = LONG_PRESS_TIME;
     }
+    return true;
   }
 
-  lastButtonState = buttonState;
-}
-
-bool ButtonHandler::wasShortPressed() {
-  return shortPressReady;
-}
+  // Queue empty: the newest press is the one in progress
+  if (stablePressed && !longPressReported && now - pressUs >= LONG_PRESS_TIME * 1000UL) {
+    longPressReported = true;
+    event.type = BUTTON_LONG_PRESS;
+    event.timestampUs = pressUs + LONG_PRESS_TIME * 1000UL;
+    event.durationMs = LONG_PRESS_TIME;
+    return true;
+  }
 
-bool ButtonHandler::wasLongPressed() {
-  return longPressReady;
+  return false;
 }
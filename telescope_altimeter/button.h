@@ -1,6 +1,7 @@
 /*
  * Button handler for Telescope Altimeter
- * Handles button debouncing and press detection
+ * A pin-change interrupt debounces the button and queues timestamped
+ * press/release events; the UI drains them whenever it gets to run
  */
 
 #ifndef BUTTON_H
@@ -8,27 +9,47 @@
 
 #include <Arduino.h>
 
+enum ButtonEventType {
+  BUTTON_PRESS,         // Contact made
+  BUTTON_RELEASE,       // Contact broken; durationMs is how long it was held
+  BUTTON_SHORT_PRESS,   // Released before LONG_PRESS_TIME (sent after RELEASE)
+  BUTTON_LONG_PRESS,    // Held for LONG_PRESS_TIME (sent once, while still held)
+  BUTTON_DOUBLE_PRESS   // Second press within DOUBLE_PRESS_MS of a short press (sent after PRESS)
+};
+
+struct ButtonEvent {
+  ButtonEventType type;
+  uint32_t timestampUs;  // micros() of the edge (LONG_PRESS: press + LONG_PRESS_TIME)
+  uint32_t durationMs;   // RELEASE and SHORT_PRESS: time held
+};
+
+// The interrupt state is static, so there is one button per sketch
 class ButtonHandler {
 public:
   ButtonHandler(uint8_t pin);
 
-  // Initialization
+  // Initialization: pull-up and the pin-change interrupt
   void begin();
 
-  // Update button state (call in main loop)
-  void update();
+  // Pop the next event; returns false when none is pending. LONG_PRESS is
+  // generated here, when the press it belongs to has been held long enough.
+  bool nextEvent(ButtonEvent& event);
+
+  // Re-attach after light sleep (which reprograms the pin for level
+  // wake-up) and pick up a press that woke the chip
+  void rearm();
+
+  // Current debounced state
+  bool isPressed() const;
 
-  // Check for button events
-  bool wasShortPressed();
-  bool wasLongPressed();
+  // Events lost to a full queue
+  uint32_t getDroppedEvents() const;
 
 private:
   uint8_t buttonPin;
-  bool lastButtonState;
-  unsigned long buttonPressTime;
-  bool longPressDetected;
-  bool shortPressReady;
-  bool longPressReady;
+  bool longPressReported;  // For the press in progress
+  ButtonEvent heldEvent;   // A RELEASE returned after the LONG_PRESS it implies
+  bool hasHeldEvent;
 };
 
 #endif // BUTTON_H
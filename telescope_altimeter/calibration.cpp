@@ -4,18 +4,27 @@
 
 #include "calibration.h"
 #include "config.h"
+#include "estimator.h"
+#include "console.h"
 #include <EEPROM.h>
 #include <Arduino.h>
 
+static_assert(sizeof(CalibrationRecord) <= JOURNAL_MAX_PAYLOAD, "calibration record exceeds a journal slot");
+
 CalibrationManager::CalibrationManager(TelescopeSensor& sensorRef)
   : sensor(sensorRef),
     zeroOffset(0.0),
     stopA_raw(0.0),
     stopB_raw(0.0),
     calibrated(false),
+    azimuth{AZIMUTH_DEFAULT_TICKS_PER_REV},
     tubeAxis_x(0.0),
     tubeAxis_y(1.0),  // Default: assume Y-axis
-    tubeAxis_z(0.0) {
+    tubeAxis_z(0.0),
+    tiltAxis_x(0.0),
+    tiltAxis_y(0.0),
+    tiltAxis_z(0.0) {
+  rebuildFrame();
 }
 
 void CalibrationManager::begin() {
@@ -23,179 +32,318 @@ void CalibrationManager::begin() {
 }
 
 void CalibrationManager::loadFromEEPROM() {
-  // Read calibration flag
-  byte flag;
-  EEPROM.get(ADDR_CALIBRATED_FLAG, flag);
-
-  if (flag == 0xAA) {
-    // Valid calibration exists
-    EEPROM.get(ADDR_ZERO_OFFSET, zeroOffset);
-    EEPROM.get(ADDR_STOP_A_RAW, stopA_raw);
-    EEPROM.get(ADDR_STOP_B_RAW, stopB_raw);
-    EEPROM.get(ADDR_TUBE_AXIS_X, tubeAxis_x);
-    EEPROM.get(ADDR_TUBE_AXIS_Y, tubeAxis_y);
-    EEPROM.get(ADDR_TUBE_AXIS_Z, tubeAxis_z);
-    calibrated = true;
-
-    Serial.println("Calibration loaded:");
-    Serial.print("  Zero offset: "); Serial.println(zeroOffset);
-    Serial.print("  Stop A raw: "); Serial.println(stopA_raw);
-    Serial.print("  Stop B raw: "); Serial.println(stopB_raw);
-    Serial.print("  Tube axis: (");
-    Serial.print(tubeAxis_x, 3); Serial.print(", ");
-    Serial.print(tubeAxis_y, 3); Serial.print(", ");
-    Serial.print(tubeAxis_z, 3); Serial.println(")");
+  CalibrationRecord record;
+  uint8_t version = 0;
+  uint8_t length = 0;
+
+  bool found = journal.load(&record, sizeof(record), version, length) &&
+               ((version == CALIBRATION_RECORD_VERSION && length == sizeof(record)) ||
+                (version == 1 && length == CALIBRATION_RECORD_V1_SIZE));
+  if (found && version == 1) {
+    // Written before the azimuth encoder: always an altitude calibration
+    record.flags = CALIBRATION_FLAG_ALTITUDE;
+    record.azimuth.ticksPerRev = AZIMUTH_DEFAULT_TICKS_PER_REV;
+  }
+
+  if (journal.getCorruptSlots() > 0) {
+    console.print("WARNING: skipped ");
+    console.print(journal.getCorruptSlots());
+    console.println(" corrupt calibration record(s)");
+  }
+
+  if (found) {
+    applyRecord(record);
+  } else if (EEPROM.read(ADDR_CALIBRATED_FLAG) == LEGACY_CALIBRATED_FLAG) {
+    migrateLegacyLayout();
   } else {
-    Serial.println("No calibration found in EEPROM");
+    console.println("No calibration found in EEPROM");
     calibrated = false;
+    return;
+  }
+
+  rebuildFrame();
+  if (azimuth.ticksPerRev != 0) {
+    console.print("Azimuth encoder: ");
+    console.print(azimuth.ticksPerRev);
+    console.println(" ticks/rev");
   }
+
+  calibrated = !found || (record.flags & CALIBRATION_FLAG_ALTITUDE);
+  if (!calibrated) {
+    console.println("No altitude calibration in EEPROM");
+    return;
+  }
+
+  console.println("Calibration loaded:");
+  console.print("  Zero offset: "); console.println(zeroOffset);
+  console.print("  Stop A raw: "); console.println(stopA_raw);
+  console.print("  Stop B raw: "); console.println(stopB_raw);
+  console.print("  Tube axis: (");
+  console.print(tubeAxis_x, 3); console.print(", ");
+  console.print(tubeAxis_y, 3); console.print(", ");
+  console.print(tubeAxis_z, 3); console.println(")");
+  console.print("  Tilt axis: (");
+  console.print(tiltAxis_x, 3); console.print(", ");
+  console.print(tiltAxis_y, 3); console.print(", ");
+  console.print(tiltAxis_z, 3); console.println(")");
 }
 
-void CalibrationManager::saveToEEPROM() {
-  EEPROM.put(ADDR_ZERO_OFFSET, zeroOffset);
-  EEPROM.put(ADDR_STOP_A_RAW, stopA_raw);
-  EEPROM.put(ADDR_STOP_B_RAW, stopB_raw);
-  EEPROM.put(ADDR_TUBE_AXIS_X, tubeAxis_x);
-  EEPROM.put(ADDR_TUBE_AXIS_Y, tubeAxis_y);
-  EEPROM.put(ADDR_TUBE_AXIS_Z, tubeAxis_z);
-  byte flag = 0xAA;
-  EEPROM.put(ADDR_CALIBRATED_FLAG, flag);
-  EEPROM.commit();
+void CalibrationManager::migrateLegacyLayout() {
+  EEPROM.get(ADDR_ZERO_OFFSET, zeroOffset);
+  EEPROM.get(ADDR_STOP_A_RAW, stopA_raw);
+  EEPROM.get(ADDR_STOP_B_RAW, stopB_raw);
+  EEPROM.get(ADDR_TUBE_AXIS_X, tubeAxis_x);
+  EEPROM.get(ADDR_TUBE_AXIS_Y, tubeAxis_y);
+  EEPROM.get(ADDR_TUBE_AXIS_Z, tubeAxis_z);
+  EEPROM.get(ADDR_TILT_AXIS_X, tiltAxis_x);
+  EEPROM.get(ADDR_TILT_AXIS_Y, tiltAxis_y);
+  EEPROM.get(ADDR_TILT_AXIS_Z, tiltAxis_z);
+
+  // Move it into the journal and retire the old flag (flushed at the next idle point)
+  calibrated = true;
+  appendRecord();
+  EEPROM.write(ADDR_CALIBRATED_FLAG, 0x00);
+
+  console.println("Migrated legacy calibration to the journal");
+}
 
+void CalibrationManager::fillRecord(CalibrationRecord& record) const {
+  record.zeroOffset = zeroOffset;
+  record.stopA_raw = stopA_raw;
+  record.stopB_raw = stopB_raw;
+  record.tubeAxis[0] = tubeAxis_x;
+  record.tubeAxis[1] = tubeAxis_y;
+  record.tubeAxis[2] = tubeAxis_z;
+  record.tiltAxis[0] = tiltAxis_x;
+  record.tiltAxis[1] = tiltAxis_y;
+  record.tiltAxis[2] = tiltAxis_z;
+  record.flags = calibrated ? CALIBRATION_FLAG_ALTITUDE : 0;
+  record.azimuth = azimuth;
+}
+
+void CalibrationManager::applyRecord(const CalibrationRecord& record) {
+  zeroOffset = record.zeroOffset;
+  stopA_raw = record.stopA_raw;
+  stopB_raw = record.stopB_raw;
+  tubeAxis_x = record.tubeAxis[0];
+  tubeAxis_y = record.tubeAxis[1];
+  tubeAxis_z = record.tubeAxis[2];
+  tiltAxis_x = record.tiltAxis[0];
+  tiltAxis_y = record.tiltAxis[1];
+  tiltAxis_z = record.tiltAxis[2];
+  azimuth = record.azimuth;
+}
+
+void CalibrationManager::restoreRecord(const CalibrationRecord& record) {
+  applyRecord(record);
+  rebuildFrame();
+  calibrated = (record.flags & CALIBRATION_FLAG_ALTITUDE) != 0;
+}
+
+void CalibrationManager::appendRecord() {
+  CalibrationRecord record;
+  fillRecord(record);
+  journal.append(&record, sizeof(record), CALIBRATION_RECORD_VERSION);
+}
+
+void CalibrationManager::saveToEEPROM() {
   calibrated = true;
+  appendRecord();
+
+  // The flash write (~30 ms) happens later, from the scheduler's idle hook
+  console.println("Calibration saved (commit pending)");
+}
 
-  Serial.println("Calibration saved to EEPROM");
+void CalibrationManager::saveAzimuthCalibration(const AzimuthCalibration& calibration) {
+  azimuth = calibration;
+  appendRecord();
+  console.println("Azimuth calibration saved (commit pending)");
+}
+
+void CalibrationManager::commitPending() {
+  if (!journal.hasPendingCommit()) {
+    return;
+  }
+
+  if (journal.commit()) {
+    console.println("Calibration committed to flash");
+  } else {
+    console.println("ERROR: calibration commit failed");
+  }
 }
 
 void CalibrationManager::calibrateZero() {
-  // Read averaged gravity when telescope is level
-  sensor.readAveragedGravity(tubeAxis_x, tubeAxis_y, tubeAxis_z, NUM_CALIBRATION_READINGS);
+  // Read averaged gravity when telescope is level (the angle in the old
+  // frame only serves to tell when the capture has converged)
+  float gravity[3];
+  captureAngle(gravity);
+  tubeAxis_x = gravity[0];
+  tubeAxis_y = gravity[1];
+  tubeAxis_z = gravity[2];
 
   // For now, zero offset is 0 (we'll refine this after Stop A and B calibration)
   zeroOffset = 0.0;
 
-  Serial.print("Zero reference gravity: (");
-  Serial.print(tubeAxis_x, 3); Serial.print(", ");
-  Serial.print(tubeAxis_y, 3); Serial.print(", ");
-  Serial.print(tubeAxis_z, 3); Serial.println(")");
+  // Tilt axis is unknown until Stop A; use the provisional guess meanwhile
+  tiltAxis_x = 0.0;
+  tiltAxis_y = 0.0;
+  tiltAxis_z = 0.0;
+  rebuildFrame();
+
+  console.print("Zero reference gravity: (");
+  console.print(tubeAxis_x, 3); console.print(", ");
+  console.print(tubeAxis_y, 3); console.print(", ");
+  console.print(tubeAxis_z, 3); console.println(")");
+  printCapture("Zero capture");
 }
 
 void CalibrationManager::calibrateStopA() {
-  float sum_angle = 0.0;
-
-  for (int i = 0; i < NUM_CALIBRATION_READINGS; i++) {
-    float ax, ay, az;
-    sensor.readAveragedGravity(ax, ay, az, 1);  // Single reading
-    float angle = calculateAngle(ax, ay, az);
-    sum_angle += angle;
-    delay(20);
+  float gravity[3];
+  captureAngle(gravity);
+
+  // Level and Stop A gravity span the tilt plane. The axis is oriented so
+  // Stop A reads positive for now; Stop B settles the sign.
+  float level[3] = {tubeAxis_x, tubeAxis_y, tubeAxis_z};
+  float axis[3];
+  if (measureTiltAxis(level, gravity, axis)) {
+    tiltAxis_x = axis[0];
+    tiltAxis_y = axis[1];
+    tiltAxis_z = axis[2];
+    rebuildFrame();
+  } else {
+    console.println("Stop A too close to level - keeping provisional tilt axis");
   }
 
-  stopA_raw = sum_angle / NUM_CALIBRATION_READINGS;
-  Serial.print("Stop A calibrated: "); Serial.println(stopA_raw);
+  RawSample mean;
+  TelescopeSensor::gravityToSample(gravity[0], gravity[1], gravity[2], mean);
+  stopA_raw = calculateAngle(mean);
+  printCapture("Stop A calibrated");
 }
 
 void CalibrationManager::calibrateStopB() {
-  float sum_angle = 0.0;
-
-  for (int i = 0; i < NUM_CALIBRATION_READINGS; i++) {
-    float ax, ay, az;
-    sensor.readAveragedGravity(ax, ay, az, 1);  // Single reading
-    float angle = calculateAngle(ax, ay, az);
-    sum_angle += angle;
-    delay(20);
+  stopB_raw = captureAngle();
+  printCapture("Stop B calibrated");
+
+  // Stop B is the higher stop. Reading below Stop A means Stop A was taken
+  // on the other side of level (the tube pushed the wrong way), so the
+  // axis points backwards: flip it, which negates every angle.
+  if (stopB_raw < stopA_raw) {
+    tiltAxis_x = -tiltAxis_x;
+    tiltAxis_y = -tiltAxis_y;
+    tiltAxis_z = -tiltAxis_z;
+    rebuildFrame();
+    stopA_raw = -stopA_raw;
+    stopB_raw = -stopB_raw;
+    console.println("Stop B below Stop A - tilt axis reversed");
   }
-
-  stopB_raw = sum_angle / NUM_CALIBRATION_READINGS;
-  Serial.print("Stop B calibrated: "); Serial.println(stopB_raw);
 }
 
 void CalibrationManager::syncAtStopA() {
-  float sum_angle = 0.0;
-
-  for (int i = 0; i < NUM_CALIBRATION_READINGS; i++) {
-    float ax, ay, az;
-    sensor.readAveragedGravity(ax, ay, az, 1);  // Single reading
-    float angle = calculateAngle(ax, ay, az);
-    sum_angle += angle;
-    delay(20);
-  }
-
-  stopA_raw = sum_angle / NUM_CALIBRATION_READINGS;
-  Serial.print("Stop A synced: "); Serial.println(stopA_raw);
+  stopA_raw = captureAngle();
+  printCapture("Stop A synced");
 }
 
 void CalibrationManager::syncAtStopB() {
-  float sum_angle = 0.0;
-
-  for (int i = 0; i < NUM_CALIBRATION_READINGS; i++) {
-    float ax, ay, az;
-    sensor.readAveragedGravity(ax, ay, az, 1);  // Single reading
-    float angle = calculateAngle(ax, ay, az);
-    sum_angle += angle;
-    delay(20);
-  }
-
-  stopB_raw = sum_angle / NUM_CALIBRATION_READINGS;
-  Serial.print("Stop B synced: "); Serial.println(stopB_raw);
+  stopB_raw = captureAngle();
+  printCapture("Stop B synced");
 
   // Save updated calibration
   saveToEEPROM();
 }
 
-float CalibrationManager::calculateAngle(float ax, float ay, float az) {
-  // Calculate angle using same method as sensor
-  float gravityMag = sqrt(ax*ax + ay*ay + az*az);
-  float refGravityMag = sqrt(tubeAxis_x*tubeAxis_x + tubeAxis_y*tubeAxis_y + tubeAxis_z*tubeAxis_z);
-
-  if (gravityMag > 0.1 && refGravityMag > 0.1) {
-    float norm_ax = ax / gravityMag;
-    float norm_ay = ay / gravityMag;
-    float norm_az = az / gravityMag;
-
-    float norm_ref_x = tubeAxis_x / refGravityMag;
-    float norm_ref_y = tubeAxis_y / refGravityMag;
-    float norm_ref_z = tubeAxis_z / refGravityMag;
+float CalibrationManager::captureAngle(float* gravity) {
+  RawSample batch[FIFO_BURST_SAMPLES];
+  AngleEstimator estimator;
+  float sum[3] = {0.0, 0.0, 0.0};
 
-    float dotProduct = norm_ax * norm_ref_x + norm_ay * norm_ref_y + norm_az * norm_ref_z;
-    dotProduct = constrain(dotProduct, -1.0, 1.0);
+  // Consume FIFO batches as fast as the sensor produces them
+  sensor.beginCapture();
 
-    float angleBetweenVectors = acos(dotProduct) * (180.0 / PI);
+  while (!estimator.isFinished()) {
+    int n = sensor.waitForSamples(batch, FIFO_BURST_SAMPLES);
+    if (n == 0) {
+      break;  // Sensor stopped delivering samples
+    }
 
-    float cross_z = (norm_ref_x * norm_ay - norm_ref_y * norm_ax);
+    for (int i = 0; i < n && !estimator.isFinished(); i++) {
+      if (estimator.add(calculateAngle(batch[i]))) {
+        float g[3];
+        TelescopeSensor::sampleToGravity(batch[i], g[0], g[1], g[2]);
+        sum[0] += g[0];
+        sum[1] += g[1];
+        sum[2] += g[2];
+      }
+    }
+  }
 
-    if (cross_z < 0) {
-      return angleBetweenVectors;
+  lastCapture.angle = estimator.getMean();
+  lastCapture.standardError = estimator.getStandardError();
+  lastCapture.stdDev = estimator.getStdDev();
+  lastCapture.samples = estimator.getAccepted();
+  lastCapture.rejected = estimator.getRejected();
+  lastCapture.converged = estimator.isConverged();
+
+  if (gravity) {
+    uint16_t n = estimator.getAccepted();
+    if (n == 0) {
+      // FIFO unavailable - fall back to a direct read
+      sensor.readAveragedGravity(gravity[0], gravity[1], gravity[2], 1);
     } else {
-      return -angleBetweenVectors;
+      for (int axis = 0; axis < 3; axis++) {
+        gravity[axis] = sum[axis] / n;
+      }
     }
   }
 
-  return 0.0;
+  return lastCapture.angle;
 }
 
-float CalibrationManager::applyCalibratedOffset(float rawAngle) const {
-  if (!calibrated) {
-    return rawAngle;
-  }
+void CalibrationManager::printCapture(const char* label) const {
+  console.print(label);
+  console.print(": ");
+  console.print(lastCapture.angle, 3);
+  console.print(" +/- ");
+  console.print(lastCapture.standardError, 4);
+  console.print(" deg (");
+  console.print(lastCapture.samples);
+  console.print(" samples, noise ");
+  console.print(lastCapture.stdDev, 3);
+  console.print(" deg, ");
+  console.print(lastCapture.rejected);
+  console.println(lastCapture.converged ? " rejected)" : " rejected) - did not converge, vibration?");
+}
 
-  // Apply zero offset first
-  float corrected = rawAngle - zeroOffset;
+void CalibrationManager::rebuildFrame() {
+  float level[3] = {tubeAxis_x, tubeAxis_y, tubeAxis_z};
+  float axis[3] = {tiltAxis_x, tiltAxis_y, tiltAxis_z};
 
-  // Apply two-point linear calibration
-  float range = stopB_raw - stopA_raw;
+  if (buildReferenceFrame(frame, level, axis)) {
+    return;
+  }
 
-  if (abs(range) > 0.1) {  // Avoid division by zero
-    // Use the stops as reference points
-    // The actual altitude difference between stops
-    float stopDiff = (stopB_raw - zeroOffset) - (stopA_raw - zeroOffset);
+  // No usable tilt axis (not measured yet, or older calibration data)
+  provisionalTiltAxis(level, axis);
+  if (!buildReferenceFrame(frame, level, axis)) {
+    // Level vector unusable too - fall back to the Y-axis default
+    const float defaultLevel[3] = {0.0, 1.0, 0.0};
+    provisionalTiltAxis(defaultLevel, axis);
+    buildReferenceFrame(frame, defaultLevel, axis);
+  }
+}
 
-    // Scale factor (should be close to 1.0 if sensor is well-aligned)
-    float scale = stopDiff / range;
+float CalibrationManager::calculateAngle(const RawSample& sample) {
+  // Calculate angle using same kernel as sensor
+  return TelescopeSensor::sampleAngle(sample, frame);
+}
 
-    return corrected;
-  } else {
-    // Fallback to zero-point calibration only
-    return corrected;
+float CalibrationManager::applyCalibratedOffset(float rawAngle) const {
+  if (!calibrated) {
+    return rawAngle;
   }
+
+  // The stops fix the tilt axis and its sign (calibrateStopA/B), so the
+  // frame already measures true degrees: a two-point scale from them would
+  // be (stopB - zero - (stopA - zero)) / (stopB - stopA), always 1. Only the
+  // zero offset applies.
+  return rawAngle - zeroOffset;
 }
@@ -7,6 +7,39 @@
 #define CALIBRATION_H
 
 #include "sensor.h"
+#include "journal.h"
+#include "azimuth.h"
+
+// Layout of the journal payload; bump the version when it changes.
+// Version 1 records (no flags or azimuth) still load.
+#define CALIBRATION_RECORD_VERSION 2
+
+// CalibrationRecord::flags
+#define CALIBRATION_FLAG_ALTITUDE 0x01  // Zero and stops measured
+
+// Outcome of the last calibration capture
+struct CaptureResult {
+  float angle;          // Mean angle (degrees)
+  float standardError;  // Uncertainty of the mean (degrees)
+  float stdDev;         // Per-sample noise (degrees)
+  uint16_t samples;     // Accepted samples
+  uint16_t rejected;    // Outliers dropped
+  bool converged;       // False when CAPTURE_MAX_SAMPLES ran out first
+};
+
+struct CalibrationRecord {
+  float zeroOffset;
+  float stopA_raw;
+  float stopB_raw;
+  float tubeAxis[3];
+  float tiltAxis[3];
+  // Version 2
+  uint32_t flags;
+  AzimuthCalibration azimuth;
+};
+
+// Payload of a version 1 record
+#define CALIBRATION_RECORD_V1_SIZE offsetof(CalibrationRecord, flags)
 
 class CalibrationManager {
 public:
@@ -15,10 +48,15 @@ public:
   // Initialization
   void begin();
 
-  // Load/Save calibration from/to EEPROM
+  // Load/Save calibration from/to the EEPROM journal. Saving only updates
+  // the RAM image; commitPending() writes it to flash.
   void loadFromEEPROM();
   void saveToEEPROM();
 
+  // Flush a saved calibration to flash (call from an idle point)
+  void commitPending();
+  bool hasPendingCommit() const { return journal.hasPendingCommit(); }
+
   // Calibration procedures
   void calibrateZero();
   void calibrateStopA();
@@ -28,6 +66,10 @@ public:
   void syncAtStopA();
   void syncAtStopB();
 
+  // Azimuth encoder scale, saved in the same record (commit pending)
+  const AzimuthCalibration& getAzimuthCalibration() const { return azimuth; }
+  void saveAzimuthCalibration(const AzimuthCalibration& calibration);
+
   // Get calibration data
   bool isCalibrated() const { return calibrated; }
   float getZeroOffset() const { return zeroOffset; }
@@ -38,26 +80,64 @@ public:
     y = tubeAxis_y;
     z = tubeAxis_z;
   }
+  const ReferenceFrame& getReferenceFrame() const { return frame; }
+  const CaptureResult& getLastCapture() const { return lastCapture; }
 
   // Apply calibration to raw angle
   float applyCalibratedOffset(float rawAngle) const;
 
+  // The whole calibration as one record (the flash trace carries it, and
+  // host/flash_replay restores it). Restoring rebuilds the reference frame
+  // but saves nothing.
+  void getRecord(CalibrationRecord& record) const { fillRecord(record); }
+  void restoreRecord(const CalibrationRecord& record);
+
 private:
   TelescopeSensor& sensor;
+  CalibrationJournal journal;
 
   // Calibration data
   float zeroOffset;
   float stopA_raw;
   float stopB_raw;
   bool calibrated;
+  AzimuthCalibration azimuth;
 
   // Reference tube axis (gravity vector in sensor coordinates when telescope is level)
   float tubeAxis_x;
   float tubeAxis_y;
   float tubeAxis_z;
 
-  // Helper to calculate angle using reference gravity
-  float calculateAngle(float ax, float ay, float az);
+  // Tilt (altitude bearing) axis in sensor coordinates, measured at Stop A
+  float tiltAxis_x;
+  float tiltAxis_y;
+  float tiltAxis_z;
+
+  // Basis derived from the two vectors above; rebuilt only when they change
+  ReferenceFrame frame;
+
+  CaptureResult lastCapture;
+
+  // Journal record <-> members
+  void fillRecord(CalibrationRecord& record) const;
+  void applyRecord(const CalibrationRecord& record);
+  void appendRecord();
+
+  // Import the pre-journal fixed-address layout
+  void migrateLegacyLayout();
+
+  // Rebuild the reference frame (falls back to the provisional tilt axis)
+  void rebuildFrame();
+
+  // Helper to calculate angle using the reference frame
+  float calculateAngle(const RawSample& sample);
+
+  // Capture until the mean angle converges (see estimator.h) and return it;
+  // with gravity, also the mean gravity (g) of the accepted samples
+  float captureAngle(float* gravity = nullptr);
+
+  // Serial line for lastCapture
+  void printCapture(const char* label) const;
 };
 
 #endif // CALIBRATION_H
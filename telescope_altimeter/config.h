@@ -1,5 +1,10 @@
 /*
  * Configuration constants for Telescope Altimeter v2.1
+ *
+ * The pipeline choices (sensor ranges, OVERSAMPLING, ANGLE_KERNEL,
+ * ALTITUDE_FILTER, DISPLAY_BUFFER, DISPLAY_SPRITES) can also be set from the
+ * build with -D, as the presets in host/CMakeLists.txt do. pipeline.h turns
+ * them into policy types and rejects combinations that cannot work.
  */
 
 #ifndef CONFIG_H
@@ -11,27 +16,209 @@
 #define BUTTON_PIN D3      // GPIO0 - built-in button on NodeMCU
 #define I2C_SDA D2         // GPIO4
 #define I2C_SCL D1         // GPIO5
+#define MPU_INT_PIN D5     // GPIO14 - MPU6050 INT (data ready)
+#define AZIMUTH_PIN_A D6   // GPIO12 - azimuth encoder phase A
+#define AZIMUTH_PIN_B D7   // GPIO13 - azimuth encoder phase B
+
+// MPU6050 full-scale ranges; the LSB/g and LSB/(deg/s) scale factors
+// follow from them at compile time (pipeline.h). +-8 g is the coarsest
+// range whose counts still resolve the display's 1 arcminute.
+#ifndef ACCEL_RANGE
+#define ACCEL_RANGE MPU6050_ACCEL_FS_2     // 16384 LSB/g
+#endif
+#ifndef GYRO_RANGE
+#define GYRO_RANGE MPU6050_GYRO_FS_250     // 131 LSB/(deg/s)
+#endif
 
 // Display zones (color-aware positioning)
 #define YELLOW_ZONE_END 10   // Rows 0-10 are yellow (11 pixels high)
 #define BLUE_ZONE_START 13   // Rows 13-64 are blue (row 11-12 is gap)
 
+// Display frame buffer: DISPLAY_BUFFER_FULL (1 KB of DRAM, screen drawn once
+// per frame), DISPLAY_BUFFER_TWO_PAGE (256 B) or DISPLAY_BUFFER_ONE_PAGE
+// (128 B) - the page modes redraw the screen once per page sent
+#ifndef DISPLAY_BUFFER
+#define DISPLAY_BUFFER DISPLAY_BUFFER_FULL
+#endif
+
+// Render the main screen's glyphs once at boot (sprites.h) and blit them
+// instead of decoding fonts every frame; costs about 1 KB of DRAM
+#ifndef DISPLAY_SPRITES
+#define DISPLAY_SPRITES 1
+#endif
+
+// Unchanged pages are skipped by hash; every DISPLAY_REFRESH_FRAMES frames
+// one page (in turn) is sent anyway, so a hash collision cannot leave a
+// stale row for more than DISPLAY_REFRESH_FRAMES frames per page (3.2 s
+// with the full buffer's 8 pages at 10 Hz)
+#define DISPLAY_REFRESH_FRAMES 4
+
 // ==================== ALGORITHM CONFIGURATION ====================
 
+// Angle kernel: ANGLE_KERNEL_FLOAT (software float acos) or
+// ANGLE_KERNEL_CORDIC (integer, works on raw counts - faster on the FPU-less ESP8266)
+#ifndef ANGLE_KERNEL
+#define ANGLE_KERNEL ANGLE_KERNEL_CORDIC
+#endif
+
 // Filter settings
+// FILTER_EMA (accelerometer only, fixed ALPHA), FILTER_COMPLEMENTARY (gyro-fused)
+// or FILTER_ONE_EURO (smoothing cutoff rises with slew speed)
+#ifndef ALTITUDE_FILTER
+#define ALTITUDE_FILTER FILTER_COMPLEMENTARY
+#endif
+#define FILTER_WARMUP_BATCHES 3       // Readings averaged before smoothing starts
 #define ALPHA 0.2  // Exponential moving average factor (0-1, lower = smoother)
+#define COMPLEMENTARY_TAU 1.0         // Seconds for the accelerometer to correct gyro drift
+#define GYRO_REST_THRESHOLD_DPS 1.0   // Below this (gyro and accel) the tube counts as still
+#define GYRO_BIAS_TAU 5.0             // Seconds: gyro bias estimate time constant at rest
+#define ONE_EURO_MIN_CUTOFF_HZ 0.2    // Cutoff at rest (lower = steadier reading)
+#define ONE_EURO_BETA 0.5             // Cutoff increase (Hz) per deg/s of slew (higher = less lag)
+#define ONE_EURO_DCUTOFF_HZ 1.0       // Cutoff for the slew-speed estimate
 
 // Button settings
 #define DEBOUNCE_DELAY 50
 #define LONG_PRESS_TIME 2000
+#define DOUBLE_PRESS_MS 400          // Second press within this of a short press
+#define BUTTON_EVENT_QUEUE_SIZE 16   // Power of two
+
+// Oversampling front end: with OVERSAMPLING the MPU6050 runs at 1 kHz with a
+// wide DLPF (so successive samples carry independent noise) and a CIC filter
+// decimates by DECIMATION_RATIO before the angle math. Without it the sensor
+// runs at 200 Hz behind a 20 Hz DLPF. The output rate is 200 Hz either way.
+#ifndef OVERSAMPLING
+#define OVERSAMPLING 0
+#endif
+#if OVERSAMPLING
+#define FIFO_SAMPLE_RATE_HZ 1000     // MPU6050 sample rate while capturing through the FIFO
+#define DECIMATION_RATIO 5           // Input samples per decimated sample
+#define CIC_ORDER 2                  // 1 = boxcar; 2 adds alias rejection
+#define MPU_DLPF_MODE MPU6050_DLPF_BW_188
+#else
+#define FIFO_SAMPLE_RATE_HZ 200
+#define DECIMATION_RATIO 1
+#define CIC_ORDER 1
+#define MPU_DLPF_MODE MPU6050_DLPF_BW_20
+#endif
+
+// Calibration captures (estimator.h): sample until the standard error of the
+// mean angle falls below CAPTURE_TARGET_SE_DEG; vibration keeps them going
+// longer, up to CAPTURE_MAX_SAMPLES. Counts are FIFO samples.
+#define CAPTURE_TARGET_SE_DEG 0.02                     // ~1 arcminute, the display resolution
+#define CAPTURE_MIN_SAMPLES (48 * DECIMATION_RATIO)   // At least 240 ms
+#define CAPTURE_MAX_CORRELATION 0.95                   // Cap on the lag-1 correlation correction
+#define CAPTURE_MAX_SAMPLES (1000 * DECIMATION_RATIO)  // Give up after 5 s
+#define CAPTURE_OUTLIER_SIGMA 4.0                      // Reject samples this many sigma off the mean
+#define CAPTURE_OUTLIER_FLOOR_DEG 0.05                 // ...but never within this of it
+
+// FIFO acquisition settings
+#define FIFO_BURST_SAMPLES 10        // Samples per I2C burst (10 x 12 bytes fits the Wire buffer)
+#define FIFO_TIMEOUT_MS 100          // Give up if the FIFO stays empty this long
+#define DATA_READY_QUEUE_SIZE 64     // Data-ready timestamps buffered between drains (power of two)
+
+// ==================== SCHEDULER CONFIGURATION ====================
+
+// Task periods (deadline = period unless noted)
+#define SENSOR_TASK_PERIOD_MS 20     // Drain the FIFO (4 output samples per run at 200 Hz)
+#define BUS_SLOT_MS (5 * DISPLAY_PAGE_ROWS)  // I2C bus slot (bus.h); one tile row takes ~3 ms at 400 kHz
+#define BUTTON_TASK_PERIOD_MS 10
+#define FILTER_TASK_PERIOD_MS 100    // ALPHA is tuned for this rate
+#define DISPLAY_TASK_PERIOD_MS 100   // 10 Hz refresh rate
+#define STATS_TASK_PERIOD_MS 30000   // Print task overrun counts
+#define SERIAL_TASK_PERIOD_MS 50     // Poll for serial commands (also polled when idle)
+#define SERIAL_COMMAND_LENGTH 32     // Longest command line accepted
+
+// I2C slot plan: the sensor drain owns the first slot of every sensor period,
+// the remaining slots each carry one display page (3 pages per 20 ms cycle,
+// 1 with the two-page buffer)
+#define BUS_SLOTS_PER_CYCLE (SENSOR_TASK_PERIOD_MS / BUS_SLOT_MS)
+
+// Message overlay durations
+#define MESSAGE_SHORT_MS 1000
+#define MESSAGE_MS 1500
+#define MESSAGE_LONG_MS 2000
+
+// ==================== LX200 CONFIGURATION ====================
 
-// Calibration settings
-#define NUM_CALIBRATION_READINGS 50  // Number of samples to average during calibration
+// Planetarium programs poll altitude over Serial with LX200 commands
+// (lx200.h). While they do, the periodic stats and power messages are not
+// printed, so no unsolicited text lands between replies.
+#define LX200_HIGH_PRECISION 1           // Start in "sDD*MM'SS#" format (:U# toggles)
+#define LX200_ACTIVE_MS 5000             // A client counts as connected this long after a command
+
+// ==================== AZIMUTH CONFIGURATION ====================
+
+// Quadrature encoder on the azimuth bearing (azimuth.h), counted on every
+// edge of both phases. The pins are pulled up, so 1 is harmless without an
+// encoder fitted; 0 leaves them alone.
+#define AZIMUTH_ENCODER 1
+#define AZIMUTH_DEFAULT_TICKS_PER_REV 0  // 0: uncalibrated until "az rev" or "az cpr"
+#define AZIMUTH_MIN_TICKS_PER_REV 100    // "az rev" rejects a turn with fewer ticks
+
+// ==================== TRACE RECORDER CONFIGURATION ====================
+
+// Black-box trace on LittleFS (recorder.h): every sample the sketch reads,
+// filter outputs, mode changes and button events. Needs a board setting
+// with a file system (e.g. "4MB (FS:2MB OTA:~1019KB)").
+#define TRACE_AT_BOOT 0                  // 1 records from boot; 0 only after "rec on"
+#define TRACE_BLOCK_SIZE 512             // Bytes per staged and written block
+#define TRACE_STAGING_BLOCKS 2           // RAM blocks (one fills while one waits for flash)
+#define TRACE_SEGMENTS 8                 // Files in the ring
+#define TRACE_SEGMENT_BLOCKS 256         // Blocks per file: 128 KB, 1 MB in all
+
+// ==================== POWER CONFIGURATION ====================
+
+// Motion-aware refresh (power.h): the display refreshes every
+// DISPLAY_TASK_PERIOD_MS while the tube moves and every
+// DISPLAY_STILL_PERIOD_MS at rest. After POWER_IDLE_TIMEOUT_MS at rest on
+// the main screen the MPU6050 drops to accelerometer-only cycle mode and the
+// ESP8266 light-sleeps between its samples; the display holds the last
+// reading until the motion interrupt, drift or the button wakes it. Idle
+// needs INT wired to MPU_INT_PIN; without data-ready interrupts it stays
+// in STILL.
+#define POWER_SAVING 1                   // 0 never idles (also the "power off" command)
+#define MOTION_RATE_THRESHOLD_DPS 0.3    // Tilt rate (bias removed) that counts as moving
+#define MOTION_ANGLE_THRESHOLD_DEG 0.2   // Drift from the rest position that counts as moving
+#define MOTION_HOLD_MS 1000              // No motion for this long before refreshing slowly
+#define DISPLAY_STILL_PERIOD_MS 1000     // 1 Hz refresh at rest
+#define POWER_IDLE_TIMEOUT_MS 10000      // At rest this long before idling
+
+// Idle: MPU6050 cycle rate, its motion interrupt threshold (2 mg/LSB,
+// compared between consecutive cycle samples) and the samples averaged per
+// drift check against the rest position
+#define POWER_IDLE_WAKE_FREQ MPU6050_WAKE_FREQ_5
+#define MOTION_WAKE_THRESHOLD 15
+#define POWER_IDLE_BLOCK_SAMPLES 16      // 3.2 s at 5 Hz
+#define POWER_WAKE_ANGLE_DEG 1.0         // One sample this far from rest wakes at once
+#define POWER_IDLE_SETTLE_SAMPLES 1      // Motion interrupts ignored while the detector settles
+#define POWER_SLEEP_ENTRY_MS 10          // delay() the SDK enters light sleep from
+
+// Typical currents (mA, datasheets) for the savings estimate; the OLED is
+// not included
+#define POWER_ESP_AWAKE_MA 15.0          // ESP8266 CPU running, radio off
+#define POWER_ESP_LIGHT_SLEEP_MA 0.9
+#define POWER_MPU_ACTIVE_MA 3.8          // Accelerometer + gyros
+#define POWER_MPU_CYCLE_MA 0.02          // Accelerometer-only cycle at 5 Hz
+
+// ==================== BENCHMARK CONFIGURATION ====================
+
+// Per-stage latency histograms (profiler.h), dumped with the "prof" serial command
+#define PROFILING 1
+
+// Print the hot-path benchmark table (bench.h) over Serial once at boot
+#define BENCHMARK_AT_BOOT 0
+#define BENCHMARK_ITERATIONS 2000    // Calls per stage on the device
 
 // ==================== EEPROM CONFIGURATION ====================
 
-// EEPROM addresses
 #define EEPROM_SIZE 512
+
+// Calibration journal (journal.h): CRC-checked records in round-robin slots
+#define JOURNAL_BASE_ADDR 64
+#define JOURNAL_SLOT_SIZE 64
+#define JOURNAL_SLOTS 7
+
+// Legacy fixed layout (v2.1 and earlier) - only read to migrate into the journal
 #define ADDR_ZERO_OFFSET 0
 #define ADDR_STOP_A_RAW 4
 #define ADDR_STOP_B_RAW 8
@@ -39,6 +226,10 @@
 #define ADDR_TUBE_AXIS_X 16
 #define ADDR_TUBE_AXIS_Y 20
 #define ADDR_TUBE_AXIS_Z 24
+#define ADDR_TILT_AXIS_X 28
+#define ADDR_TILT_AXIS_Y 32
+#define ADDR_TILT_AXIS_Z 36
+#define LEGACY_CALIBRATED_FLAG 0xAA
 
 // ==================== VERSION ====================
 
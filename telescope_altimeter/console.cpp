@@ -0,0 +1,33 @@
+/*
+ * Text console implementation for Telescope Altimeter
+ */
+
+#include "console.h"
+
+Console console(Serial);
+
+Console::Console(Print& port)
+  : port(port),
+    hold(nullptr),
+    held(0) {
+}
+
+void Console::setHold(bool (*hold)()) {
+  this->hold = hold;
+}
+
+size_t Console::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t Console::write(const uint8_t* buffer, size_t size) {
+  if (hold && hold()) {
+    held += size;
+    return size;  // Reported as written, so print() callers carry on
+  }
+  return port.write(buffer, size);
+}
+
+int Console::availableForWrite() {
+  return port.availableForWrite();
+}
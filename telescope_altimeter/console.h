@@ -0,0 +1,37 @@
+/*
+ * Text console for Telescope Altimeter
+ * Every human-readable message goes through 'console' instead of Serial.
+ * Serial is shared with LX200 clients, which read it as a stream of '#'
+ * replies; while the hold test says a client is polling, text is dropped
+ * (and counted) so that nothing lands between two replies.
+ */
+
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <Arduino.h>
+
+class Console : public Print {
+public:
+  Console(Print& port);
+
+  // Text is dropped while hold() returns true (no test: never)
+  void setHold(bool (*hold)());
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  int availableForWrite() override;
+  using Print::write;
+
+  // Bytes dropped while held
+  unsigned long getHeld() const { return held; }
+
+private:
+  Print& port;
+  bool (*hold)();
+  unsigned long held;
+};
+
+extern Console console;
+
+#endif // CONSOLE_H
@@ -0,0 +1,75 @@
+/*
+ * CIC decimator implementation for Telescope Altimeter
+ */
+
+#include "decimator.h"
+
+// DC gain R^N of an N-stage CIC with differential delay 1
+static constexpr int32_t cicGain(int order) {
+  return order == 0 ? 1 : DECIMATION_RATIO * cicGain(order - 1);
+}
+
+static constexpr int32_t CIC_GAIN = cicGain(CIC_ORDER);
+
+static_assert(CIC_ORDER >= 1 && CIC_ORDER <= 4, "CIC_ORDER out of range");
+static_assert(DECIMATION_RATIO >= 1, "DECIMATION_RATIO out of range");
+static_assert(32768LL * CIC_GAIN <= 0x7FFFFFFFLL, "CIC output does not fit int32");
+static_assert(sizeof(RawSample) == 6 * sizeof(int16_t), "RawSample must be six packed channels");
+
+// Group delay N * (R - 1) / 2 input periods
+static const uint32_t GROUP_DELAY_US = (uint32_t)CIC_ORDER * (DECIMATION_RATIO - 1) * (1000000UL / FIFO_SAMPLE_RATE_HZ) / 2;
+
+CicDecimator::CicDecimator() {
+  reset();
+}
+
+void CicDecimator::reset() {
+  memset(integrators, 0, sizeof(integrators));
+  memset(combs, 0, sizeof(combs));
+  phase = 0;
+  warmup = CIC_ORDER - 1;
+}
+
+bool CicDecimator::push(const TimedSample& in, TimedSample& out) {
+  int16_t channels[6];
+  memcpy(channels, &in.raw, sizeof(channels));
+
+  for (int c = 0; c < 6; c++) {
+    uint32_t acc = (uint32_t)(int32_t)channels[c];
+    for (int stage = 0; stage < CIC_ORDER; stage++) {
+      integrators[stage][c] += acc;
+      acc = integrators[stage][c];
+    }
+  }
+
+  if (++phase < DECIMATION_RATIO) {
+    return false;
+  }
+  phase = 0;
+
+  int16_t outChannels[6];
+  for (int c = 0; c < 6; c++) {
+    uint32_t acc = integrators[CIC_ORDER - 1][c];
+    for (int stage = 0; stage < CIC_ORDER; stage++) {
+      uint32_t delayed = combs[stage][c];
+      combs[stage][c] = acc;
+      acc -= delayed;
+    }
+
+    // Divide out the gain, rounding half away from zero
+    int32_t sum = (int32_t)acc;
+    int32_t value = sum >= 0 ? (sum + CIC_GAIN / 2) / CIC_GAIN : (sum - CIC_GAIN / 2) / CIC_GAIN;
+    outChannels[c] = (int16_t)constrain(value, -32768, 32767);
+  }
+
+  if (warmup > 0) {
+    // The comb delays are not filled yet - this output only sees part of the window
+    warmup--;
+    return false;
+  }
+
+  memcpy(&out.raw, outChannels, sizeof(outChannels));
+  out.timestampUs = in.timestampUs - GROUP_DELAY_US;
+  out.azimuthTicks = in.azimuthTicks;
+  return true;
+}
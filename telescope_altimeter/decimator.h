@@ -0,0 +1,35 @@
+/*
+ * CIC decimator for Telescope Altimeter
+ * Integer cascaded integrator-comb filter that reduces the oversampled
+ * MPU6050 stream by DECIMATION_RATIO, averaging away noise before the
+ * angle math runs
+ */
+
+#ifndef DECIMATOR_H
+#define DECIMATOR_H
+
+#include "config.h"
+#include "sensor.h"
+
+class CicDecimator {
+public:
+  CicDecimator();
+
+  // Drop all history (after a FIFO reset the stream is discontinuous)
+  void reset();
+
+  // Feed one input sample; returns true when a decimated sample is ready.
+  // Output counts are on the input scale; the timestamp is moved back by
+  // the filter's group delay so it matches the samples it averages. The
+  // azimuth count is the newest input's (GROUP_DELAY_US newer).
+  bool push(const TimedSample& in, TimedSample& out);
+
+private:
+  // Modular arithmetic: integrator wrap-around cancels in the combs
+  uint32_t integrators[CIC_ORDER][6];
+  uint32_t combs[CIC_ORDER][6];
+  uint8_t phase;
+  uint8_t warmup;   // Outputs still to discard after a reset
+};
+
+#endif // DECIMATOR_H
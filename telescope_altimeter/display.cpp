@@ -4,203 +4,303 @@
 
 #include "display.h"
 #include "config.h"
+#include "profiler.h"
+#include "format.h"
+#include "console.h"
 #include <Arduino.h>
 
+#define ALL_PAGES ((uint8_t)((1 << DISPLAY_PAGES) - 1))
+
 TelescopeDisplay::TelescopeDisplay()
-  : display(U8G2_R0, /* reset=*/ U8X8_PIN_NONE) {
+  : display(U8G2_R0, /* reset=*/ U8X8_PIN_NONE),
+    screen(SCREEN_MODE),
+    frameMode(MODE_NORMAL),
+    frameAltitude(0.0),
+    frameRawAngle(0.0),
+    frameCalibrated(false),
+    frameTitle(""),
+    frameMessage(""),
+    spritesReady(false),
+    overlayTitle(""),
+    overlayMessage(""),
+    overlayStart(0),
+    overlayDuration(0),
+    pendingPages(0),
+    refreshPage(DISPLAY_PAGES),
+    nextRefreshPage(0),
+    framesToRefresh(DISPLAY_REFRESH_FRAMES),
+    frameChanged(false),
+    pagesSent(0),
+    framesSkipped(0) {
 }
 
 bool TelescopeDisplay::begin() {
   display.begin();
+  display.clearDisplay();
+
+#if DISPLAY_SPRITES
+  captureSprites();
+#endif
+
+  // The panel is blank now; a blank page hashes the same at any position
   display.clearBuffer();
-  display.sendBuffer();
+  uint32_t blank = hashPage(display.getBufferPtr());
+  for (uint8_t page = 0; page < DISPLAY_PAGES; page++) {
+    pageHash[page] = blank;
+  }
 
-  Serial.println("Display initialized successfully");
+  console.println("Display initialized successfully");
   return true;
 }
 
 void TelescopeDisplay::update(UIMode mode, float filteredAltitude, float rawAngle, bool isCalibrated) {
-  display.clearBuffer();
-
-  switch (mode) {
-    case MODE_NORMAL:
-      displayNormalMode(filteredAltitude, rawAngle, isCalibrated);
-      break;
+  if (isOverlayActive()) {
+    screen = SCREEN_MESSAGE;
+    frameTitle = overlayTitle;
+    frameMessage = overlayMessage;
+  } else {
+    screen = SCREEN_MODE;
+  }
+  frameMode = mode;
+  frameAltitude = filteredAltitude;
+  frameRawAngle = rawAngle;
+  frameCalibrated = isCalibrated;
+  startFrame();
+}
 
-    case MODE_CALIBRATION_MENU:
-      displayCalibrationMenu();
-      break;
+void TelescopeDisplay::startFrame() {
+  // A frame still in flight is abandoned; pages it already sent stay valid
+  // because pageHash tracks what the panel shows
+  pendingPages = ALL_PAGES;
+  frameChanged = false;
+
+  // Send one page in turn regardless of its hash (a collision would
+  // otherwise keep a stale row on the panel for good)
+  refreshPage = DISPLAY_PAGES;
+  if (--framesToRefresh == 0) {
+    framesToRefresh = DISPLAY_REFRESH_FRAMES;
+    refreshPage = nextRefreshPage;
+    nextRefreshPage = (nextRefreshPage + 1) % DISPLAY_PAGES;
+  }
 
-    case MODE_ZERO_CALIBRATION:
-      displayZeroCalibration(rawAngle);
-      break;
+  if constexpr (DisplayBuffer::full) {
+    {
+      PROFILE_SCOPE(PROFILE_RENDER);
+      display.clearBuffer();
+      redraw();
+    }
+
+    // Queue only the rows that differ from the panel
+    const uint8_t* buffer = display.getBufferPtr();
+    for (uint8_t page = 0; page < DISPLAY_PAGES; page++) {
+      frameHash[page] = hashPage(buffer + page * DISPLAY_PAGE_ROWS * 128);
+      if (frameHash[page] == pageHash[page] && page != refreshPage) {
+        pendingPages &= ~(1 << page);
+      }
+    }
+
+    if (pendingPages == 0) {
+      framesSkipped++;
+    }
+  }
+}
 
-    case MODE_STOP_A_CALIBRATION:
-      displayStopACalibration(rawAngle);
+void TelescopeDisplay::redraw() {
+  switch (screen) {
+    case SCREEN_MODE:
+      drawMode();
       break;
 
-    case MODE_STOP_B_CALIBRATION:
-      displayStopBCalibration(rawAngle);
+    case SCREEN_MESSAGE:
+      drawMessage(frameTitle, frameMessage);
       break;
 
-    case MODE_SESSION_SYNC_A:
-      displaySessionSyncA(rawAngle);
+    case SCREEN_STARTUP:
+      drawStartup();
       break;
 
-    case MODE_SESSION_SYNC_B:
-      displaySessionSyncB(rawAngle);
+    case SCREEN_ERROR:
+      drawError(frameMessage);
       break;
   }
-
-  display.sendBuffer();
 }
 
-void TelescopeDisplay::displayNormalMode(float filteredAltitude, float rawAngle, bool isCalibrated) {
-  // YELLOW ZONE (0-10): Title only
-  display.setFont(u8g2_font_6x10_tf);
-  display.drawStr(0, 9, "ALTITUDE");
+void TelescopeDisplay::drawMode() {
+  UiScreen descriptor;
+  uiGetScreen(frameMode, descriptor);
 
-  if (!isCalibrated) {
-    display.drawStr(70, 9, "[UNCAL]");
+  if (descriptor.live == LIVE_ALTITUDE) {
+    displayNormalMode(frameAltitude, frameRawAngle, frameCalibrated);
+  } else {
+    drawScreen(descriptor, frameRawAngle);
   }
-
-  // BLUE ZONE (13-64): Main altitude reading in degrees and minutes
-  // Convert decimal degrees to degrees and minutes
-  int degrees = (int)filteredAltitude;
-  float decimalPart = filteredAltitude - degrees;
-  int minutes = (int)(abs(decimalPart) * 60.0);
-
-  // Build degrees string (no sign)
-  char altStr[16];
-  snprintf(altStr, sizeof(altStr), "%d", abs(degrees));
-
-  // Display degrees (larger font)
-  display.setFont(u8g2_font_logisoso22_tn);
-  int xPos = display.drawStr(1, 42, altStr);
-
-  // Display degree symbol (medium font, superscript position)
-  display.setFont(u8g2_font_9x18_tf);
-  display.drawStr(xPos + 1, 28, "\xB0");  // \xB0 is degree symbol
-
-  // Display minutes (medium font, right after degrees)
-  display.setFont(u8g2_font_10x20_tf);
-  char minStr[8];
-  snprintf(minStr, sizeof(minStr), "%02d'", minutes);
-  display.drawStr(xPos + 10, 42, minStr);
-
-  // Debug info at bottom
-  display.setFont(u8g2_font_6x10_tf);
-  display.setCursor(0, 62);
-  display.print("Raw: ");
-  display.print(rawAngle, 1);
-  display.print((char)176);  // Degree symbol
 }
 
-void TelescopeDisplay::displayCalibrationMenu() {
-  // YELLOW ZONE (0-10): Title
-  display.setFont(u8g2_font_7x13_tf);
-  display.drawStr(0, 9, "CALIBRATION");
+void TelescopeDisplay::captureSprites() {
+  // Fonts and baselines must match the drawText() calls in displayNormalMode
+  spritesReady = titleSprites.capture(display, u8g2_font_6x10_tf, 9, "ALTIUDE[NC]") &&
+                 degreeSprites.capture(display, u8g2_font_logisoso22_tn, 42, "-0123456789") &&
+                 degreeSignSprites.capture(display, u8g2_font_9x18_tf, 28, "\xB0") &&
+                 minuteSprites.capture(display, u8g2_font_10x20_tf, 42, "0123456789'") &&
+                 rawSprites.capture(display, u8g2_font_6x10_tf, 62, "Raw: -.0123456789\xB0");
+
+  console.print("Display sprites: ");
+  console.print(getSpriteBytes());
+  console.println(" bytes");
+}
 
-  // BLUE ZONE (13-64): Instructions
-  display.setFont(u8g2_font_6x10_tf);
-  display.drawStr(0, 25, "1. Level telescope");
-  display.drawStr(0, 37, "2. Press button");
-  display.drawStr(0, 52, "Hold to cancel");
+uint16_t TelescopeDisplay::getSpriteBytes() const {
+  return titleSprites.getBytes() + degreeSprites.getBytes() + degreeSignSprites.getBytes() +
+         minuteSprites.getBytes() + rawSprites.getBytes();
 }
 
-void TelescopeDisplay::displayZeroCalibration(float rawAngle) {
-  // YELLOW ZONE (0-10): Title
-  display.setFont(u8g2_font_7x13_tf);
-  display.drawStr(0, 9, "STEP 1: ZERO");
+int TelescopeDisplay::drawText(const GlyphSprites& sprites, const uint8_t* font, int x, int baseline, const char* text) {
+  if (spritesReady) {
+    return sprites.draw(display, x, text);
+  }
+  display.setFont(font);
+  return display.drawStr(x, baseline, text);
+}
 
-  // BLUE ZONE (13-64): Instructions
-  display.setFont(u8g2_font_6x10_tf);
-  display.drawStr(0, 25, "Level telescope");
-  display.drawStr(0, 37, "with bubble level");
-  display.drawStr(0, 52, "Press when ready");
+// "Raw: 12.3" followed by the given degree mark
+static void formatRawLine(char* out, float rawAngle, const char* degreeMark) {
+  strcpy(out, "Raw: ");
+  int length = 5 + formatDegreesTenths(out + 5, rawAngle);
+  strcpy(out + length, degreeMark);
+}
 
-  // Current angle at bottom
-  display.setCursor(0, 62);
-  display.print("Raw: ");
-  display.print(rawAngle, 1);
-  display.print("°");
+uint32_t TelescopeDisplay::hashPage(const uint8_t* page) {
+  uint32_t hash = 2166136261UL;
+  for (uint16_t i = 0; i < DISPLAY_PAGE_ROWS * 128; i++) {
+    hash = (hash ^ page[i]) * 16777619UL;
+  }
+  return hash;
 }
 
-void TelescopeDisplay::displayStopACalibration(float rawAngle) {
-  // YELLOW ZONE (0-10): Title
-  display.setFont(u8g2_font_7x13_tf);
-  display.drawStr(0, 9, "STEP 2: STOP A");
+bool TelescopeDisplay::sendNextPage() {
+  while (pendingPages != 0) {
+    uint8_t page = 0;
+    while (!(pendingPages & (1 << page))) {
+      page++;
+    }
+    pendingPages &= ~(1 << page);
+
+    uint32_t hash;
+    if constexpr (DisplayBuffer::full) {
+      // The buffer only changes in startFrame(), which re-hashes it, so the
+      // row going out always matches frameHash
+      hash = frameHash[page];
+    } else {
+      // Point the page window at this page and draw the whole screen into it
+      {
+        PROFILE_SCOPE(PROFILE_RENDER);
+        display.setBufferCurrTileRow(page * DISPLAY_PAGE_ROWS);
+        display.clearBuffer();
+        redraw();
+      }
+      hash = hashPage(display.getBufferPtr());
+      if (hash == pageHash[page] && page != refreshPage) {
+        continue;  // Unchanged - costs CPU but no bus time
+      }
+    }
+
+    {
+      PROFILE_SCOPE(PROFILE_SEND);
+      if constexpr (DisplayBuffer::full) {
+        display.updateDisplayArea(0, page, display.getBufferTileWidth(), 1);
+      } else {
+        display.sendBuffer();
+      }
+    }
+    pageHash[page] = hash;
+    pagesSent++;
+    frameChanged = true;
+    return true;
+  }
 
-  // BLUE ZONE (13-64): Instructions
-  display.setFont(u8g2_font_6x10_tf);
-  display.drawStr(0, 25, "Move to Stop A");
-  display.drawStr(0, 37, "(low position)");
-  display.drawStr(0, 52, "Press when ready");
+  if constexpr (!DisplayBuffer::full) {
+    if (!frameChanged) {
+      framesSkipped++;
+      frameChanged = true;  // Count each frame once
+    }
+  }
+  return false;
+}
 
-  // Current angle at bottom
-  display.setCursor(0, 62);
-  display.print("Raw: ");
-  display.print(rawAngle, 1);
-  display.print("o");
+void TelescopeDisplay::flush() {
+  while (sendNextPage()) {
+  }
 }
 
-void TelescopeDisplay::displayStopBCalibration(float rawAngle) {
-  // YELLOW ZONE (0-10): Title
-  display.setFont(u8g2_font_7x13_tf);
-  display.drawStr(0, 9, "STEP 3: STOP B");
+void TelescopeDisplay::displayNormalMode(float filteredAltitude, float rawAngle, bool isCalibrated) {
+  // YELLOW ZONE (0-10): Title only
+  drawText(titleSprites, u8g2_font_6x10_tf, 0, 9, "ALTITUDE");
 
-  // BLUE ZONE (13-64): Instructions
-  display.setFont(u8g2_font_6x10_tf);
-  display.drawStr(0, 25, "Move to Stop B");
-  display.drawStr(0, 37, "(high position)");
-  display.drawStr(0, 52, "Press when ready");
+  if (!isCalibrated) {
+    drawText(titleSprites, u8g2_font_6x10_tf, 70, 9, "[UNCAL]");
+  }
 
-  // Current angle at bottom
-  display.setCursor(0, 62);
-  display.print("Raw: ");
-  display.print(rawAngle, 1);
-  display.print("o");
-}
+  // BLUE ZONE (13-64): Main altitude reading in degrees and minutes
+  bool negative;
+  uint16_t degrees;
+  uint8_t minutes;
+  splitArcminutes(filteredAltitude, negative, degrees, minutes);
+
+  // Display degrees (larger font), with the sign below level
+  char altStr[FORMAT_BUFFER_SIZE];
+  int length = 0;
+  if (negative) {
+    altStr[length++] = '-';
+  }
+  formatUnsigned(altStr + length, degrees);
+  int xPos = drawText(degreeSprites, u8g2_font_logisoso22_tn, 1, 42, altStr);
 
-void TelescopeDisplay::displaySessionSyncA(float rawAngle) {
-  // YELLOW ZONE (0-10): Title
-  display.setFont(u8g2_font_7x13_tf);
-  display.drawStr(0, 9, "SESSION SYNC");
+  // Display degree symbol (medium font, superscript position)
+  drawText(degreeSignSprites, u8g2_font_9x18_tf, xPos + 1, 28, "\xB0");
 
-  // BLUE ZONE (13-64): Instructions
-  display.setFont(u8g2_font_6x10_tf);
-  display.drawStr(0, 25, "Move to Stop A");
-  display.drawStr(0, 37, "(low position)");
-  display.drawStr(0, 52, "Press when ready");
+  // Display minutes (medium font, right after degrees)
+  char minStr[FORMAT_BUFFER_SIZE];
+  length = formatUnsigned(minStr, minutes, 2);
+  minStr[length++] = '\'';
+  minStr[length] = '\0';
+  drawText(minuteSprites, u8g2_font_10x20_tf, xPos + 10, 42, minStr);
 
-  // Current angle at bottom
-  display.setCursor(0, 62);
-  display.print("Raw: ");
-  display.print(rawAngle, 1);
-  display.print("o");
+  // Debug info at bottom
+  char rawLine[FORMAT_BUFFER_SIZE + 8];
+  formatRawLine(rawLine, rawAngle, "\xB0");
+  drawText(rawSprites, u8g2_font_6x10_tf, 0, 62, rawLine);
 }
 
-void TelescopeDisplay::displaySessionSyncB(float rawAngle) {
+void TelescopeDisplay::drawScreen(const UiScreen& descriptor, float rawAngle) {
+  static const uint8_t lineBaselines[UI_SCREEN_LINES] = {25, 37, 52};
+
   // YELLOW ZONE (0-10): Title
   display.setFont(u8g2_font_7x13_tf);
-  display.drawStr(0, 9, "SESSION SYNC");
+  display.drawStr(0, 9, descriptor.title);
 
   // BLUE ZONE (13-64): Instructions
   display.setFont(u8g2_font_6x10_tf);
-  display.drawStr(0, 25, "Move to Stop B");
-  display.drawStr(0, 37, "(high position)");
-  display.drawStr(0, 52, "Press when ready");
+  for (int i = 0; i < UI_SCREEN_LINES; i++) {
+    if (descriptor.lines[i][0] != '\0') {
+      display.drawStr(0, lineBaselines[i], descriptor.lines[i]);
+    }
+  }
 
   // Current angle at bottom
-  display.setCursor(0, 62);
-  display.print("Raw: ");
-  display.print(rawAngle, 1);
-  display.print("o");
+  if (descriptor.live == LIVE_RAW_ANGLE) {
+    char rawLine[FORMAT_BUFFER_SIZE + 8];
+    formatRawLine(rawLine, rawAngle, descriptor.degreeMark);
+    display.drawStr(0, 62, rawLine);
+  }
 }
 
 void TelescopeDisplay::showStartup() {
-  display.clearBuffer();
+  screen = SCREEN_STARTUP;
+  startFrame();
+  flush();
+}
 
+void TelescopeDisplay::drawStartup() {
   // YELLOW ZONE (0-10): Empty
   display.setFont(u8g2_font_7x13_tf);
   display.drawStr(0, 8, "Sky Watcher Classic 200");
@@ -211,13 +311,16 @@ void TelescopeDisplay::showStartup() {
   display.drawStr(10, 50, "ALTIMETER");
   display.setFont(u8g2_font_6x10_tf);
   display.drawStr(50, 60, VERSION_STRING);
-
-  display.sendBuffer();
 }
 
 void TelescopeDisplay::showError(const char* message) {
-  display.clearBuffer();
+  screen = SCREEN_ERROR;
+  frameMessage = message;
+  startFrame();
+  flush();
+}
 
+void TelescopeDisplay::drawError(const char* message) {
   // YELLOW ZONE (0-10): Empty
 
   // BLUE ZONE (13-64): Error message
@@ -225,13 +328,17 @@ void TelescopeDisplay::showError(const char* message) {
   display.drawStr(10, 32, "ERROR:");
   display.setFont(u8g2_font_6x10_tf);
   display.drawStr(10, 50, message);
-
-  display.sendBuffer();
 }
 
 void TelescopeDisplay::showMessage(const char* title, const char* message) {
-  display.clearBuffer();
+  screen = SCREEN_MESSAGE;
+  frameTitle = title;
+  frameMessage = message;
+  startFrame();
+  flush();
+}
 
+void TelescopeDisplay::drawMessage(const char* title, const char* message) {
   // YELLOW ZONE (0-10): Empty
 
   // BLUE ZONE (13-64): Message
@@ -239,6 +346,26 @@ void TelescopeDisplay::showMessage(const char* title, const char* message) {
   display.drawStr(0, 30, title);
   display.setFont(u8g2_font_6x10_tf);
   display.drawStr(0, 50, message);
+}
+
+void TelescopeDisplay::showOverlay(const char* title, const char* message, unsigned long durationMs) {
+  overlayTitle = title;
+  overlayMessage = message;
+  overlayStart = millis();
+  overlayDuration = durationMs;
+
+  // Start it right away rather than waiting for the next refresh; the bus
+  // scheduler sends it between sensor reads
+  screen = SCREEN_MESSAGE;
+  frameTitle = title;
+  frameMessage = message;
+  startFrame();
+}
+
+bool TelescopeDisplay::isOverlayActive() const {
+  return overlayDuration > 0 && millis() - overlayStart < overlayDuration;
+}
 
-  display.sendBuffer();
+void TelescopeDisplay::dismissOverlay() {
+  overlayDuration = 0;
 }
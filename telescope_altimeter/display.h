@@ -7,18 +7,55 @@
 #define DISPLAY_H
 
 #include <U8g2lib.h>
+#include "config.h"
+#include "sprites.h"
+#include "ui.h"
 
-// UI Modes
-enum UIMode {
-  MODE_NORMAL,
-  MODE_CALIBRATION_MENU,
-  MODE_ZERO_CALIBRATION,
-  MODE_STOP_A_CALIBRATION,
-  MODE_STOP_B_CALIBRATION,
-  MODE_SESSION_SYNC_A,
-  MODE_SESSION_SYNC_B
+// SSD1306 128x64: 8 tile rows of 8 pixels
+#define DISPLAY_TILE_ROWS 8
+
+// Frame buffer selection (set DISPLAY_BUFFER in config.h); the value is the
+// number of tile rows the U8g2 buffer holds
+#define DISPLAY_BUFFER_ONE_PAGE 1
+#define DISPLAY_BUFFER_TWO_PAGE 2
+#define DISPLAY_BUFFER_FULL 8
+
+// Frame buffer policies: the U8g2 driver and the unit of transfer (one tile
+// row with the full buffer, one buffer page otherwise)
+template <int Rows>
+struct DisplayBufferPolicy;
+
+template <>
+struct DisplayBufferPolicy<DISPLAY_BUFFER_FULL> {
+  typedef U8G2_SSD1306_128X64_NONAME_F_HW_I2C Driver;
+  static constexpr const char* name = "full";
+  static constexpr bool full = true;
+  static constexpr uint8_t pageRows = 1;
+};
+
+template <>
+struct DisplayBufferPolicy<DISPLAY_BUFFER_TWO_PAGE> {
+  typedef U8G2_SSD1306_128X64_NONAME_2_HW_I2C Driver;
+  static constexpr const char* name = "two-page";
+  static constexpr bool full = false;
+  static constexpr uint8_t pageRows = 2;
+};
+
+template <>
+struct DisplayBufferPolicy<DISPLAY_BUFFER_ONE_PAGE> {
+  typedef U8G2_SSD1306_128X64_NONAME_1_HW_I2C Driver;
+  static constexpr const char* name = "one-page";
+  static constexpr bool full = false;
+  static constexpr uint8_t pageRows = 1;
 };
 
+typedef DisplayBufferPolicy<DISPLAY_BUFFER> DisplayBuffer;
+typedef DisplayBuffer::Driver DisplayDriver;
+
+#define DISPLAY_PAGE_ROWS (DisplayBuffer::pageRows)
+#define DISPLAY_PAGES (DISPLAY_TILE_ROWS / DISPLAY_PAGE_ROWS)
+#define DISPLAY_BUFFER_BYTES (DISPLAY_BUFFER * 128)
+
 class TelescopeDisplay {
 public:
   TelescopeDisplay();
@@ -26,25 +63,105 @@ public:
   // Initialization
   bool begin();
 
-  // Update display based on current mode
+  // Start a frame for the current mode; the bus scheduler sends the pages
+  // that changed with sendNextPage()
   void update(UIMode mode, float filteredAltitude, float rawAngle, bool isCalibrated);
 
-  // Show special screens
+  // Send the next changed page of the current frame (in page-buffer mode,
+  // redrawing pages until one differs); returns false when none is left
+  bool sendNextPage();
+
+  // Send the rest of the frame now - for screens shown before blocking work
+  void flush();
+
+  // Show special screens (sent immediately)
   void showStartup();
   void showError(const char* message);
   void showMessage(const char* title, const char* message);
 
+  // Timed overlay drawn by update() instead of the mode screen until it expires
+  void showOverlay(const char* title, const char* message, unsigned long durationMs);
+  bool isOverlayActive() const;
+  void dismissOverlay();
+
+  // Transfer statistics for the dirty-region refresh
+  unsigned long getPagesSent() const { return pagesSent; }
+  unsigned long getFramesSkipped() const { return framesSkipped; }
+
+  // DRAM held by the glyph sprite cache (0 without DISPLAY_SPRITES)
+  uint16_t getSpriteBytes() const;
+
 private:
-  U8G2_SSD1306_128X64_NONAME_F_HW_I2C display;
+  DisplayDriver display;
+
+  // What redraw() draws. Captured when a frame starts, so every page of a
+  // page-buffer frame shows the same screen.
+  enum Screen {
+    SCREEN_MODE,
+    SCREEN_MESSAGE,
+    SCREEN_STARTUP,
+    SCREEN_ERROR
+  };
+  Screen screen;
+  UIMode frameMode;
+  float frameAltitude;
+  float frameRawAngle;
+  bool frameCalibrated;
+  const char* frameTitle;
+  const char* frameMessage;
+
+  // Main screen glyphs, one set per font and text line; captured at boot
+  // with DISPLAY_SPRITES, otherwise empty
+  GlyphSprites titleSprites;
+  GlyphSprites degreeSprites;
+  GlyphSprites degreeSignSprites;
+  GlyphSprites minuteSprites;
+  GlyphSprites rawSprites;
+  bool spritesReady;
+
+  void captureSprites();
+
+  // Draw main screen text from sprites (captured at this baseline) or,
+  // without them, with the font; returns the advance
+  int drawText(const GlyphSprites& sprites, const uint8_t* font, int x, int baseline, const char* text);
+
+  // Overlay state
+  const char* overlayTitle;
+  const char* overlayMessage;
+  unsigned long overlayStart;
+  unsigned long overlayDuration;
+
+  // Hash of each page as last sent to the panel
+  uint32_t pageHash[DISPLAY_PAGES];
+  uint32_t frameHash[DisplayBuffer::full ? DISPLAY_PAGES : 1];  // ...and as rendered (full buffer)
+  uint8_t pendingPages;  // Bit per page of the current frame not yet sent (or checked)
+  uint8_t refreshPage;   // Page sent this frame whatever its hash (DISPLAY_PAGES: none)
+  uint8_t nextRefreshPage;
+  uint8_t framesToRefresh;
+  bool frameChanged;
+  unsigned long pagesSent;
+  unsigned long framesSkipped;
+
+  // Start a frame of the current screen: render it once (full buffer) or
+  // leave it to the page loop in sendNextPage()
+  void startFrame();
+
+  // Draw the current screen; called once per frame with the full buffer and
+  // once per page otherwise (U8g2 clips drawing to the page)
+  void redraw();
+  void drawMode();
+  void drawStartup();
+  void drawError(const char* message);
+
+  // Title + message layout shared by showMessage and overlays
+  void drawMessage(const char* title, const char* message);
+
+  // FNV-1a over one page of buffer bytes
+  static uint32_t hashPage(const uint8_t* page);
 
-  // Mode-specific display functions
+  // The main altitude screen, and every other mode's screen from its ui.h row
   void displayNormalMode(float filteredAltitude, float rawAngle, bool isCalibrated);
-  void displayCalibrationMenu();
-  void displayZeroCalibration(float rawAngle);
-  void displayStopACalibration(float rawAngle);
-  void displayStopBCalibration(float rawAngle);
-  void displaySessionSyncA(float rawAngle);
-  void displaySessionSyncB(float rawAngle);
+  void drawScreen(const UiScreen& descriptor, float rawAngle);
 };
 
 #endif // DISPLAY_H
@@ -0,0 +1,110 @@
+/*
+ * Streaming angle estimator implementation for Telescope Altimeter
+ */
+
+#include "estimator.h"
+#include "config.h"
+#include <Arduino.h>
+
+void Welford::reset() {
+  count = 0;
+  mean = 0.0f;
+  m2 = 0.0f;
+}
+
+void Welford::add(float x) {
+  count++;
+  float delta = x - mean;
+  mean += delta / count;
+  m2 += delta * (x - mean);
+}
+
+AngleEstimator::AngleEstimator() {
+  reset();
+}
+
+void AngleEstimator::reset() {
+  samples.reset();
+  previous = 0.0f;
+  havePrevious = false;
+  pairs = 0;
+  pairMeanA = 0.0f;
+  pairMeanB = 0.0f;
+  coMoment = 0.0f;
+  rejected = 0;
+}
+
+bool AngleEstimator::add(float angle) {
+  // Gate once the spread is known: a knock or a vibration spike lands far
+  // outside it, while the floor keeps quantization from rejecting everything
+  if (samples.getCount() >= CAPTURE_MIN_SAMPLES / 2) {
+    float limit = CAPTURE_OUTLIER_SIGMA * getStdDev();
+    if (limit < CAPTURE_OUTLIER_FLOOR_DEG) {
+      limit = CAPTURE_OUTLIER_FLOOR_DEG;
+    }
+    if (fabsf(angle - samples.getMean()) > limit) {
+      rejected++;
+      havePrevious = false;  // The gap breaks the lag-1 chain
+      return false;
+    }
+  }
+
+  samples.add(angle);
+
+  // Online covariance of the (previous, current) pairs
+  if (havePrevious) {
+    pairs++;
+    float deltaA = previous - pairMeanA;
+    pairMeanA += deltaA / pairs;
+    pairMeanB += (angle - pairMeanB) / pairs;
+    coMoment += deltaA * (angle - pairMeanB);
+  }
+  previous = angle;
+  havePrevious = true;
+  return true;
+}
+
+float AngleEstimator::getStdDev() const {
+  return sqrtf(samples.getVariance());
+}
+
+float AngleEstimator::getCorrelation() const {
+  float variance = samples.getVariance();
+  if (pairs < 2 || variance <= 0.0f) {
+    return 0.0f;
+  }
+
+  // Clamped: negative correlation would only flatter the estimate, and near
+  // 1 the AR(1) correction below blows up
+  float rho = coMoment / (pairs - 1) / variance;
+  return constrain(rho, 0.0f, CAPTURE_MAX_CORRELATION);
+}
+
+float AngleEstimator::getStandardError() const {
+  uint16_t n = samples.getCount();
+  if (n < 2) {
+    return INFINITY;
+  }
+
+  // Variance of the mean of an AR(1) sequence: sigma^2 / n * (1 + rho) / (1 - rho)
+  float rho = getCorrelation();
+  return sqrtf(samples.getVariance() / n * (1.0f + rho) / (1.0f - rho));
+}
+
+bool AngleEstimator::isConverged() const {
+  uint16_t n = samples.getCount();
+  if (n < CAPTURE_MIN_SAMPLES) {
+    return false;
+  }
+
+  // Test a one-sigma upper bound of the estimate (over the effective sample
+  // count), so stopping on a lucky run of samples does not understate it
+  float rho = getCorrelation();
+  float effective = n * (1.0f - rho) / (1.0f + rho);
+  float bound = 1.0f + (effective > 2.0f ? 1.0f / sqrtf(2.0f * (effective - 1.0f)) : 1.0f);
+  return getStandardError() * bound <= CAPTURE_TARGET_SE_DEG;
+}
+
+bool AngleEstimator::isFinished() const {
+  return isConverged() || samples.getCount() + rejected >= CAPTURE_MAX_SAMPLES;
+}
@@ -0,0 +1,70 @@
+/*
+ * Streaming angle estimator for Telescope Altimeter calibration captures
+ * Welford mean/variance with outlier rejection; decides when a capture has
+ * converged so still captures end early and noisy ones run longer
+ */
+
+#ifndef ESTIMATOR_H
+#define ESTIMATOR_H
+
+#include <stdint.h>
+
+// Running mean and variance (Welford's algorithm)
+class Welford {
+public:
+  Welford() { reset(); }
+
+  void reset();
+  void add(float x);
+
+  uint16_t getCount() const { return count; }
+  float getMean() const { return mean; }
+  float getVariance() const { return count > 1 ? m2 / (count - 1) : 0.0f; }
+
+private:
+  uint16_t count;
+  float mean;
+  float m2;  // Sum of squared deviations from the mean
+};
+
+class AngleEstimator {
+public:
+  AngleEstimator();
+
+  void reset();
+
+  // Feed one angle (degrees); returns false when it was rejected as an outlier
+  bool add(float angle);
+
+  // Standard error (one-sigma upper bound) at or below CAPTURE_TARGET_SE_DEG,
+  // after at least CAPTURE_MIN_SAMPLES
+  bool isConverged() const;
+
+  // Converged, or CAPTURE_MAX_SAMPLES seen
+  bool isFinished() const;
+
+  float getMean() const { return samples.getMean(); }
+  float getStdDev() const;
+  float getStandardError() const;
+  float getCorrelation() const;
+  uint16_t getAccepted() const { return samples.getCount(); }
+  uint16_t getRejected() const { return rejected; }
+
+private:
+  // Every accepted sample: mean and the spread used by the outlier gate
+  Welford samples;
+
+  // Lag-1 co-moment of consecutive accepted samples. The DLPF makes
+  // neighbouring samples correlated, which shrinks the effective sample
+  // count; the standard error is widened by the measured correlation.
+  float previous;
+  bool havePrevious;
+  uint16_t pairs;
+  float pairMeanA;
+  float pairMeanB;
+  float coMoment;
+
+  uint16_t rejected;
+};
+
+#endif // ESTIMATOR_H
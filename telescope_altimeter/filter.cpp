@@ -0,0 +1,87 @@
+/*
+ * Altitude filter implementation for Telescope Altimeter
+ */
+
+#include "filter.h"
+#include "config.h"
+#include "pipeline.h"
+#include <Arduino.h>
+
+AltitudeFilter::AltitudeFilter()
+  : state(WARMUP), warmupCount(0), altitude(0.0), lastAccelAngle(0.0), gyroBias(0.0),
+    biasKnown(false), atRest(false), speed(0.0) {
+}
+
+void AltitudeFilter::reset() {
+  // Bias is a property of the sensor, not of the reading - keep it
+  state = WARMUP;
+  warmupCount = 0;
+  altitude = 0.0;
+  atRest = false;
+  speed = 0.0;
+}
+
+void AltitudeFilter::getState(AltitudeFilterState& saved) const {
+  saved.state = (uint8_t)state;
+  saved.warmupCount = (uint8_t)warmupCount;
+  saved.biasKnown = biasKnown;
+  saved.atRest = atRest;
+  saved.altitude = altitude;
+  saved.lastAccelAngle = lastAccelAngle;
+  saved.gyroBias = gyroBias;
+  saved.speed = speed;
+}
+
+void AltitudeFilter::setState(const AltitudeFilterState& saved) {
+  state = (State)saved.state;
+  warmupCount = saved.warmupCount;
+  biasKnown = saved.biasKnown;
+  atRest = saved.atRest;
+  altitude = saved.altitude;
+  lastAccelAngle = saved.lastAccelAngle;
+  gyroBias = saved.gyroBias;
+  speed = saved.speed;
+}
+
+void AltitudeFilter::warmUp(float accelAngle, float gyroRate) {
+  warmupCount++;
+
+  // Running mean of the readings so far
+  altitude += (accelAngle - altitude) / warmupCount;
+  lastAccelAngle = accelAngle;
+
+  if (!biasKnown) {
+    // The scope is assumed still at power-on: seed the bias estimate
+    gyroBias += (gyroRate - gyroBias) / warmupCount;
+  }
+
+  if (warmupCount >= FILTER_WARMUP_BATCHES) {
+    state = TRACKING;
+    biasKnown = true;
+  }
+}
+
+void AltitudeFilter::trackBias(float accelAngle, float gyroRate, float dt) {
+  // Track gyro bias only while both sensors agree the tube is still
+  float rate = gyroRate - gyroBias;
+  float accelRate = dt > 0.0 ? (accelAngle - lastAccelAngle) / dt : 0.0;
+  lastAccelAngle = accelAngle;
+  atRest = fabs(rate) < GYRO_REST_THRESHOLD_DPS && fabs(accelRate) < GYRO_REST_THRESHOLD_DPS;
+  if (atRest) {
+    gyroBias += (gyroRate - gyroBias) * dt / GYRO_BIAS_TAU;
+  }
+}
+
+float AltitudeFilter::update(float accelAngle, float gyroRate, float dt) {
+  if (state == WARMUP) {
+    warmUp(accelAngle, gyroRate);
+    return altitude;
+  }
+
+  altitude = Smoothing::step(altitude, accelAngle, gyroRate - gyroBias, dt, speed);
+  if constexpr (Smoothing::usesGyro) {
+    trackBias(accelAngle, gyroRate, dt);
+  }
+
+  return altitude;
+}
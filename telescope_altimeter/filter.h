@@ -0,0 +1,130 @@
+/*
+ * Altitude filter for Telescope Altimeter
+ * Smooths the calibrated altitude, optionally fusing the gyro rate about
+ * the tilt axis (complementary filter with rest-time bias estimation) or
+ * adapting the smoothing to the slew speed (One-Euro filter)
+ */
+
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Filter selection (set ALTITUDE_FILTER in config.h)
+#define FILTER_EMA 0
+#define FILTER_COMPLEMENTARY 1
+#define FILTER_ONE_EURO 2
+
+// Smoothing policies (Smoothing in pipeline.h picks one by ALTITUDE_FILTER):
+// one step after warm-up, from the accelerometer altitude and the gyro rate
+// about the tilt axis with the bias removed. usesGyro policies also track
+// the bias and rest state.
+template <int Filter>
+struct SmoothingPolicy;
+
+template <>
+struct SmoothingPolicy<FILTER_EMA> {
+  static constexpr const char* name = "EMA";
+  static constexpr bool usesGyro = false;
+
+  static float step(float altitude, float accelAngle, float rate, float dt, float& speed) {
+    (void)rate;
+    (void)dt;
+    (void)speed;
+    return ALPHA * accelAngle + (1.0 - ALPHA) * altitude;
+  }
+};
+
+template <>
+struct SmoothingPolicy<FILTER_COMPLEMENTARY> {
+  static constexpr const char* name = "complementary";
+  static constexpr bool usesGyro = true;
+
+  static float step(float altitude, float accelAngle, float rate, float dt, float& speed) {
+    (void)speed;
+
+    // The accel mean describes the middle of the batch; project it to the end
+    float accelNow = accelAngle + rate * dt * 0.5;
+
+    // Gyro carries the motion with no lag; the accelerometer slowly pulls out drift
+    float k = COMPLEMENTARY_TAU / (COMPLEMENTARY_TAU + dt);
+    return k * (altitude + rate * dt) + (1.0 - k) * accelNow;
+  }
+};
+
+template <>
+struct SmoothingPolicy<FILTER_ONE_EURO> {
+  static constexpr const char* name = "One-Euro";
+  static constexpr bool usesGyro = true;
+
+  static float step(float altitude, float accelAngle, float rate, float dt, float& speed) {
+    // Slew speed from the gyro (no differentiation noise), itself smoothed
+    speed += lowPassAlpha(ONE_EURO_DCUTOFF_HZ, dt) * (fabs(rate) - speed);
+
+    // Cutoff rises with speed: heavy smoothing at rest, little lag while slewing
+    float cutoff = ONE_EURO_MIN_CUTOFF_HZ + ONE_EURO_BETA * speed;
+    return altitude + lowPassAlpha(cutoff, dt) * (accelAngle - altitude);
+  }
+
+  // Smoothing factor of a first-order low-pass with the given cutoff
+  static float lowPassAlpha(float cutoffHz, float dt) {
+    float tau = 1.0 / (2.0 * PI * cutoffHz);
+    return dt / (dt + tau);
+  }
+};
+
+// Everything update() depends on, so a flash trace can resume the filter
+// exactly where the device had it (recorder.h)
+struct AltitudeFilterState {
+  uint8_t state;
+  uint8_t warmupCount;
+  bool biasKnown;
+  bool atRest;
+  float altitude;
+  float lastAccelAngle;
+  float gyroBias;
+  float speed;
+};
+
+class AltitudeFilter {
+public:
+  // WARMUP averages the first FILTER_WARMUP_BATCHES readings before any
+  // smoothing starts, so no particular reading (e.g. exactly level) is special
+  enum State {
+    WARMUP,
+    TRACKING
+  };
+
+  AltitudeFilter();
+
+  // Forget the estimate and warm up again from the next readings
+  void reset();
+
+  // Feed one batch: mean accelerometer altitude (deg), mean gyro rate about
+  // the tilt axis (deg/s) and the time the batch covers (s)
+  float update(float accelAngle, float gyroRate, float dt);
+
+  float getAltitude() const { return altitude; }
+  float getGyroBias() const { return gyroBias; }
+  bool isAtRest() const { return atRest; }
+  bool isWarmingUp() const { return state == WARMUP; }
+
+  void getState(AltitudeFilterState& saved) const;
+  void setState(const AltitudeFilterState& saved);
+
+private:
+  void warmUp(float accelAngle, float gyroRate);
+  void trackBias(float accelAngle, float gyroRate, float dt);
+
+  State state;
+  int warmupCount;
+  float altitude;
+  float lastAccelAngle;
+  float gyroBias;
+  bool biasKnown;
+  bool atRest;
+  float speed;  // One-Euro: smoothed |angular velocity| (deg/s)
+};
+
+#endif // FILTER_H
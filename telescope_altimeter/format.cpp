@@ -0,0 +1,65 @@
+/*
+ * Integer-only number formatting implementation for Telescope Altimeter
+ */
+
+#include "format.h"
+
+int formatUnsigned(char* out, uint32_t value, uint8_t minDigits) {
+  // Digits come out least significant first
+  char digits[10];
+  int count = 0;
+  do {
+    digits[count++] = '0' + value % 10;
+    value /= 10;
+  } while (value > 0);
+
+  while (count < minDigits && count < (int)sizeof(digits)) {
+    digits[count++] = '0';
+  }
+
+  for (int i = 0; i < count; i++) {
+    out[i] = digits[count - 1 - i];
+  }
+  out[count] = '\0';
+  return count;
+}
+
+int formatSigned(char* out, int32_t value) {
+  if (value < 0) {
+    out[0] = '-';
+    // Unsigned negation is defined for INT32_MIN too
+    return 1 + formatUnsigned(out + 1, 0u - (uint32_t)value);
+  }
+  return formatUnsigned(out, (uint32_t)value);
+}
+
+int formatTenths(char* out, int32_t tenths) {
+  int length = 0;
+  uint32_t magnitude = (uint32_t)tenths;
+  if (tenths < 0) {
+    out[length++] = '-';
+    magnitude = 0u - magnitude;
+  }
+
+  length += formatUnsigned(out + length, magnitude / 10);
+  out[length++] = '.';
+  out[length++] = '0' + magnitude % 10;
+  out[length] = '\0';
+  return length;
+}
+
+int formatDegreesTenths(char* out, float degrees) {
+  // Round half away from zero, so -0.04 becomes 0 and loses its sign
+  float scaled = degrees * 10.0f;
+  int32_t tenths = (int32_t)(scaled < 0.0f ? scaled - 0.5f : scaled + 0.5f);
+  return formatTenths(out, tenths);
+}
+
+void splitArcminutes(float degrees, bool& negative, uint16_t& wholeDegrees, uint8_t& minutes) {
+  bool below = degrees < 0.0f;
+  uint32_t arcminutes = (uint32_t)((below ? -degrees : degrees) * 60.0f);
+
+  wholeDegrees = arcminutes / 60;
+  minutes = arcminutes % 60;
+  negative = below && arcminutes > 0;
+}
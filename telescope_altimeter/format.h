@@ -0,0 +1,33 @@
+/*
+ * Integer-only number formatting for Telescope Altimeter
+ * Replaces snprintf and Print::print(float) on the display path; the
+ * ESP8266 has no FPU and its printf float support is large and slow
+ */
+
+#ifndef FORMAT_H
+#define FORMAT_H
+
+#include <stdint.h>
+
+// Longest output of any formatter here, including the terminator
+#define FORMAT_BUFFER_SIZE 16
+
+// Each formatter writes a NUL-terminated string and returns its length
+
+// Decimal digits, zero-padded to at least minDigits
+int formatUnsigned(char* out, uint32_t value, uint8_t minDigits = 1);
+
+// Decimal with a leading '-' for negative values
+int formatSigned(char* out, int32_t value);
+
+// Tenths as "-12.3"; the sign is dropped when the value rounds to zero
+int formatTenths(char* out, int32_t tenths);
+
+// Degrees to the nearest tenth, as formatTenths
+int formatDegreesTenths(char* out, float degrees);
+
+// Split an angle into sign, whole degrees and whole arcminutes (truncated).
+// negative is only set when the result is not 0 deg 00'.
+void splitArcminutes(float degrees, bool& negative, uint16_t& wholeDegrees, uint8_t& minutes);
+
+#endif // FORMAT_H
@@ -0,0 +1,116 @@
+/*
+ * Calibration journal implementation for Telescope Altimeter
+ */
+
+#include "journal.h"
+#include "config.h"
+#include <EEPROM.h>
+
+static_assert(sizeof(JournalHeader) == JOURNAL_HEADER_SIZE, "journal header layout");
+static_assert(JOURNAL_BASE_ADDR + JOURNAL_SLOTS * JOURNAL_SLOT_SIZE <= EEPROM_SIZE, "journal exceeds EEPROM");
+
+uint16_t crc16(const uint8_t* data, size_t length, uint16_t crc) {
+  for (size_t i = 0; i < length; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+static uint16_t recordCrc(JournalHeader header, const uint8_t* payload) {
+  header.crc = 0;
+  uint16_t crc = crc16((const uint8_t*)&header, sizeof(header));
+  return crc16(payload, header.length, crc);
+}
+
+CalibrationJournal::CalibrationJournal()
+  : newestSlot(-1), newestSequence(0), corruptSlots(0), pending(false) {
+}
+
+bool CalibrationJournal::readSlot(int slot, JournalHeader& header, uint8_t* payload) {
+  int address = slotAddress(slot);
+  EEPROM.get(address, header);
+
+  if (header.magic != JOURNAL_MAGIC) {
+    return false;  // Never written (or erased)
+  }
+
+  if (header.length > JOURNAL_MAX_PAYLOAD) {
+    corruptSlots++;
+    return false;
+  }
+
+  for (uint8_t i = 0; i < header.length; i++) {
+    payload[i] = EEPROM.read(address + JOURNAL_HEADER_SIZE + i);
+  }
+
+  if (recordCrc(header, payload) != header.crc) {
+    corruptSlots++;
+    return false;
+  }
+  return true;
+}
+
+bool CalibrationJournal::load(void* payload, uint8_t maxLength, uint8_t& version, uint8_t& length) {
+  newestSlot = -1;
+  newestSequence = 0;
+  corruptSlots = 0;
+
+  uint8_t buffer[JOURNAL_MAX_PAYLOAD];
+  JournalHeader header;
+
+  for (int slot = 0; slot < JOURNAL_SLOTS; slot++) {
+    if (!readSlot(slot, header, buffer)) {
+      continue;
+    }
+
+    // Signed difference keeps the comparison valid across a sequence wrap
+    if (newestSlot < 0 || (int32_t)(header.sequence - newestSequence) > 0) {
+      newestSlot = slot;
+      newestSequence = header.sequence;
+      version = header.version;
+      length = min(header.length, maxLength);
+      memcpy(payload, buffer, length);
+    }
+  }
+
+  return newestSlot >= 0;
+}
+
+void CalibrationJournal::append(const void* payload, uint8_t length, uint8_t version) {
+  if (length > JOURNAL_MAX_PAYLOAD) {
+    return;
+  }
+
+  // Round-robin: every slot takes its turn, and the previous record survives
+  // intact until the new one has been written
+  int slot = newestSlot < 0 ? 0 : (newestSlot + 1) % JOURNAL_SLOTS;
+
+  JournalHeader header;
+  header.magic = JOURNAL_MAGIC;
+  header.version = version;
+  header.length = length;
+  header.sequence = newestSlot < 0 ? 1 : newestSequence + 1;
+  header.reserved = 0;
+  header.crc = recordCrc(header, (const uint8_t*)payload);
+
+  int address = slotAddress(slot);
+  EEPROM.put(address, header);
+  for (uint8_t i = 0; i < length; i++) {
+    EEPROM.write(address + JOURNAL_HEADER_SIZE + i, ((const uint8_t*)payload)[i]);
+  }
+
+  newestSlot = slot;
+  newestSequence = header.sequence;
+  pending = true;
+}
+
+bool CalibrationJournal::commit() {
+  if (!pending) {
+    return true;
+  }
+  pending = !EEPROM.commit();
+  return !pending;
+}
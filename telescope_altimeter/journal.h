@@ -0,0 +1,58 @@
+/*
+ * Calibration journal for Telescope Altimeter
+ * Append-only, CRC-checked records spread round-robin over EEPROM slots.
+ * The newest valid record wins; a corrupted one falls back to the record
+ * before it. Writes only touch the RAM image - commit() flushes to flash.
+ */
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <Arduino.h>
+#include "config.h"
+
+#define JOURNAL_MAGIC 0xCA1B
+#define JOURNAL_HEADER_SIZE 12
+#define JOURNAL_MAX_PAYLOAD (JOURNAL_SLOT_SIZE - JOURNAL_HEADER_SIZE)
+
+// Record header as stored at the start of each slot
+struct JournalHeader {
+  uint16_t magic;
+  uint8_t version;     // Payload layout version
+  uint8_t length;      // Payload bytes
+  uint32_t sequence;   // Increases by one per record; newest wins
+  uint16_t crc;        // CRC-16/CCITT over header (crc = 0) and payload
+  uint16_t reserved;
+};
+
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
+uint16_t crc16(const uint8_t* data, size_t length, uint16_t crc = 0xFFFF);
+
+class CalibrationJournal {
+public:
+  CalibrationJournal();
+
+  // Scan the slots for the newest valid record. Returns false if none.
+  bool load(void* payload, uint8_t maxLength, uint8_t& version, uint8_t& length);
+
+  // Write a record to the slot after the newest one (RAM image only)
+  void append(const void* payload, uint8_t length, uint8_t version);
+
+  // Flush pending records to flash (erases and rewrites the sector)
+  bool commit();
+  bool hasPendingCommit() const { return pending; }
+
+  // Records rejected by the last load() (bad CRC or header)
+  uint8_t getCorruptSlots() const { return corruptSlots; }
+
+private:
+  int newestSlot;         // -1 when the journal is empty
+  uint32_t newestSequence;
+  uint8_t corruptSlots;
+  bool pending;
+
+  static int slotAddress(int slot) { return JOURNAL_BASE_ADDR + slot * JOURNAL_SLOT_SIZE; }
+  bool readSlot(int slot, JournalHeader& header, uint8_t* payload);
+};
+
+#endif // JOURNAL_H
@@ -0,0 +1,145 @@
+/*
+ * LX200 protocol server implementation for Telescope Altimeter
+ */
+
+#include "lx200.h"
+#include "config.h"
+#include "format.h"
+
+#define LX200_ACK 0x06
+
+int lx200FormatAngle(char* out, int32_t arcseconds, bool isSigned, bool highPrecision) {
+  int length = 0;
+  uint32_t magnitude = (uint32_t)arcseconds;
+  if (isSigned) {
+    bool negative = arcseconds < 0;
+    out[length++] = negative ? '-' : '+';
+    if (negative) {
+      magnitude = 0u - magnitude;
+    }
+  }
+
+  if (!highPrecision) {
+    magnitude = (magnitude + 30) / 60 * 60;
+  }
+
+  uint32_t minutes = magnitude / 60;
+  length += formatUnsigned(out + length, minutes / 60, isSigned ? 2 : 3);
+  out[length++] = '*';
+  length += formatUnsigned(out + length, minutes % 60, 2);
+  if (highPrecision) {
+    out[length++] = '\'';
+    length += formatUnsigned(out + length, magnitude % 60, 2);
+  }
+  out[length++] = '#';
+  out[length] = '\0';
+  return length;
+}
+
+Lx200Server::Lx200Server(Print& port)
+  : port(port),
+    commandLength(0),
+    inCommand(false),
+    highPrecision(LX200_HIGH_PRECISION),
+    altitudeArcsec(0),
+    azimuthArcsec(0),
+    queueLength(0),
+    lastCommandMs(0),
+    seenCommand(false),
+    replies(0),
+    dropped(0) {
+}
+
+void Lx200Server::setAltitude(float degrees) {
+  // Clients expect -90..+90
+  float clamped = constrain(degrees, -90.0f, 90.0f);
+  altitudeArcsec = lroundf(clamped * 3600.0f);
+}
+
+void Lx200Server::setAzimuth(float degrees) {
+  // 359*59'59.6" rounds up to 360*00'00
+  azimuthArcsec = lroundf(degrees * 3600.0f) % (360L * 3600);
+}
+
+bool Lx200Server::isActive() const {
+  return seenCommand && millis() - lastCommandMs < LX200_ACTIVE_MS;
+}
+
+bool Lx200Server::feed(char c) {
+  if (inCommand) {
+    if (c == '#') {
+      command[commandLength] = '\0';
+      inCommand = false;
+      execute();
+    } else if (c == ':') {
+      commandLength = 0;  // A new command abandons a partial one
+    } else if (commandLength < LX200_COMMAND_LENGTH) {
+      command[commandLength++] = c;
+    }
+    return true;
+  }
+
+  if (c == ':') {
+    inCommand = true;
+    commandLength = 0;
+    return true;
+  }
+  if (c == LX200_ACK) {
+    lastCommandMs = millis();
+    seenCommand = true;
+    reply("A", 1);
+    return true;
+  }
+
+  // Clients often send a lone '#' to clear the mount's buffer
+  return c == '#';
+}
+
+void Lx200Server::execute() {
+  lastCommandMs = millis();
+  seenCommand = true;
+
+  char text[LX200_REPLY_LENGTH];
+  if (strcmp(command, "GA") == 0) {
+    reply(text, lx200FormatAngle(text, altitudeArcsec, true, highPrecision));
+  } else if (strcmp(command, "GZ") == 0) {
+    reply(text, lx200FormatAngle(text, azimuthArcsec, false, highPrecision));
+  } else if (strcmp(command, "U") == 0) {
+    highPrecision = !highPrecision;
+  } else if (strcmp(command, "GVP") == 0) {
+    reply("Telescope Altimeter#", 20);
+  } else if (strcmp(command, "GVN") == 0) {
+    reply(LX200_VERSION "#", strlen(LX200_VERSION) + 1);
+  }
+}
+
+void Lx200Server::reply(const char* text, int length) {
+  if (queueLength == 0 && port.availableForWrite() >= length) {
+    port.write((const uint8_t*)text, length);
+    replies++;
+    return;
+  }
+
+  // Behind earlier replies, so the client reads them in order
+  if (queueLength + length > LX200_QUEUE_LENGTH) {
+    dropped++;
+    return;
+  }
+  memcpy(queue + queueLength, text, length);
+  queueLength += length;
+  replies++;
+  flush();
+}
+
+void Lx200Server::flush() {
+  int length = port.availableForWrite();
+  if (length > queueLength) {
+    length = queueLength;
+  }
+  if (length <= 0) {
+    return;
+  }
+  port.write((const uint8_t*)queue, length);
+  queueLength -= length;
+  memmove(queue, queue + length, queueLength);
+}
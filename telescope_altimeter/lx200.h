@@ -0,0 +1,87 @@
+/*
+ * LX200 protocol server for Telescope Altimeter
+ * Answers the alt-az subset of the Meade LX200 serial protocol used by
+ * planetarium programs, interleaved with the text commands on Serial:
+ *
+ *   ACK (0x06)  alignment mode         -> "A" (alt-az)
+ *   :GA#        altitude               -> "sDD*MM#" or "sDD*MM'SS#"
+ *   :GZ#        azimuth                -> "DDD*MM#" or "DDD*MM'SS#" (000*00 while the encoder is uncalibrated)
+ *   :U#         toggle precision       -> (no reply)
+ *   :GVP#       product name           -> "Telescope Altimeter#"
+ *   :GVN#       firmware version       -> "2.1#"
+ *
+ * Other commands are consumed without a reply, as on the real mount. The
+ * altitude and azimuth are kept in integer arcseconds, so replies need no
+ * float math.
+ */
+
+#ifndef LX200_H
+#define LX200_H
+
+#include <Arduino.h>
+
+// :GVN# reply (VERSION_STRING without its 'v')
+#define LX200_VERSION "2.1"
+
+// Longest command between ':' and '#'
+#define LX200_COMMAND_LENGTH 8
+
+// Longest reply, including the terminator
+#define LX200_REPLY_LENGTH 24
+
+// Replies waiting for room in the UART (clients wait for each reply, so a
+// few are plenty)
+#define LX200_QUEUE_LENGTH 64
+
+// "sDD*MM#" / "sDD*MM'SS#" for altitude (signed, 2 degree digits) or
+// "DDD*MM#" / "DDD*MM'SS#" for azimuth (3 digits). Low precision rounds to
+// the nearest arcminute. Returns the length.
+int lx200FormatAngle(char* out, int32_t arcseconds, bool isSigned, bool highPrecision);
+
+class Lx200Server {
+public:
+  Lx200Server(Print& port);
+
+  // Latest filtered altitude (degrees), converted once per filter batch
+  void setAltitude(float degrees);
+
+  // Latest azimuth (degrees, 0-360)
+  void setAzimuth(float degrees);
+
+  // Offer one byte received outside a text command; returns true when it
+  // belongs to the protocol (and was consumed)
+  bool feed(char c);
+
+  // Write queued replies the UART now has room for (call with each Serial
+  // read)
+  void flush();
+
+  // A command arrived within the last LX200_ACTIVE_MS: a client is polling
+  bool isActive() const;
+
+  unsigned long getReplies() const { return replies; }
+  unsigned long getDropped() const { return dropped; }
+
+private:
+  void execute();
+
+  // Write a whole reply, or queue it behind the earlier ones if the UART
+  // cannot take it without blocking (dropped and counted if the queue is full)
+  void reply(const char* text, int length);
+
+  Print& port;
+  char command[LX200_COMMAND_LENGTH + 1];
+  int commandLength;
+  bool inCommand;
+  bool highPrecision;
+  int32_t altitudeArcsec;
+  int32_t azimuthArcsec;
+  char queue[LX200_QUEUE_LENGTH];
+  int queueLength;
+  unsigned long lastCommandMs;
+  bool seenCommand;
+  unsigned long replies;
+  unsigned long dropped;
+};
+
+#endif // LX200_H
@@ -0,0 +1,36 @@
+/*
+ * Compile-time pipeline configuration for Telescope Altimeter - boot report
+ */
+
+#include "pipeline.h"
+#include "display.h"
+
+void printPipeline(Print& out) {
+  out.print("Sensor: +-");
+  out.print(AccelScale::rangeG);
+  out.print(" g (");
+  out.print(AccelScale::lsbPerG, 0);
+  out.print(" LSB/g), +-");
+  out.print(GyroScale::rangeDps);
+  out.print(" dps (");
+  out.print(GyroScale::lsbPerDps, 1);
+  out.print(" LSB/dps), DLPF ");
+  out.print(SensorLowPass::bandwidthHz);
+  out.print(" Hz, ");
+  out.print(FifoClock::rateHz);
+  out.print(" Hz");
+  if (DECIMATION_RATIO > 1) {
+    out.print(" / ");
+    out.print(DECIMATION_RATIO);
+  }
+  out.println();
+
+  out.print("Pipeline: ");
+  out.print(AngleKernel::name);
+  out.print(" kernel, ");
+  out.print(Smoothing::name);
+  out.print(" filter, ");
+  out.print(DisplayBuffer::name);
+  out.print(" display buffer");
+  out.println(DISPLAY_SPRITES ? " with sprites" : "");
+}
@@ -0,0 +1,104 @@
+/*
+ * Compile-time pipeline configuration for Telescope Altimeter
+ * Turns the sensor, angle kernel and filter choices in config.h into policy
+ * types: scale factors, the sample-rate divider and the sample period are
+ * constants of those types, only the selected kernel and filter step are
+ * compiled in, and combinations that cannot work fail to build. (The
+ * display buffer's policy lives in display.h.)
+ */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <Arduino.h>
+#include <MPU6050.h>
+#include "config.h"
+#include "angle_kernel.h"
+#include "filter.h"
+
+// ==================== SENSOR POLICIES ====================
+
+// Accelerometer full scale (MPU6050_ACCEL_FS_*): 16384 LSB/g at +-2 g,
+// halving with each step up
+template <uint8_t Range>
+struct AccelRange {
+  static_assert(Range <= MPU6050_ACCEL_FS_16, "Unknown ACCEL_RANGE");
+
+  static constexpr uint8_t setting = Range;
+  static constexpr uint8_t rangeG = 2 << Range;
+  static constexpr float lsbPerG = 16384.0f / (1 << Range);
+  static constexpr float gPerLsb = 1.0f / lsbPerG;
+
+  // Altitude step of one count with gravity in the tilt plane (1/lsbPerG rad)
+  static constexpr float arcminPerLsb = 3437.747f / lsbPerG;
+};
+
+// Gyro full scale (MPU6050_GYRO_FS_*): 131 LSB/(deg/s) at +-250 dps,
+// halving with each step up
+template <uint8_t Range>
+struct GyroRange {
+  static_assert(Range <= MPU6050_GYRO_FS_2000, "Unknown GYRO_RANGE");
+
+  static constexpr uint8_t setting = Range;
+  static constexpr uint16_t rangeDps = 250 << Range;
+  static constexpr float lsbPerDps = 131.0f / (1 << Range);
+  static constexpr float dpsPerLsb = 1.0f / lsbPerDps;
+};
+
+// Digital low-pass (MPU6050_DLPF_BW_*): gyro bandwidth, and the gyro output
+// rate the sample-rate divider counts down from (8 kHz with the DLPF off)
+template <uint8_t Mode>
+struct LowPass {
+  static_assert(Mode <= MPU6050_DLPF_BW_5, "Unknown MPU_DLPF_MODE");
+
+  static constexpr uint8_t setting = Mode;
+  static constexpr uint16_t bandwidthHz =
+      Mode == MPU6050_DLPF_BW_256 ? 256 : Mode == MPU6050_DLPF_BW_188 ? 188 :
+      Mode == MPU6050_DLPF_BW_98 ? 98 : Mode == MPU6050_DLPF_BW_42 ? 42 :
+      Mode == MPU6050_DLPF_BW_20 ? 20 : Mode == MPU6050_DLPF_BW_10 ? 10 : 5;
+  static constexpr uint16_t gyroOutputHz = Mode == MPU6050_DLPF_BW_256 ? 8000 : 1000;
+};
+
+// FIFO sample clock: the divider that gives RateHz from the DLPF's output rate
+template <class Dlpf, uint16_t RateHz>
+struct SampleClock {
+  static_assert(RateHz > 0 && RateHz <= 1000, "The accelerometer only updates at 1 kHz");
+  static_assert(Dlpf::gyroOutputHz % RateHz == 0 && Dlpf::gyroOutputHz / RateHz <= 256,
+                "FIFO_SAMPLE_RATE_HZ is not the gyro output rate over a whole divider");
+  static_assert(2 * Dlpf::bandwidthHz <= RateHz,
+                "MPU_DLPF_MODE passes noise above half FIFO_SAMPLE_RATE_HZ (aliasing)");
+
+  static constexpr uint16_t rateHz = RateHz;
+  static constexpr uint8_t divider = Dlpf::gyroOutputHz / RateHz - 1;
+  static constexpr uint32_t periodUs = 1000000UL / RateHz;
+};
+
+// ==================== SELECTED PIPELINE ====================
+
+typedef AccelRange<ACCEL_RANGE> AccelScale;
+typedef GyroRange<GYRO_RANGE> GyroScale;
+typedef LowPass<MPU_DLPF_MODE> SensorLowPass;
+typedef SampleClock<SensorLowPass, FIFO_SAMPLE_RATE_HZ> FifoClock;
+typedef AngleKernelPolicy<ANGLE_KERNEL> AngleKernel;
+typedef SmoothingPolicy<ALTITUDE_FILTER> Smoothing;
+
+// ==================== CONSISTENCY ====================
+
+// Samples per sensor task run (at most, before decimation)
+#define PIPELINE_SAMPLES_PER_DRAIN (FIFO_SAMPLE_RATE_HZ * SENSOR_TASK_PERIOD_MS / 1000)
+
+static_assert(AccelScale::arcminPerLsb <= 1.0f,
+              "ACCEL_RANGE too coarse: one count is more than the display's 1 arcminute");
+static_assert(FIFO_SAMPLE_RATE_HZ % DECIMATION_RATIO == 0,
+              "DECIMATION_RATIO must divide FIFO_SAMPLE_RATE_HZ");
+static_assert(PIPELINE_SAMPLES_PER_DRAIN * 12 <= 1024,
+              "A sensor period of samples overflows the 1 KB MPU6050 FIFO");
+static_assert(PIPELINE_SAMPLES_PER_DRAIN <= DATA_READY_QUEUE_SIZE,
+              "A sensor period of data-ready stamps overruns DATA_READY_QUEUE_SIZE");
+static_assert(ALTITUDE_FILTER != FILTER_EMA || (ALPHA > 0.0 && ALPHA <= 1.0),
+              "ALPHA must be in (0, 1]");
+
+// One line per choice: ranges, DLPF and rate, kernel, filter, display buffer
+void printPipeline(Print& out);
+
+#endif // PIPELINE_H
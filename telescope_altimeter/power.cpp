@@ -0,0 +1,259 @@
+/*
+ * Motion-aware power management implementation for Telescope Altimeter
+ */
+
+#include "power.h"
+#include "config.h"
+
+extern "C" {
+#include <user_interface.h>
+#include <gpio.h>
+}
+
+static const char* const powerModeNames[POWER_MODE_COUNT] = {"MOVING", "STILL", "IDLE"};
+
+// RTC time of the last light-sleep wake-up, set by the SDK callback
+static volatile uint32_t wakeRtc = 0;
+
+static void onLightSleepWake() {
+  wakeRtc = system_get_rtc_time();
+}
+
+const char* powerModeName(PowerMode mode) {
+  return powerModeNames[mode];
+}
+
+bool MotionDetector::update(float angle, float tiltRate) {
+  bool moving = fabsf(tiltRate) > MOTION_RATE_THRESHOLD_DPS ||
+                (hasRestAngle() && fabsf(angle - getRestAngle()) > MOTION_ANGLE_THRESHOLD_DEG);
+
+  // The rest position is re-learned from here on
+  if (moving) {
+    rest.reset();
+  }
+  rest.add(angle);
+  return moving;
+}
+
+PowerManager::PowerManager(TelescopeSensor& sensor)
+  : sensor(sensor),
+    enabled(POWER_SAVING),
+    mode(POWER_MOVING),
+    previousMode(POWER_MOVING),
+    lastActiveMs(0),
+    idleAngleSum(0.0),
+    idleSamples(0),
+    idleCycles(0),
+    rtcCali(1 << 12),
+    lastRtc(0),
+    modeUs{},
+    asleepUs(0),
+    wakes(0),
+    motionWakes(0) {
+}
+
+void PowerManager::begin() {
+  // The radio is never used. Leave any forced modem sleep the core started
+  // (WiFi off at boot) - light sleep is requested through the same API.
+  wifi_fpm_do_wakeup();
+  wifi_fpm_close();
+  wifi_set_opmode_current(NULL_MODE);
+
+  rtcCali = system_rtc_clock_cali_proc();
+  lastRtc = system_get_rtc_time();
+  lastActiveMs = millis();
+}
+
+void PowerManager::setEnabled(bool on) {
+  // Turning it off while idle takes effect at the next wake-up
+  enabled = on;
+}
+
+void PowerManager::account() {
+  uint32_t now = system_get_rtc_time();
+  modeUs[mode] += ((uint64_t)(now - lastRtc) * rtcCali) >> 12;
+  lastRtc = now;
+}
+
+bool PowerManager::setMode(PowerMode next) {
+  account();
+
+  if (next == POWER_IDLE) {
+    sensor.enterLowPower();
+    idleAngleSum = 0.0;
+    idleSamples = 0;
+    idleCycles = 0;
+  } else if (mode == POWER_IDLE) {
+    sensor.exitLowPower();
+    detector.reset();
+    lastActiveMs = millis();
+  }
+
+  previousMode = mode;
+  mode = next;
+  return true;
+}
+
+bool PowerManager::update(float angle, float tiltRate, bool busy) {
+  account();
+  if (mode == POWER_IDLE) {
+    return false;  // Left through onWake()
+  }
+
+  unsigned long now = millis();
+  if (detector.update(angle, tiltRate) || busy) {
+    lastActiveMs = now;
+    return mode != POWER_MOVING && setMode(POWER_MOVING);
+  }
+
+  unsigned long restMs = now - lastActiveMs;
+  if (mode == POWER_MOVING && restMs >= MOTION_HOLD_MS) {
+    return setMode(POWER_STILL);
+  }
+  // Only the INT level wakes light sleep: without working data-ready
+  // interrupts (INT not wired) the tube could never wake it by moving
+  if (mode == POWER_STILL && enabled && restMs >= POWER_IDLE_TIMEOUT_MS && sensor.hasDataReadyStamps()) {
+    return setMode(POWER_IDLE);
+  }
+  return false;
+}
+
+void PowerManager::sleep() {
+  account();
+  uint32_t start = lastRtc;
+  wakeRtc = start;
+
+  wifi_fpm_set_sleep_type(LIGHT_SLEEP_T);
+  wifi_fpm_open();
+  gpio_pin_wakeup_enable(GPIO_ID_PIN(MPU_INT_PIN), GPIO_PIN_INTR_HILEVEL);
+  gpio_pin_wakeup_enable(GPIO_ID_PIN(BUTTON_PIN), GPIO_PIN_INTR_LOLEVEL);
+#if AZIMUTH_ENCODER
+  // The first edge of an azimuth turn (phase A leaving its level)
+  gpio_pin_wakeup_enable(GPIO_ID_PIN(AZIMUTH_PIN_A),
+                         digitalRead(AZIMUTH_PIN_A) == HIGH ? GPIO_PIN_INTR_LOLEVEL : GPIO_PIN_INTR_HILEVEL);
+#endif
+  wifi_fpm_set_wakeup_cb(onLightSleepWake);
+  wifi_fpm_do_sleep(FPM_SLEEP_MAX_TIME);
+
+  // The SDK suspends the CPU inside this delay; the delay itself runs on
+  // after the wake-up (millis() stands still while asleep)
+  delay(POWER_SLEEP_ENTRY_MS);
+
+  gpio_pin_wakeup_disable();
+  wifi_fpm_close();
+
+  asleepUs += ((uint64_t)(wakeRtc - start) * rtcCali) >> 12;
+  wakes++;
+}
+
+bool PowerManager::onWake(uint8_t events, float angle, bool userActive) {
+  if (mode != POWER_IDLE) {
+    return false;
+  }
+
+  // The motion detector compares consecutive cycle samples; the first one
+  // after entering idle has nothing valid to compare against
+  if (events & SENSOR_EVENT_SAMPLE) {
+    idleCycles++;
+  }
+  if ((events & SENSOR_EVENT_MOTION) && idleCycles > POWER_IDLE_SETTLE_SAMPLES) {
+    motionWakes++;
+    return setMode(POWER_MOVING);
+  }
+  if (userActive) {
+    return setMode(POWER_MOVING);
+  }
+  if (!enabled) {
+    return setMode(POWER_STILL);
+  }
+
+  if (events & SENSOR_EVENT_SAMPLE) {
+    // A slew too smooth for the motion interrupt still moves a single
+    // sample well away from the rest position
+    if (detector.hasRestAngle() && fabsf(angle - detector.getRestAngle()) > POWER_WAKE_ANGLE_DEG) {
+      return setMode(POWER_MOVING);
+    }
+
+    // Slow drift stays under the motion interrupt; compare block means
+    // with the rest position instead (single samples are too noisy)
+    idleAngleSum += angle;
+    idleSamples++;
+    if (idleSamples >= POWER_IDLE_BLOCK_SAMPLES) {
+      float mean = idleAngleSum / idleSamples;
+      idleAngleSum = 0.0;
+      idleSamples = 0;
+      if (!detector.hasRestAngle() || fabsf(mean - detector.getRestAngle()) > MOTION_ANGLE_THRESHOLD_DEG) {
+        return setMode(POWER_STILL);
+      }
+    }
+  }
+  return false;
+}
+
+void PowerManager::getStats(PowerStats& stats) {
+  account();
+
+  uint64_t totalUs = 0;
+  for (int i = 0; i < POWER_MODE_COUNT; i++) {
+    stats.modeMs[i] = modeUs[i] / 1000;
+    totalUs += modeUs[i];
+  }
+  stats.asleepMs = asleepUs / 1000;
+  stats.wakes = wakes;
+  stats.motionWakes = motionWakes;
+
+  // Charge per mode: full sensor and CPU while moving or still; cycle-mode
+  // sensor while idle, with the CPU awake only between wake-up and sleep
+  const float awakeMa = POWER_ESP_AWAKE_MA + POWER_MPU_ACTIVE_MA;
+  uint64_t asleep = asleepUs < modeUs[POWER_IDLE] ? asleepUs : modeUs[POWER_IDLE];
+  float charge = (float)(modeUs[POWER_MOVING] + modeUs[POWER_STILL]) * awakeMa +
+                 (float)(modeUs[POWER_IDLE] - asleep) * (POWER_ESP_AWAKE_MA + POWER_MPU_CYCLE_MA) +
+                 (float)asleep * (POWER_ESP_LIGHT_SLEEP_MA + POWER_MPU_CYCLE_MA);
+
+  stats.alwaysOnMilliamps = awakeMa;
+  stats.averageMilliamps = totalUs > 0 ? charge / totalUs : awakeMa;
+  stats.savingPercent = 100.0 * (1.0 - stats.averageMilliamps / awakeMa);
+}
+
+void PowerManager::printStats(Print& out) {
+  PowerStats stats;
+  getStats(stats);
+
+  out.print("Power: ");
+  out.print(powerModeName(mode));
+  if (!enabled) {
+    out.println(" (idle off)");
+  } else {
+    out.println(sensor.hasDataReadyStamps() ? " (idle allowed)" : " (idle needs the MPU6050 INT line)");
+  }
+  out.print("  moving ");
+  out.print(stats.modeMs[POWER_MOVING] / 1000.0, 1);
+  out.print(" s, still ");
+  out.print(stats.modeMs[POWER_STILL] / 1000.0, 1);
+  out.print(" s, idle ");
+  out.print(stats.modeMs[POWER_IDLE] / 1000.0, 1);
+  out.print(" s (");
+  out.print(stats.asleepMs / 1000.0, 1);
+  out.print(" s asleep, ");
+  out.print(stats.wakes);
+  out.print(" wakes, ");
+  out.print(stats.motionWakes);
+  out.println(" on motion)");
+  out.print("  Estimated ");
+  out.print(stats.averageMilliamps, 2);
+  out.print(" mA vs ");
+  out.print(stats.alwaysOnMilliamps, 1);
+  out.print(" mA always on (");
+  out.print(stats.savingPercent, 0);
+  out.println("% saved, OLED not included)");
+}
+
+void PowerManager::resetStats() {
+  account();
+  for (int i = 0; i < POWER_MODE_COUNT; i++) {
+    modeUs[i] = 0;
+  }
+  asleepUs = 0;
+  wakes = 0;
+  motionWakes = 0;
+}
@@ -0,0 +1,114 @@
+/*
+ * Motion-aware power management for Telescope Altimeter
+ * Classifies the sample stream as moving or at rest, slows the display
+ * refresh at rest, and after a while idles with the MPU6050 in cycle mode
+ * and the ESP8266 in light sleep until motion wakes it
+ */
+
+#ifndef POWER_H
+#define POWER_H
+
+#include <Arduino.h>
+#include "sensor.h"
+#include "estimator.h"
+
+enum PowerMode {
+  POWER_MOVING,  // Slewing (or the UI is busy): full refresh rate
+  POWER_STILL,   // At rest: slow refresh
+  POWER_IDLE     // Sensor in cycle mode, CPU asleep between its samples
+};
+
+#define POWER_MODE_COUNT 3
+
+const char* powerModeName(PowerMode mode);
+
+// Time spent in each mode and the current it implies (RTC-measured, so
+// light sleep counts too)
+struct PowerStats {
+  uint32_t modeMs[POWER_MODE_COUNT];
+  uint32_t asleepMs;         // Part of the idle time spent in light sleep
+  uint32_t wakes;            // Light-sleep wake-ups
+  uint32_t motionWakes;      // ...of which by the motion interrupt
+  float averageMilliamps;    // ESP8266 + MPU6050 estimate (POWER_*_MA)
+  float alwaysOnMilliamps;   // Same without power management
+  float savingPercent;
+};
+
+// Motion test on filter batches: tilt rate above MOTION_RATE_THRESHOLD_DPS,
+// or a drift of MOTION_ANGLE_THRESHOLD_DEG from the mean position since the
+// tube came to rest
+class MotionDetector {
+public:
+  void reset() { rest.reset(); }
+
+  // Feed one batch: mean raw angle (deg) and bias-corrected tilt rate (deg/s);
+  // returns true when it shows motion
+  bool update(float angle, float tiltRate);
+
+  bool hasRestAngle() const { return rest.getCount() > 0; }
+  float getRestAngle() const { return rest.getMean(); }
+
+private:
+  Welford rest;  // Batches since the last motion
+};
+
+class PowerManager {
+public:
+  PowerManager(TelescopeSensor& sensor);
+
+  // Radio off and start accounting
+  void begin();
+
+  // Allow idling (POWER_SAVING; the "power on/off" command)
+  void setEnabled(bool on);
+  bool isEnabled() const { return enabled; }
+
+  // Feed one filter batch. busy (a menu, overlay or pending flash commit)
+  // counts as motion. Returns true when the mode changed.
+  bool update(float angle, float tiltRate, bool busy);
+
+  // Light sleep until the MPU6050 raises INT, the button is pressed or the
+  // azimuth encoder turns
+  void sleep();
+
+  // Classify a wake-up from sleep(): SENSOR_EVENT_* bits, the raw angle of
+  // the wake-up sample, and whether the user is active (button down or an
+  // LX200 client polling). Returns true when the mode changed (motion or
+  // user -> MOVING, drift -> STILL).
+  bool onWake(uint8_t events, float angle, bool userActive);
+
+  PowerMode getMode() const { return mode; }
+  PowerMode getPreviousMode() const { return previousMode; }
+
+  void getStats(PowerStats& stats);
+  void printStats(Print& out);
+  void resetStats();
+
+private:
+  bool setMode(PowerMode next);
+
+  // Add the RTC time since the last call to the current mode
+  void account();
+
+  TelescopeSensor& sensor;
+  MotionDetector detector;
+  bool enabled;
+  PowerMode mode;
+  PowerMode previousMode;
+  unsigned long lastActiveMs;   // Last batch with motion (or a busy UI)
+
+  // Idle drift check: sum of the current block of wake-up samples
+  float idleAngleSum;
+  uint16_t idleSamples;
+  uint32_t idleCycles;  // Cycle samples since entering idle
+
+  // Accounting (RTC ticks and us)
+  uint32_t rtcCali;  // RTC tick period in us, Q12
+  uint32_t lastRtc;
+  uint64_t modeUs[POWER_MODE_COUNT];
+  uint64_t asleepUs;
+  uint32_t wakes;
+  uint32_t motionWakes;
+};
+
+#endif // POWER_H
@@ -0,0 +1,86 @@
+/*
+ * Hot-path profiler implementation for Telescope Altimeter
+ */
+
+#include "profiler.h"
+
+static LatencyHistogram histograms[PROFILE_STAGE_COUNT];
+
+static const char* const stageNames[PROFILE_STAGE_COUNT] = {
+  "i2c read",
+  "angle",
+  "filter",
+  "render",
+  "send",
+  "button"
+};
+
+LatencyHistogram::LatencyHistogram() {
+  reset();
+}
+
+void LatencyHistogram::reset() {
+  memset(buckets, 0, sizeof(buckets));
+  count = 0;
+  minCycles = 0xFFFFFFFF;
+  maxCycles = 0;
+}
+
+void LatencyHistogram::record(uint32_t cycles) {
+  // Bucket = bit length of the duration, lumping the top two together
+  uint8_t bucket = cycles ? 32 - __builtin_clz(cycles) : 0;
+  if (bucket >= PROFILE_BUCKETS) {
+    bucket = PROFILE_BUCKETS - 1;
+  }
+
+  buckets[bucket]++;
+  count++;
+  if (cycles < minCycles) minCycles = cycles;
+  if (cycles > maxCycles) maxCycles = cycles;
+}
+
+uint32_t LatencyHistogram::percentile(uint8_t percent) const {
+  if (count == 0) {
+    return 0;
+  }
+
+  // Rank of the percentile sample (1-based, rounded up)
+  uint32_t rank = (uint32_t)(((uint64_t)count * percent + 99) / 100);
+  if (rank == 0) {
+    rank = 1;
+  }
+
+  uint32_t seen = 0;
+  for (uint8_t bucket = 0; bucket < PROFILE_BUCKETS; bucket++) {
+    seen += buckets[bucket];
+    if (seen >= rank) {
+      uint32_t upper = bucket >= PROFILE_BUCKETS - 1 ? 0xFFFFFFFF : (1UL << bucket) - 1;
+      return constrain(upper, getMin(), maxCycles);
+    }
+  }
+  return maxCycles;
+}
+
+void profileRecord(ProfileStage stage, uint32_t cycles) {
+  histograms[stage].record(cycles);
+}
+
+void profileReset() {
+  for (int i = 0; i < PROFILE_STAGE_COUNT; i++) {
+    histograms[i].reset();
+  }
+}
+
+void profilePrint(Print& out) {
+  float cyclesPerUs = ESP.getCpuFreqMHz();
+  char line[64];
+
+  out.println("Profile (us):   count      min      p50      p99      max");
+  for (int i = 0; i < PROFILE_STAGE_COUNT; i++) {
+    const LatencyHistogram& h = histograms[i];
+    snprintf(line, sizeof(line), "  %-10s %8lu %8.1f %8.1f %8.1f %8.1f", stageNames[i], (unsigned long)h.getCount(),
+             h.getMin() / cyclesPerUs, h.percentile(50) / cyclesPerUs, h.percentile(99) / cyclesPerUs,
+             h.getMax() / cyclesPerUs);
+    out.println(line);
+  }
+}
@@ -0,0 +1,76 @@
+/*
+ * Hot-path profiler for Telescope Altimeter
+ * Timing probes around each stage of a frame feed fixed-size log2
+ * histograms of CPU cycles; min/p50/p99/max are printed on request
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Bucket b holds durations in [2^(b-1), 2^b) cycles (bucket 0: zero)
+#define PROFILE_BUCKETS 32
+
+// Stages of a frame, in pipeline order
+enum ProfileStage {
+  PROFILE_I2C_READ,   // FIFO burst read
+  PROFILE_ANGLE,      // Angle and tilt-rate kernels for a batch
+  PROFILE_FILTER,     // Calibration and altitude filter
+  PROFILE_RENDER,     // Drawing the frame buffer
+  PROFILE_SEND,       // Dirty-row diff and panel transfer
+  PROFILE_BUTTON,     // Button polling and its actions
+  PROFILE_STAGE_COUNT
+};
+
+class LatencyHistogram {
+public:
+  LatencyHistogram();
+
+  void reset();
+  void record(uint32_t cycles);
+
+  uint32_t getCount() const { return count; }
+  uint32_t getMin() const { return count ? minCycles : 0; }
+  uint32_t getMax() const { return maxCycles; }
+
+  // Upper edge of the bucket holding the given percentile, clamped to the
+  // observed range: never below the true value and at most 2x above it
+  uint32_t percentile(uint8_t percent) const;
+
+private:
+  uint32_t buckets[PROFILE_BUCKETS];
+  uint32_t count;
+  uint32_t minCycles;
+  uint32_t maxCycles;
+};
+
+// Add one measurement to a stage's histogram
+void profileRecord(ProfileStage stage, uint32_t cycles);
+
+// Clear every histogram
+void profileReset();
+
+// Print count and min/p50/p99/max (microseconds) per stage
+void profilePrint(Print& out);
+
+// Times its own lifetime
+class ProfileProbe {
+public:
+  explicit ProfileProbe(ProfileStage stage) : stage(stage), start(ESP.getCycleCount()) {}
+  ~ProfileProbe() { profileRecord(stage, ESP.getCycleCount() - start); }
+
+private:
+  ProfileStage stage;
+  uint32_t start;
+};
+
+// Probe the rest of the enclosing scope (compiles away with PROFILING 0)
+#if PROFILING
+#define PROFILE_SCOPE(stage) ProfileProbe profileProbe(stage)
+#else
+#define PROFILE_SCOPE(stage)
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,703 @@
+/*
+ * Flash trace recorder implementation for Telescope Altimeter
+ */
+
+#include "recorder.h"
+#include "journal.h"
+#include "console.h"
+
+// ==================== ENCODING ====================
+
+static void putU16(uint8_t* p, uint16_t v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+}
+
+static void putU32(uint8_t* p, uint32_t v) {
+  p[0] = v & 0xFF;
+  p[1] = (v >> 8) & 0xFF;
+  p[2] = (v >> 16) & 0xFF;
+  p[3] = v >> 24;
+}
+
+static void putFloat(uint8_t* p, float v) {
+  uint32_t bits;
+  memcpy(&bits, &v, sizeof(bits));
+  putU32(p, bits);
+}
+
+static uint16_t getU16(const uint8_t* p) {
+  return p[0] | (p[1] << 8);
+}
+
+static uint32_t getU32(const uint8_t* p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static float getFloat(const uint8_t* p) {
+  uint32_t bits = getU32(p);
+  float v;
+  memcpy(&v, &bits, sizeof(v));
+  return v;
+}
+
+// Zigzag LEB128: small differences of either sign take one byte
+static size_t putVarint(uint8_t* p, int32_t value) {
+  uint32_t v = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+  size_t n = 0;
+  while (v >= 0x80) {
+    p[n++] = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  p[n++] = (uint8_t)v;
+  return n;
+}
+
+static bool getVarint(const uint8_t*& p, const uint8_t* end, int32_t& value) {
+  uint32_t v = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    if (p >= end) {
+      return false;
+    }
+    uint8_t byte = *p++;
+    v |= (uint32_t)(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      value = (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+      return true;
+    }
+  }
+  return false;
+}
+
+static int16_t channel(const RawSample& raw, int i) {
+  switch (i) {
+    case 0: return raw.ax;
+    case 1: return raw.ay;
+    case 2: return raw.az;
+    case 3: return raw.gx;
+    case 4: return raw.gy;
+    default: return raw.gz;
+  }
+}
+
+static void setChannel(RawSample& raw, int i, int16_t value) {
+  switch (i) {
+    case 0: raw.ax = value; break;
+    case 1: raw.ay = value; break;
+    case 2: raw.az = value; break;
+    case 3: raw.gx = value; break;
+    case 4: raw.gy = value; break;
+    default: raw.gz = value; break;
+  }
+}
+
+size_t traceEncodeSample(uint8_t* out, const TimedSample& sample, const TimedSample& previous,
+                         int32_t previousIntervalUs) {
+  size_t n = 0;
+  out[n++] = TRACE_RECORD_SAMPLE;
+
+  // At a steady rate the interval barely changes: one byte of jitter
+  int32_t interval = (int32_t)(sample.timestampUs - previous.timestampUs);
+  n += putVarint(out + n, interval - previousIntervalUs);
+  for (int i = 0; i < 6; i++) {
+    n += putVarint(out + n, (int32_t)channel(sample.raw, i) - channel(previous.raw, i));
+  }
+  n += putVarint(out + n, sample.azimuthTicks - previous.azimuthTicks);
+  return n;
+}
+
+static size_t encodeKeyframe(uint8_t* out, const TimedSample& sample) {
+  out[0] = TRACE_RECORD_KEYFRAME;
+  putU32(out + 1, sample.timestampUs);
+  putU32(out + 5, (uint32_t)sample.azimuthTicks);
+  for (int i = 0; i < 6; i++) {
+    putU16(out + 9 + 2 * i, (uint16_t)channel(sample.raw, i));
+  }
+  return TRACE_KEYFRAME_BYTES;
+}
+
+static void putCalibration(uint8_t* p, const CalibrationRecord& record) {
+  putFloat(p, record.zeroOffset);
+  putFloat(p + 4, record.stopA_raw);
+  putFloat(p + 8, record.stopB_raw);
+  for (int i = 0; i < 3; i++) {
+    putFloat(p + 12 + 4 * i, record.tubeAxis[i]);
+    putFloat(p + 24 + 4 * i, record.tiltAxis[i]);
+  }
+  putU32(p + 36, record.flags);
+  putU32(p + 40, (uint32_t)record.azimuth.ticksPerRev);
+}
+
+static void getCalibration(const uint8_t* p, CalibrationRecord& record) {
+  record.zeroOffset = getFloat(p);
+  record.stopA_raw = getFloat(p + 4);
+  record.stopB_raw = getFloat(p + 8);
+  for (int i = 0; i < 3; i++) {
+    record.tubeAxis[i] = getFloat(p + 12 + 4 * i);
+    record.tiltAxis[i] = getFloat(p + 24 + 4 * i);
+  }
+  record.flags = getU32(p + 36);
+  record.azimuth.ticksPerRev = (int32_t)getU32(p + 40);
+}
+
+// ==================== DECODING ====================
+
+int traceCheckBlock(const uint8_t* block, uint32_t& sequence) {
+  if (getU16(block) != TRACE_MAGIC || block[2] != TRACE_FORMAT_VERSION) {
+    return -1;
+  }
+  uint16_t length = getU16(block + 4);
+  if (length > TRACE_BLOCK_SIZE - TRACE_HEADER_SIZE) {
+    return -1;
+  }
+
+  uint8_t header[TRACE_HEADER_SIZE];
+  memcpy(header, block, TRACE_HEADER_SIZE);
+  putU16(header + 6, 0);
+  uint16_t crc = crc16(header, TRACE_HEADER_SIZE);
+  crc = crc16(block + TRACE_HEADER_SIZE, length, crc);
+  if (crc != getU16(block + 6)) {
+    return -1;
+  }
+
+  sequence = getU32(block + 8);
+  return length;
+}
+
+TraceBlockReader::TraceBlockReader(const uint8_t* block)
+  : read(block + TRACE_HEADER_SIZE),
+    end(block + TRACE_HEADER_SIZE + getU16(block + 4)),
+    previousIntervalUs(0),
+    haveSample(false) {
+}
+
+bool TraceBlockReader::next(TraceRecord& record) {
+  static const uint8_t fixedBytes[] = {
+    0, TRACE_KEYFRAME_BYTES, 0, TRACE_FILTER_BYTES, TRACE_FILTER_STATE_BYTES, TRACE_SEGMENT_BYTES,
+    TRACE_CALIBRATION_BYTES, TRACE_FILTER_RESET_BYTES, TRACE_BUTTON_BYTES, TRACE_UI_MODE_BYTES,
+    TRACE_POWER_BYTES, TRACE_GAP_BYTES
+  };
+
+  if (read >= end) {
+    return false;
+  }
+  const uint8_t* p = read;
+  uint8_t type = *p;
+  if (type == 0 || type > TRACE_RECORD_GAP) {
+    return false;
+  }
+  if (type != TRACE_RECORD_SAMPLE && end - p < fixedBytes[type]) {
+    return false;
+  }
+  record.type = type;
+
+  switch (type) {
+    case TRACE_RECORD_KEYFRAME:
+      record.sample.timestampUs = getU32(p + 1);
+      record.sample.azimuthTicks = (int32_t)getU32(p + 5);
+      for (int i = 0; i < 6; i++) {
+        setChannel(record.sample.raw, i, (int16_t)getU16(p + 9 + 2 * i));
+      }
+      previousIntervalUs = 0;
+      break;
+
+    case TRACE_RECORD_SAMPLE: {
+      if (!haveSample) {
+        return false;  // Differences need a keyframe first
+      }
+      p++;
+      int32_t delta;
+      if (!getVarint(p, end, delta)) {
+        return false;
+      }
+      int32_t interval = previousIntervalUs + delta;
+      record.sample.timestampUs = previous.timestampUs + (uint32_t)interval;
+      for (int i = 0; i < 6; i++) {
+        if (!getVarint(p, end, delta)) {
+          return false;
+        }
+        setChannel(record.sample.raw, i, (int16_t)(channel(previous.raw, i) + delta));
+      }
+      if (!getVarint(p, end, delta)) {
+        return false;
+      }
+      record.sample.azimuthTicks = previous.azimuthTicks + delta;
+      previousIntervalUs = interval;
+      read = p;
+      break;
+    }
+
+    case TRACE_RECORD_FILTER:
+    case TRACE_RECORD_FILTER_STATE:
+      record.rawAngle = getFloat(p + 1);
+      record.filteredAltitude = getFloat(p + 5);
+      if (type == TRACE_RECORD_FILTER_STATE) {
+        record.filteredSampleUs = getU32(p + 9);
+        record.filter.state = p[13];
+        record.filter.warmupCount = p[14];
+        record.filter.biasKnown = (p[15] & 0x01) != 0;
+        record.filter.atRest = (p[15] & 0x02) != 0;
+        record.filter.altitude = record.filteredAltitude;
+        record.filter.lastAccelAngle = getFloat(p + 16);
+        record.filter.gyroBias = getFloat(p + 20);
+        record.filter.speed = getFloat(p + 24);
+      }
+      break;
+
+    case TRACE_RECORD_SEGMENT:
+      record.timeUs = getU32(p + 1);
+      record.kind = p[5];
+      break;
+
+    case TRACE_RECORD_CALIBRATION:
+      record.timeUs = getU32(p + 1);
+      getCalibration(p + 5, record.calibration);
+      break;
+
+    case TRACE_RECORD_FILTER_RESET:
+      record.timeUs = getU32(p + 1);
+      break;
+
+    case TRACE_RECORD_BUTTON:
+      record.timeUs = getU32(p + 1);
+      record.kind = p[5];
+      record.amount = getU32(p + 6);
+      break;
+
+    case TRACE_RECORD_UI_MODE:
+      record.timeUs = getU32(p + 1);
+      record.kind = p[5];
+      break;
+
+    case TRACE_RECORD_POWER:
+      record.timeUs = getU32(p + 1);
+      record.previous = p[5];
+      record.kind = p[6];
+      break;
+
+    case TRACE_RECORD_GAP:
+      record.amount = getU16(p + 1);
+      break;
+  }
+
+  if (type == TRACE_RECORD_KEYFRAME || type == TRACE_RECORD_SAMPLE) {
+    record.timeUs = record.sample.timestampUs;
+    previous = record.sample;
+    haveSample = true;
+  }
+  if (type != TRACE_RECORD_SAMPLE) {
+    read = p + fixedBytes[type];
+  }
+  return true;
+}
+
+// ==================== RECORDER ====================
+
+TraceRecorder::TraceRecorder(CalibrationManager& calibration)
+  : calibration(calibration),
+    mounted(false),
+    recording(false),
+    sealedHead(0),
+    sealedCount(0),
+    used(0),
+    nextSequence(0),
+    blockSequence(0),
+    filledBlocks(0),
+    sessionStart(false),
+    lastIntervalUs(0),
+    needKeyframe(true),
+    needFilterState(true),
+    gapRecords(0),
+    segment(-1),
+    writtenBlocks(0) {
+  memset(&lastSample, 0, sizeof(lastSample));
+  memset(&stats, 0, sizeof(stats));
+}
+
+void TraceRecorder::segmentPath(char* path, int index) {
+  snprintf(path, 16, "/trace%d.bin", index);
+}
+
+void TraceRecorder::begin() {
+  mounted = LittleFS.begin();
+  if (!mounted) {
+    console.println("Trace: LittleFS mount failed - not recording");
+    return;
+  }
+
+  // The newest segment has the highest first sequence number; the ring
+  // carries on after its last block. staging[0] is free until start().
+  uint8_t* block = staging[0];
+  uint32_t newestFirst = 0;
+  for (int i = 0; i < TRACE_SEGMENTS; i++) {
+    char path[16];
+    segmentPath(path, i);
+    File file = LittleFS.open(path, "r");
+    uint32_t sequence;
+    if (!file || file.read(block, TRACE_BLOCK_SIZE) != TRACE_BLOCK_SIZE || traceCheckBlock(block, sequence) < 0) {
+      continue;
+    }
+    if (segment < 0 || sequence > newestFirst) {
+      segment = i;
+      newestFirst = sequence;
+      nextSequence = sequence + 1;
+
+      size_t blocks = file.size() / TRACE_BLOCK_SIZE;
+      if (blocks > 1 && file.seek((blocks - 1) * TRACE_BLOCK_SIZE) &&
+          file.read(block, TRACE_BLOCK_SIZE) == TRACE_BLOCK_SIZE && traceCheckBlock(block, sequence) >= 0) {
+        nextSequence = sequence + 1;
+      }
+    }
+    file.close();
+  }
+
+#if TRACE_AT_BOOT
+  start();
+#endif
+}
+
+void TraceRecorder::start() {
+  if (!mounted || recording) {
+    return;
+  }
+
+  recording = true;
+  sessionStart = true;
+  filledBlocks = 0;
+  writtenBlocks = TRACE_SEGMENT_BLOCKS;  // The first write opens the next segment
+  used = 0;
+  gapRecords = 0;
+  needKeyframe = true;
+  needFilterState = true;
+}
+
+void TraceRecorder::stop() {
+  if (!recording) {
+    return;
+  }
+  flush();
+  recording = false;
+  segmentFile.close();
+}
+
+void TraceRecorder::flush() {
+  if (used > 0) {
+    seal();
+  }
+  while (sealedCount > 0) {
+    commitPending();
+  }
+}
+
+uint8_t* TraceRecorder::drop() {
+  stats.dropped++;
+  if (gapRecords < 0xFFFF) {
+    gapRecords++;
+  }
+
+  // The replay cannot follow across the hole: start over from full values
+  needKeyframe = true;
+  needFilterState = true;
+  return nullptr;
+}
+
+bool TraceRecorder::startBlock() {
+  if (sealedCount == TRACE_STAGING_BLOCKS) {
+    return false;
+  }
+
+  uint8_t* block = activeBlock();
+  used = TRACE_HEADER_SIZE;
+  blockSequence = nextSequence++;
+  needKeyframe = true;
+  needFilterState = true;
+
+  if (filledBlocks == 0) {
+    // A segment may outlive the ones before it: make it self-contained
+    block[used] = TRACE_RECORD_SEGMENT;
+    putU32(block + used + 1, micros());
+    block[used + 5] = sessionStart ? TRACE_SEGMENT_SESSION : 0;
+    used += TRACE_SEGMENT_BYTES;
+    sessionStart = false;
+
+    CalibrationRecord record;
+    calibration.getRecord(record);
+    block[used] = TRACE_RECORD_CALIBRATION;
+    putU32(block + used + 1, micros());
+    putCalibration(block + used + 5, record);
+    used += TRACE_CALIBRATION_BYTES;
+    stats.records += 2;
+  }
+  filledBlocks = (filledBlocks + 1) % TRACE_SEGMENT_BLOCKS;
+  return true;
+}
+
+void TraceRecorder::seal() {
+  uint8_t* block = activeBlock();
+  uint16_t length = used - TRACE_HEADER_SIZE;
+
+  putU16(block, TRACE_MAGIC);
+  block[2] = TRACE_FORMAT_VERSION;
+  block[3] = 0;
+  putU16(block + 4, length);
+  putU16(block + 6, 0);
+  putU32(block + 8, blockSequence);
+  memset(block + used, 0, TRACE_BLOCK_SIZE - used);
+
+  uint16_t crc = crc16(block, TRACE_HEADER_SIZE);
+  putU16(block + 6, crc16(block + TRACE_HEADER_SIZE, length, crc));
+
+  sealedCount++;
+  used = 0;
+}
+
+uint8_t* TraceRecorder::reserve(size_t length) {
+  if (!recording) {
+    return nullptr;
+  }
+
+  size_t gapBytes = gapRecords > 0 ? TRACE_GAP_BYTES : 0;
+  if (used > 0 && used + gapBytes + length > TRACE_BLOCK_SIZE) {
+    seal();
+  }
+  if (used == 0 && !startBlock()) {
+    return drop();
+  }
+
+  uint8_t* block = activeBlock();
+  if (gapRecords > 0) {
+    block[used] = TRACE_RECORD_GAP;
+    putU16(block + used + 1, gapRecords);
+    used += TRACE_GAP_BYTES;
+    gapRecords = 0;
+  }
+  return block + used;
+}
+
+void TraceRecorder::recordSample(const TimedSample& sample) {
+  uint8_t* p = reserve(TRACE_SAMPLE_MAX_BYTES);
+  if (!p) {
+    return;
+  }
+
+  if (needKeyframe) {
+    used += encodeKeyframe(p, sample);
+    needKeyframe = false;
+    lastIntervalUs = 0;
+  } else {
+    used += traceEncodeSample(p, sample, lastSample, lastIntervalUs);
+    lastIntervalUs = (int32_t)(sample.timestampUs - lastSample.timestampUs);
+  }
+  lastSample = sample;
+  stats.samples++;
+}
+
+void TraceRecorder::recordFilter(float rawAngle, float filteredAltitude, uint32_t filteredSampleUs,
+                                 const AltitudeFilter& filter) {
+  uint8_t* p = reserve(TRACE_FILTER_STATE_BYTES);
+  if (!p) {
+    return;
+  }
+
+  putFloat(p + 1, rawAngle);
+  putFloat(p + 5, filteredAltitude);
+  if (!needFilterState) {
+    p[0] = TRACE_RECORD_FILTER;
+    used += TRACE_FILTER_BYTES;
+  } else {
+    AltitudeFilterState state;
+    filter.getState(state);
+    p[0] = TRACE_RECORD_FILTER_STATE;
+    putU32(p + 9, filteredSampleUs);
+    p[13] = state.state;
+    p[14] = state.warmupCount;
+    p[15] = (state.biasKnown ? 0x01 : 0) | (state.atRest ? 0x02 : 0);
+    putFloat(p + 16, state.lastAccelAngle);
+    putFloat(p + 20, state.gyroBias);
+    putFloat(p + 24, state.speed);
+    used += TRACE_FILTER_STATE_BYTES;
+    needFilterState = false;
+  }
+  stats.records++;
+}
+
+void TraceRecorder::recordCalibration() {
+  uint8_t* p = reserve(TRACE_CALIBRATION_BYTES);
+  if (!p) {
+    return;
+  }
+
+  CalibrationRecord record;
+  calibration.getRecord(record);
+  p[0] = TRACE_RECORD_CALIBRATION;
+  putU32(p + 1, micros());
+  putCalibration(p + 5, record);
+  used += TRACE_CALIBRATION_BYTES;
+  stats.records++;
+}
+
+void TraceRecorder::recordFilterReset() {
+  uint8_t* p = reserve(TRACE_FILTER_RESET_BYTES);
+  if (!p) {
+    return;
+  }
+
+  p[0] = TRACE_RECORD_FILTER_RESET;
+  putU32(p + 1, micros());
+  used += TRACE_FILTER_RESET_BYTES;
+  stats.records++;
+}
+
+void TraceRecorder::recordButton(const ButtonEvent& event) {
+  uint8_t* p = reserve(TRACE_BUTTON_BYTES);
+  if (!p) {
+    return;
+  }
+
+  p[0] = TRACE_RECORD_BUTTON;
+  putU32(p + 1, event.timestampUs);
+  p[5] = (uint8_t)event.type;
+  putU32(p + 6, event.durationMs);
+  used += TRACE_BUTTON_BYTES;
+  stats.records++;
+}
+
+void TraceRecorder::recordUiMode(uint8_t mode) {
+  uint8_t* p = reserve(TRACE_UI_MODE_BYTES);
+  if (!p) {
+    return;
+  }
+
+  p[0] = TRACE_RECORD_UI_MODE;
+  putU32(p + 1, micros());
+  p[5] = mode;
+  used += TRACE_UI_MODE_BYTES;
+  stats.records++;
+}
+
+void TraceRecorder::recordPowerChange(uint32_t timestampUs, PowerMode from, PowerMode to) {
+  uint8_t* p = reserve(TRACE_POWER_BYTES);
+  if (!p) {
+    return;
+  }
+
+  p[0] = TRACE_RECORD_POWER;
+  putU32(p + 1, timestampUs);
+  p[5] = (uint8_t)from;
+  p[6] = (uint8_t)to;
+  used += TRACE_POWER_BYTES;
+  stats.records++;
+}
+
+// ==================== FLASH ====================
+
+void TraceRecorder::commitPending() {
+  if (sealedCount == 0) {
+    return;
+  }
+
+  // One block per call, so each idle pass stalls for one flash write at most
+  writeBlock(staging[sealedHead]);
+  sealedHead = (sealedHead + 1) % TRACE_STAGING_BLOCKS;
+  sealedCount--;
+}
+
+void TraceRecorder::openNextSegment() {
+  segmentFile.close();
+  segment = (segment + 1) % TRACE_SEGMENTS;
+  writtenBlocks = 0;
+
+  // Truncating drops the oldest part of the ring
+  char path[16];
+  segmentPath(path, segment);
+  segmentFile = LittleFS.open(path, "w");
+}
+
+void TraceRecorder::writeBlock(const uint8_t* block) {
+  uint32_t start = micros();
+
+  if (!segmentFile || writtenBlocks == TRACE_SEGMENT_BLOCKS) {
+    openNextSegment();
+  }
+
+  // Counted even when it fails, so segments stay aligned with the blocks
+  // that were filled for them
+  writtenBlocks++;
+  if (segmentFile && segmentFile.write(block, TRACE_BLOCK_SIZE) == TRACE_BLOCK_SIZE) {
+    segmentFile.flush();
+    stats.blocks++;
+    stats.payloadBytes += getU16(block + 4);
+  } else {
+    stats.writeErrors++;
+  }
+
+  uint32_t elapsed = micros() - start;
+  if (elapsed > stats.maxWriteUs) {
+    stats.maxWriteUs = elapsed;
+  }
+}
+
+void TraceRecorder::dump(Print& out) {
+  stop();
+
+  char path[16];
+  uint32_t blocks = 0;
+  for (int i = 0; i < TRACE_SEGMENTS; i++) {
+    segmentPath(path, i);
+    File file = LittleFS.open(path, "r");
+    if (file) {
+      blocks += file.size() / TRACE_BLOCK_SIZE;
+      file.close();
+    }
+  }
+  out.print("Trace dump: ");
+  out.print(blocks);
+  out.println(" blocks");
+
+  uint8_t* block = staging[0];
+  for (int i = 1; i <= TRACE_SEGMENTS; i++) {
+    segmentPath(path, (segment + i + TRACE_SEGMENTS) % TRACE_SEGMENTS);
+    File file = LittleFS.open(path, "r");
+    if (!file) {
+      continue;
+    }
+    while (file.read(block, TRACE_BLOCK_SIZE) == TRACE_BLOCK_SIZE) {
+      out.write(block, TRACE_BLOCK_SIZE);
+      yield();  // ~45 ms per block at 115200 baud: keep the watchdog fed
+    }
+    file.close();
+  }
+
+  out.println();
+  out.println("Trace dump done ('rec on' resumes recording)");
+}
+
+void TraceRecorder::getStats(TraceStats& out) const {
+  out = stats;
+}
+
+void TraceRecorder::printStats(Print& out) const {
+  out.print("Trace: ");
+  out.print(recording ? "recording" : (mounted ? "stopped" : "no file system"));
+  out.print(", segment ");
+  out.print((int)segment);
+  out.print(" of ");
+  out.print(TRACE_SEGMENTS);
+  out.print(", ");
+  out.print(stats.blocks);
+  out.print(" blocks written (");
+  out.print(stats.samples > 0 ? (float)stats.payloadBytes / stats.samples : 0.0f, 1);
+  out.println(" B/sample with events)");
+
+  out.print("Samples ");
+  out.print(stats.samples);
+  out.print(", events ");
+  out.print(stats.records);
+  out.print(", dropped ");
+  out.print(stats.dropped);
+  out.print(", write errors ");
+  out.print(stats.writeErrors);
+  out.print(", slowest write ");
+  out.print(stats.maxWriteUs / 1000.0f, 1);
+  out.println(" ms");
+}
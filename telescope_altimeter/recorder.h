@@ -0,0 +1,222 @@
+/*
+ * Flash trace recorder for Telescope Altimeter
+ * Keeps a black-box record of every sensor sample the sketch reads, with
+ * its filter outputs, mode changes and button events, in a bounded ring on
+ * LittleFS. The sensor task only encodes into RAM staging blocks; sealed
+ * blocks go to flash from the scheduler's idle hook, like calibration
+ * commits. host/flash_replay feeds a trace back through the sketch's own
+ * readSensor()/updateFilter() and checks the results bit for bit.
+ *
+ * The ring is TRACE_SEGMENTS files (/trace0.bin ...) that are only ever
+ * appended to; the oldest is truncated when the ring moves on. (LittleFS
+ * rewrites a file from the changed block to its end, so overwriting one
+ * file in place would cost a copy of the whole tail per block.) Each "rec
+ * on" (or boot, with TRACE_AT_BOOT) starts a new segment.
+ *
+ * Block (TRACE_BLOCK_SIZE bytes, little-endian, zero-padded):
+ *   0  uint16  magic (TRACE_MAGIC)
+ *   2  uint8   format version (TRACE_FORMAT_VERSION)
+ *   3  uint8   reserved
+ *   4  uint16  payload bytes
+ *   6  uint16  CRC-16/CCITT over the header (crc = 0) and the payload
+ *   8  uint32  sequence number (+1 per block, across segments and boots)
+ *  12  records
+ *
+ * Every block decodes on its own: its first sample is a keyframe and its
+ * first filter record carries the whole filter state. The first block of a
+ * segment also starts with the segment marker and the calibration.
+ *
+ * Records (first byte is the type):
+ *   KEYFRAME      uint32 timestamp (us), int32 azimuth ticks, int16 ax..gz
+ *   SAMPLE        varints: change of the sample interval (us), ax..gz
+ *                 differences, azimuth tick difference (zigzag LEB128)
+ *   FILTER        float raw angle, float filtered altitude (bit patterns)
+ *   FILTER_STATE  FILTER, then uint32 filteredSampleUs, uint8 state,
+ *                 uint8 warmup count, uint8 flags (1 bias known, 2 at
+ *                 rest), float last accel angle, gyro bias, speed
+ *   SEGMENT       uint32 time, uint8 flags (TRACE_SEGMENT_SESSION)
+ *   CALIBRATION   uint32 time, CalibrationRecord (9 floats, uint32 flags,
+ *                 int32 ticks per revolution)
+ *   FILTER_RESET  uint32 time
+ *   BUTTON        uint32 event time, uint8 ButtonEventType, uint32 ms held
+ *   UI_MODE       uint32 time, uint8 UIMode
+ *   POWER         uint32 time, uint8 previous PowerMode, uint8 new mode
+ *   GAP           uint16 records dropped (staging blocks all full)
+ */
+
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "config.h"
+#include "sensor.h"
+#include "calibration.h"
+#include "filter.h"
+#include "button.h"
+#include "power.h"
+
+#define TRACE_MAGIC 0x7A3C
+#define TRACE_FORMAT_VERSION 1
+#define TRACE_HEADER_SIZE 12
+
+#define TRACE_RECORD_KEYFRAME 0x01
+#define TRACE_RECORD_SAMPLE 0x02
+#define TRACE_RECORD_FILTER 0x03
+#define TRACE_RECORD_FILTER_STATE 0x04
+#define TRACE_RECORD_SEGMENT 0x05
+#define TRACE_RECORD_CALIBRATION 0x06
+#define TRACE_RECORD_FILTER_RESET 0x07
+#define TRACE_RECORD_BUTTON 0x08
+#define TRACE_RECORD_UI_MODE 0x09
+#define TRACE_RECORD_POWER 0x0A
+#define TRACE_RECORD_GAP 0x0B
+
+// Record sizes (SAMPLE at most: five bytes per 32-bit varint, three per
+// 17-bit channel difference)
+#define TRACE_KEYFRAME_BYTES 21
+#define TRACE_SAMPLE_MAX_BYTES 29
+#define TRACE_FILTER_BYTES 9
+#define TRACE_FILTER_STATE_BYTES 28
+#define TRACE_SEGMENT_BYTES 6
+#define TRACE_CALIBRATION_BYTES 49
+#define TRACE_FILTER_RESET_BYTES 5
+#define TRACE_BUTTON_BYTES 10
+#define TRACE_UI_MODE_BYTES 6
+#define TRACE_POWER_BYTES 7
+#define TRACE_GAP_BYTES 3
+
+// SEGMENT flags: the first segment since boot or "rec on" (timestamps and
+// filter history restart)
+#define TRACE_SEGMENT_SESSION 0x01
+
+// One decoded record; the fields its type does not carry are left alone
+struct TraceRecord {
+  uint8_t type;
+  uint32_t timeUs;          // Sample, event or marker time (micros())
+  TimedSample sample;       // KEYFRAME and SAMPLE (absolute values)
+  float rawAngle;           // FILTER, FILTER_STATE
+  float filteredAltitude;
+  uint32_t filteredSampleUs;  // FILTER_STATE
+  AltitudeFilterState filter;
+  CalibrationRecord calibration;
+  uint8_t kind;             // Button event type, UI mode, new power mode, segment flags
+  uint8_t previous;         // Previous power mode
+  uint32_t amount;          // Button ms held, records dropped
+};
+
+// Check a block's header and CRC. Returns the payload length, or -1.
+int traceCheckBlock(const uint8_t* block, uint32_t& sequence);
+
+// Delta-encode a SAMPLE record against the sample before it, whose own
+// interval was previousIntervalUs. Returns the bytes written.
+size_t traceEncodeSample(uint8_t* out, const TimedSample& sample, const TimedSample& previous,
+                         int32_t previousIntervalUs);
+
+// Walks the records of one block that passed traceCheckBlock()
+class TraceBlockReader {
+public:
+  explicit TraceBlockReader(const uint8_t* block);
+
+  // Next record; false at the end of the block or on a malformed record
+  bool next(TraceRecord& record);
+
+private:
+  const uint8_t* read;
+  const uint8_t* end;
+  TimedSample previous;
+  int32_t previousIntervalUs;
+  bool haveSample;
+};
+
+struct TraceStats {
+  uint32_t samples;      // Sample records staged (keyframes included)
+  uint32_t records;      // Other records staged
+  uint32_t dropped;      // Records lost to full staging blocks
+  uint32_t blocks;       // Blocks written to flash
+  uint32_t payloadBytes; // Record bytes in those blocks
+  uint32_t writeErrors;
+  uint32_t maxWriteUs;   // Slowest block write (erases show up here)
+};
+
+class TraceRecorder {
+public:
+  TraceRecorder(CalibrationManager& calibration);
+
+  // Mount LittleFS and find the newest segment; with TRACE_AT_BOOT, start
+  void begin();
+
+  // Start a new session in the next segment / seal and write everything
+  void start();
+  void stop();
+  bool isRecording() const { return recording; }
+
+  // Sensor and UI hooks: RAM only, never wait for the flash. When every
+  // staging block is full the record is dropped (and counted).
+  void recordSample(const TimedSample& sample);
+  void recordFilter(float rawAngle, float filteredAltitude, uint32_t filteredSampleUs,
+                    const AltitudeFilter& filter);
+  void recordCalibration();
+  void recordFilterReset();
+  void recordButton(const ButtonEvent& event);
+  void recordUiMode(uint8_t mode);
+  void recordPowerChange(uint32_t timestampUs, PowerMode from, PowerMode to);
+
+  // Write one sealed block to flash (call from an idle point)
+  void commitPending();
+  bool hasPendingCommit() const { return sealedCount > 0; }
+
+  // Seal the partly filled block and write everything now (before sleep)
+  void flush();
+
+  // Stop, then send every stored block oldest first (raw binary between
+  // two text lines; host/flash_replay picks the blocks out)
+  void dump(Print& out);
+
+  void getStats(TraceStats& stats) const;
+  void printStats(Print& out) const;
+
+private:
+  CalibrationManager& calibration;
+  bool mounted;
+  bool recording;
+
+  // Staging: sealed blocks queue from sealedHead; the block after them is
+  // being filled (used bytes, 0 = none started)
+  uint8_t staging[TRACE_STAGING_BLOCKS][TRACE_BLOCK_SIZE];
+  uint8_t sealedHead;
+  uint8_t sealedCount;
+  size_t used;
+  uint32_t nextSequence;
+  uint32_t blockSequence;
+  uint16_t filledBlocks;     // Blocks started in the segment being filled
+  bool sessionStart;
+
+  // Delta state
+  TimedSample lastSample;
+  int32_t lastIntervalUs;
+  bool needKeyframe;
+  bool needFilterState;
+  uint16_t gapRecords;
+
+  // Flash side
+  File segmentFile;
+  int8_t segment;            // Segment being written (-1: none yet)
+  uint16_t writtenBlocks;    // Blocks in it
+
+  TraceStats stats;
+
+  uint8_t* activeBlock() { return staging[(sealedHead + sealedCount) % TRACE_STAGING_BLOCKS]; }
+
+  // Room for a record of up to length bytes in the active block, or
+  // nullptr (dropped); commit the bytes actually used with used += n
+  uint8_t* reserve(size_t length);
+  bool startBlock();
+  void seal();
+  uint8_t* drop();
+  void writeBlock(const uint8_t* block);
+  void openNextSegment();
+  static void segmentPath(char* path, int index);
+};
+
+#endif // RECORDER_H
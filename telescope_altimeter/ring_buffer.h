@@ -0,0 +1,70 @@
+/*
+ * Lock-free single-producer/single-consumer ring buffer
+ * Safe to push from an ISR (or a thread on the host) while the main loop pops.
+ * push() is always inlined, so it lands in the calling ISR's IRAM section
+ * (an out-of-line copy would sit in flash, which is unmapped while
+ * LittleFS or EEPROM writes). 32-bit atomic loads and stores compile to
+ * plain instructions on the ESP8266.
+ */
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <stdint.h>
+#include <atomic>
+
+template <typename T, uint32_t CAPACITY>
+class SpscRing {
+  static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+  SpscRing() : head(0), tail(0), droppedCount(0) {}
+
+  // Producer side - returns false (and counts a drop) when full
+  __attribute__((always_inline)) inline bool push(const T& item) {
+    uint32_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) >= CAPACITY) {
+      droppedCount.store(droppedCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      return false;
+    }
+
+    items[h & (CAPACITY - 1)] = item;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side - returns false when empty
+  bool pop(T& item) {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire)) {
+      return false;
+    }
+
+    item = items[t & (CAPACITY - 1)];
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side - discard everything queued so far
+  void clear() {
+    tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+  }
+
+  uint32_t size() const {
+    return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+  }
+
+  bool isEmpty() const { return size() == 0; }
+  uint32_t capacity() const { return CAPACITY; }
+  uint32_t dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+
+private:
+  T items[CAPACITY];
+
+  // Free-running indices; only the low bits select a slot
+  std::atomic<uint32_t> head;
+  std::atomic<uint32_t> tail;
+  std::atomic<uint32_t> droppedCount;
+};
+
+#endif // RING_BUFFER_H
@@ -0,0 +1,85 @@
+/*
+ * Cooperative task scheduler implementation for Telescope Altimeter
+ */
+
+#include "scheduler.h"
+
+Scheduler::Scheduler()
+  : taskCount(0), idleCallback(nullptr) {
+}
+
+int Scheduler::addTask(const char* name, TaskCallback callback, unsigned long periodMs, unsigned long deadlineMs) {
+  if (taskCount >= MAX_TASKS) {
+    return -1;
+  }
+
+  Task& task = tasks[taskCount];
+  task.name = name;
+  task.callback = callback;
+  task.periodMs = periodMs;
+  task.deadlineMs = deadlineMs;
+  task.nextRunMs = millis();
+  task.runs = 0;
+  task.overruns = 0;
+  task.maxRunMs = 0;
+
+  return taskCount++;
+}
+
+void Scheduler::setPeriod(int taskId, unsigned long periodMs) {
+  if (taskId >= 0 && taskId < taskCount) {
+    tasks[taskId].periodMs = periodMs;
+  }
+}
+
+void Scheduler::run() {
+  bool ranTask = false;
+
+  for (int i = 0; i < taskCount; i++) {
+    Task& task = tasks[i];
+    unsigned long now = millis();
+
+    // Signed difference keeps this correct across the millis() wrap
+    if ((long)(now - task.nextRunMs) < 0) {
+      continue;
+    }
+
+    task.callback();
+    ranTask = true;
+
+    unsigned long finished = millis();
+    unsigned long runTime = finished - now;
+    if (runTime > task.maxRunMs) {
+      task.maxRunMs = runTime;
+    }
+    if (finished - task.nextRunMs > task.deadlineMs) {
+      task.overruns++;
+    }
+    task.runs++;
+
+    task.nextRunMs += task.periodMs;
+    if ((long)(finished - task.nextRunMs) >= 0) {
+      // Fell a whole period behind - skip missed releases instead of bursting
+      task.nextRunMs = finished + task.periodMs;
+    }
+  }
+
+  if (!ranTask && idleCallback) {
+    idleCallback();
+  }
+}
+
+void Scheduler::printStats(Print& out) const {
+  out.println("Task stats (runs / overruns / max ms):");
+  for (int i = 0; i < taskCount; i++) {
+    const Task& task = tasks[i];
+    out.print("  ");
+    out.print(task.name);
+    out.print(": ");
+    out.print(task.runs);
+    out.print(" / ");
+    out.print(task.overruns);
+    out.print(" / ");
+    out.println(task.maxRunMs);
+  }
+}
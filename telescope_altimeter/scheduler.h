@@ -0,0 +1,52 @@
+/*
+ * Cooperative task scheduler for Telescope Altimeter
+ * Runs periodic millis()-based tasks from loop() and tracks deadline overruns
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+
+#define MAX_TASKS 8
+
+typedef void (*TaskCallback)();
+
+struct Task {
+  const char* name;
+  TaskCallback callback;
+  unsigned long periodMs;
+  unsigned long deadlineMs;    // Must finish this long after its release time
+  unsigned long nextRunMs;     // Next release time
+  unsigned long runs;
+  unsigned long overruns;      // Runs that finished past their deadline
+  unsigned long maxRunMs;      // Longest single execution
+};
+
+class Scheduler {
+public:
+  Scheduler();
+
+  // Register a task; returns its id or -1 when the table is full
+  int addTask(const char* name, TaskCallback callback, unsigned long periodMs, unsigned long deadlineMs);
+
+  // Change a task's period (takes effect from its next release)
+  void setPeriod(int taskId, unsigned long periodMs);
+
+  // Called from run() when no task was due - for deferrable work such as
+  // flash commits
+  void setIdleCallback(TaskCallback callback) { idleCallback = callback; }
+
+  // Run every task that is due (call from loop())
+  void run();
+
+  // Print per-task run/overrun counts
+  void printStats(Print& out) const;
+
+private:
+  Task tasks[MAX_TASKS];
+  int taskCount;
+  TaskCallback idleCallback;
+};
+
+#endif // SCHEDULER_H
@@ -4,10 +4,40 @@
 
 #include "sensor.h"
 #include "config.h"
+#include "pipeline.h"
+#include "ring_buffer.h"
+#include "profiler.h"
+#include "decimator.h"
+#include "azimuth.h"
+#include "console.h"
 #include <Arduino.h>
 
+// Accel XYZ + gyro XYZ, big-endian int16 each
+#define FIFO_SAMPLE_BYTES 12
+
+// Data-ready stamps, pushed by the ISR and paired with FIFO samples on drain.
+// The ISR only stamps: the I2C bus is shared with the display and the
+// Wire driver is not reentrant, so the samples stay in the MPU6050 FIFO.
+struct DataReadyStamp {
+  uint32_t timestampUs;
+  int32_t azimuthTicks;  // GPIO interrupts do not nest: never mid-update
+};
+
+static SpscRing<DataReadyStamp, DATA_READY_QUEUE_SIZE> dataReadyStamps;
+
+// Oversampled stream -> output rate (a pass-through when DECIMATION_RATIO is 1)
+static CicDecimator decimator;
+
+static void IRAM_ATTR onDataReady() {
+  DataReadyStamp stamp;
+  stamp.timestampUs = micros();
+  stamp.azimuthTicks = azimuthTicks();
+  dataReadyStamps.push(stamp);
+}
+
 TelescopeSensor::TelescopeSensor()
-  : last_ax(0.0), last_ay(0.0), last_az(0.0) {
+  : last_ax(0.0), last_ay(0.0), last_az(0.0), fifoOverflows(0), lowPower(false),
+    stampsComplete(false), lastDroppedStamps(0) {
 }
 
 bool TelescopeSensor::begin() {
@@ -17,31 +47,31 @@ bool TelescopeSensor::begin() {
     return false;
   }
 
-  // Configure MPU6050
-  mpu.setFullScaleAccelRange(MPU6050_ACCEL_FS_2);
-  mpu.setFullScaleGyroRange(MPU6050_GYRO_FS_250);
-  mpu.setDLPFMode(MPU6050_DLPF_BW_20);
+  // Configure MPU6050 (the conversions below are scaled for these ranges)
+  mpu.setFullScaleAccelRange(AccelScale::setting);
+  mpu.setFullScaleGyroRange(GyroScale::setting);
+  mpu.setDLPFMode(SensorLowPass::setting);
+
+  startFifo();
+  enableDataReadyInterrupt();
 
-  Serial.println("MPU6050 initialized successfully");
+  console.println("MPU6050 initialized successfully");
   return true;
 }
 
-void TelescopeSensor::readGravity(float& ax, float& ay, float& az) {
-  int16_t raw_ax, raw_ay, raw_az;
-  int16_t gx, gy, gz;
+void TelescopeSensor::readRawSample(RawSample& sample) {
+  mpu.getMotion6(&sample.ax, &sample.ay, &sample.az, &sample.gx, &sample.gy, &sample.gz);
 
-  mpu.getMotion6(&raw_ax, &raw_ay, &raw_az, &gx, &gy, &gz);
+  // Store for later retrieval
+  sampleToGravity(sample, last_ax, last_ay, last_az);
+}
 
-  // Convert to g (MPU6050 returns raw values)
-  // For ±2g range: sensitivity = 16384 LSB/g
-  ax = raw_ax / 16384.0;
-  ay = raw_ay / 16384.0;
-  az = raw_az / 16384.0;
+void TelescopeSensor::readGravity(float& ax, float& ay, float& az) {
+  RawSample sample;
+  readRawSample(sample);
 
-  // Store for later retrieval
-  last_ax = ax;
-  last_ay = ay;
-  last_az = az;
+  // Convert to g (MPU6050 returns raw values)
+  sampleToGravity(sample, ax, ay, az);
 }
 
 void TelescopeSensor::getLastReading(float& ax, float& ay, float& az) {
@@ -50,75 +80,284 @@ void TelescopeSensor::getLastReading(float& ax, float& ay, float& az) {
   az = last_az;
 }
 
+void TelescopeSensor::sampleToGravity(const RawSample& sample, float& ax, float& ay, float& az) {
+  ax = sample.ax * AccelScale::gPerLsb;
+  ay = sample.ay * AccelScale::gPerLsb;
+  az = sample.az * AccelScale::gPerLsb;
+}
+
+float TelescopeSensor::gyroCountsToDps(float counts) {
+  return counts * GyroScale::dpsPerLsb;
+}
+
+void TelescopeSensor::gravityToSample(float ax, float ay, float az, RawSample& sample) {
+  sample.ax = (int16_t)constrain(lroundf(ax * AccelScale::lsbPerG), -32768L, 32767L);
+  sample.ay = (int16_t)constrain(lroundf(ay * AccelScale::lsbPerG), -32768L, 32767L);
+  sample.az = (int16_t)constrain(lroundf(az * AccelScale::lsbPerG), -32768L, 32767L);
+  sample.gx = 0;
+  sample.gy = 0;
+  sample.gz = 0;
+}
+
 void TelescopeSensor::readAveragedGravity(float& ax, float& ay, float& az, int numSamples) {
-  float sum_ax = 0.0;
-  float sum_ay = 0.0;
-  float sum_az = 0.0;
+  RawSample batch[FIFO_BURST_SAMPLES];
+  long sum_ax = 0;
+  long sum_ay = 0;
+  long sum_az = 0;
+  int collected = 0;
+
+  beginCapture();
 
-  for (int i = 0; i < numSamples; i++) {
-    float sample_ax, sample_ay, sample_az;
-    readGravity(sample_ax, sample_ay, sample_az);
+  while (collected < numSamples) {
+    int n = waitForSamples(batch, min(numSamples - collected, FIFO_BURST_SAMPLES));
+    if (n == 0) {
+      break;  // Sensor stopped delivering samples
+    }
 
-    sum_ax += sample_ax;
-    sum_ay += sample_ay;
-    sum_az += sample_az;
+    for (int i = 0; i < n; i++) {
+      sum_ax += batch[i].ax;
+      sum_ay += batch[i].ay;
+      sum_az += batch[i].az;
+    }
+    collected += n;
+  }
 
-    delay(20);
+  if (collected == 0) {
+    // FIFO unavailable - fall back to a single direct read
+    readGravity(ax, ay, az);
+    return;
   }
 
-  ax = sum_ax / numSamples;
-  ay = sum_ay / numSamples;
-  az = sum_az / numSamples;
+  double countsPerG = collected * (double)AccelScale::lsbPerG;
+  ax = sum_ax / countsPerG;
+  ay = sum_ay / countsPerG;
+  az = sum_az / countsPerG;
+}
+
+void TelescopeSensor::startFifo() {
+  // Sample rate = gyro output rate (1 kHz with the DLPF on) / (1 + divider)
+  mpu.setRate(FifoClock::divider);
+
+  mpu.setAccelFIFOEnabled(true);
+  mpu.setXGyroFIFOEnabled(true);
+  mpu.setYGyroFIFOEnabled(true);
+  mpu.setZGyroFIFOEnabled(true);
+  mpu.setFIFOEnabled(true);
+  mpu.resetFIFO();
+}
+
+void TelescopeSensor::enableDataReadyInterrupt() {
+  mpu.setInterruptMode(MPU6050_INTMODE_ACTIVEHIGH);
+  mpu.setInterruptDrive(MPU6050_INTDRV_PUSHPULL);
+  mpu.setInterruptLatch(MPU6050_INTLATCH_50USPULSE);
+  mpu.setIntDataReadyEnabled(true);
+
+  pinMode(MPU_INT_PIN, INPUT);
+  attachInterrupt(digitalPinToInterrupt(MPU_INT_PIN), onDataReady, RISING);
 }
 
-float TelescopeSensor::calculateRawAngle(float refGravityX, float refGravityY, float refGravityZ) {
-  // Read current gravity
-  float ax_g, ay_g, az_g;
-  readGravity(ax_g, ay_g, az_g);
+void TelescopeSensor::beginCapture() {
+  // Discard stale samples so the capture starts from "now"
+  mpu.resetFIFO();
+  dataReadyStamps.clear();
+  decimator.reset();
+}
 
-  // Calculate altitude angle using dot product with reference "level" gravity vector
-  // This works regardless of sensor rotation around the telescope tube!
+int TelescopeSensor::readFifoBurst(RawSample* buffer, int maxSamples) {
+  PROFILE_SCOPE(PROFILE_I2C_READ);
+
+  if (mpu.getIntFIFOBufferOverflowStatus()) {
+    // An overflowed FIFO has lost its frame alignment - start over
+    mpu.resetFIFO();
+    dataReadyStamps.clear();
+    decimator.reset();
+    fifoOverflows++;
+    return 0;
+  }
+
+  int count = min((int)(mpu.getFIFOCount() / FIFO_SAMPLE_BYTES), maxSamples);
+  uint8_t bytes[FIFO_BURST_SAMPLES * FIFO_SAMPLE_BYTES];
+
+  for (int done = 0; done < count; ) {
+    int chunk = min(count - done, FIFO_BURST_SAMPLES);
+    mpu.getFIFOBytes(bytes, chunk * FIFO_SAMPLE_BYTES);
+
+    for (int i = 0; i < chunk; i++) {
+      const uint8_t* p = &bytes[i * FIFO_SAMPLE_BYTES];
+      RawSample& sample = buffer[done + i];
+      sample.ax = (int16_t)((p[0] << 8) | p[1]);
+      sample.ay = (int16_t)((p[2] << 8) | p[3]);
+      sample.az = (int16_t)((p[4] << 8) | p[5]);
+      sample.gx = (int16_t)((p[6] << 8) | p[7]);
+      sample.gy = (int16_t)((p[8] << 8) | p[9]);
+      sample.gz = (int16_t)((p[10] << 8) | p[11]);
+    }
+    done += chunk;
+  }
 
-  // Current gravity magnitude
-  float gravityMag = sqrt(ax_g*ax_g + ay_g*ay_g + az_g*az_g);
+  if (count > 0) {
+    sampleToGravity(buffer[count - 1], last_ax, last_ay, last_az);
+  }
 
-  // Reference gravity magnitude
-  float refGravityMag = sqrt(refGravityX*refGravityX + refGravityY*refGravityY + refGravityZ*refGravityZ);
+  return count;
+}
 
-  if (gravityMag > 0.1 && refGravityMag > 0.1) {
-    // Normalize both vectors
-    float norm_ax = ax_g / gravityMag;
-    float norm_ay = ay_g / gravityMag;
-    float norm_az = az_g / gravityMag;
+int TelescopeSensor::waitForSamples(RawSample* buffer, int maxSamples) {
+  unsigned long start = millis();
 
-    float norm_ref_x = refGravityX / refGravityMag;
-    float norm_ref_y = refGravityY / refGravityMag;
-    float norm_ref_z = refGravityZ / refGravityMag;
+  while (millis() - start < FIFO_TIMEOUT_MS) {
+    int n = readFifoBurst(buffer, maxSamples);
+    if (n > 0) {
+      return n;
+    }
+    yield();
+  }
 
-    // Dot product gives us cos(angle) between the two gravity vectors
-    float dotProduct = norm_ax * norm_ref_x + norm_ay * norm_ref_y + norm_az * norm_ref_z;
+  return 0;
+}
 
-    // Clamp to [-1, 1] to avoid NaN from acos due to floating point errors
-    dotProduct = constrain(dotProduct, -1.0, 1.0);
+int TelescopeSensor::drainSamples(TimedSample* buffer, int maxSamples) {
+  RawSample batch[FIFO_BURST_SAMPLES];
+  int total = 0;
+  bool emptied = false;
+  bool read = false;
+  bool missing = false;
 
-    // Angle between current and reference gravity vectors
-    float angleBetweenVectors = acos(dotProduct) * (180.0 / PI);
+  while (total < maxSamples) {
+    // k * R inputs yield at most k outputs, whatever the decimator's phase
+    int n = readFifoBurst(batch, min((maxSamples - total) * DECIMATION_RATIO, FIFO_BURST_SAMPLES));
+    if (n == 0) {
+      emptied = true;
+      break;
+    }
+    read = true;
 
-    // This angle represents rotation of the telescope
-    // When telescope points up, gravity vector rotates "backward" relative to sensor
-    // We need to determine the sign (positive = up, negative = down)
+    uint32_t now = micros();
+    int32_t ticks = azimuthTicks();
+    for (int i = 0; i < n; i++) {
+      TimedSample sample;
+      sample.raw = batch[i];
 
-    // Cross product to determine direction
-    // cross = ref × current, the Z component tells us rotation direction
-    float cross_z = (norm_ref_x * norm_ay - norm_ref_y * norm_ax);
+      // Samples and interrupts arrive in the same order; if a stamp is missing
+      // (INT not wired, or queue overrun) back-date from the nominal rate
+      DataReadyStamp stamp;
+      if (dataReadyStamps.pop(stamp)) {
+        sample.timestampUs = stamp.timestampUs;
+        sample.azimuthTicks = stamp.azimuthTicks;
+      } else {
+        sample.timestampUs = now - (uint32_t)(n - 1 - i) * FifoClock::periodUs;
+        sample.azimuthTicks = ticks;
+        missing = true;
+      }
 
-    // If cross_z is positive, we're rotating upward; negative = downward
-    if (cross_z < 0) {
-      return angleBetweenVectors;
-    } else {
-      return -angleBetweenVectors;
+#if DECIMATION_RATIO > 1
+      if (decimator.push(sample, buffer[total])) {
+        total++;
+      }
+#else
+      buffer[total++] = sample;
+#endif
     }
-  } else {
-    return 0.0;  // Fallback if gravity reading is invalid
   }
+
+  // At most one interrupt can race ahead of the FIFO count; more means we
+  // slipped. Stamps for a backlog still in the FIFO (after a flash write,
+  // say) belong to the next call.
+  while (emptied && dataReadyStamps.size() > 1) {
+    DataReadyStamp stale;
+    dataReadyStamps.pop(stale);
+  }
+
+  if (read) {
+    uint32_t dropped = dataReadyStamps.dropped();
+    stampsComplete = !missing && dropped == lastDroppedStamps;
+    lastDroppedStamps = dropped;
+  }
+
+  return total;
+}
+
+uint32_t TelescopeSensor::getDroppedTimestamps() const {
+  return dataReadyStamps.dropped();
+}
+
+void TelescopeSensor::enterLowPower() {
+  mpu.setFIFOEnabled(false);
+
+  // Motion is judged on the high-passed accelerometer, so a still tube at
+  // any altitude stays quiet
+  mpu.setDHPFMode(MPU6050_DHPF_5);
+  mpu.setMotionDetectionThreshold(MOTION_WAKE_THRESHOLD);
+  mpu.setMotionDetectionDuration(1);
+  mpu.setIntMotionEnabled(true);
+
+  // Hold INT until the status is read: light sleep wakes on a level, not a pulse
+  mpu.setInterruptLatch(MPU6050_INTLATCH_WAITCLEAR);
+  mpu.setInterruptLatchClear(MPU6050_INTCLEAR_STATUSREAD);
+
+  mpu.setTempSensorEnabled(false);
+  mpu.setStandbyXGyroEnabled(true);
+  mpu.setStandbyYGyroEnabled(true);
+  mpu.setStandbyZGyroEnabled(true);
+  mpu.setWakeFrequency(POWER_IDLE_WAKE_FREQ);
+  mpu.setWakeCycleEnabled(true);
+
+  // Start with INT released
+  mpu.getIntStatus();
+  lowPower = true;
+}
+
+void TelescopeSensor::exitLowPower() {
+  mpu.setWakeCycleEnabled(false);
+  mpu.setStandbyXGyroEnabled(false);
+  mpu.setStandbyYGyroEnabled(false);
+  mpu.setStandbyZGyroEnabled(false);
+  mpu.setTempSensorEnabled(true);
+
+  // Back to data-ready pulses; re-attaching also restores the pin's
+  // interrupt type, which the light-sleep wake-up setup overrides
+  mpu.setIntMotionEnabled(false);
+  enableDataReadyInterrupt();
+  mpu.getIntStatus();
+
+  startFifo();
+  beginCapture();
+  lowPower = false;
+}
+
+uint8_t TelescopeSensor::readWakeEvents(RawSample& sample) {
+  uint8_t status = mpu.getIntStatus();
+  uint8_t events = 0;
+
+  if (status & (1 << MPU6050_INTERRUPT_MOT_BIT)) {
+    events |= SENSOR_EVENT_MOTION;
+  }
+  if (status & (1 << MPU6050_INTERRUPT_DATA_RDY_BIT)) {
+    mpu.getAcceleration(&sample.ax, &sample.ay, &sample.az);
+    sample.gx = 0;  // Gyros are in standby
+    sample.gy = 0;
+    sample.gz = 0;
+    sampleToGravity(sample, last_ax, last_ay, last_az);
+    events |= SENSOR_EVENT_SAMPLE;
+  }
+
+  return events;
+}
+
+float TelescopeSensor::calculateRawAngle(const ReferenceFrame& frame) {
+  // Read current sample
+  RawSample sample;
+  readRawSample(sample);
+
+  return sampleAngle(sample, frame);
+}
+
+float TelescopeSensor::calculateRawAngle(const RawSample& sample, const ReferenceFrame& frame) {
+  // last_* is updated per FIFO burst, keeping float conversions off this path
+  return sampleAngle(sample, frame);
+}
+
+float TelescopeSensor::sampleAngle(const RawSample& sample, const ReferenceFrame& frame) {
+  // Altitude = atan2(g . up, g . level): two dot products and one atan2
+  return AngleKernel::degrees(frame, sample.ax, sample.ay, sample.az);
 }
@@ -7,6 +7,25 @@
 #define SENSOR_H
 
 #include <MPU6050.h>
+#include "angle_kernel.h"
+
+// One raw sample as stored in the MPU6050 FIFO (native counts)
+struct RawSample {
+  int16_t ax, ay, az;
+  int16_t gx, gy, gz;
+};
+
+// Reasons the MPU6050 raised INT during low-power idle (readWakeEvents())
+#define SENSOR_EVENT_SAMPLE 0x01
+#define SENSOR_EVENT_MOTION 0x02
+
+// Raw sample tagged with the micros() time of its data-ready interrupt and
+// the azimuth encoder count latched by the same interrupt
+struct TimedSample {
+  uint32_t timestampUs;
+  int32_t azimuthTicks;
+  RawSample raw;
+};
 
 class TelescopeSensor {
 public:
@@ -16,7 +35,8 @@ public:
   bool begin();
 
   // Angle calculation
-  float calculateRawAngle(float refGravityX, float refGravityY, float refGravityZ);
+  float calculateRawAngle(const ReferenceFrame& frame);
+  float calculateRawAngle(const RawSample& sample, const ReferenceFrame& frame);
 
   // Get last raw sensor readings
   void getLastReading(float& ax, float& ay, float& az);
@@ -24,6 +44,43 @@ public:
   // Read and average multiple samples (for calibration)
   void readAveragedGravity(float& ax, float& ay, float& az, int numSamples);
 
+  // FIFO burst acquisition
+  void beginCapture();
+  int readFifoBurst(RawSample* buffer, int maxSamples);
+  int waitForSamples(RawSample* buffer, int maxSamples);
+  unsigned long getFifoOverflows() const { return fifoOverflows; }
+
+  // Interrupt-driven streaming: drain everything that arrived since the last
+  // call, decimated to FIFO_SAMPLE_RATE_HZ / DECIMATION_RATIO
+  int drainSamples(TimedSample* buffer, int maxSamples);
+  uint32_t getDroppedTimestamps() const;
+
+  // True once a drain has found a data-ready stamp for every sample, with
+  // none dropped (INT wired and keeping up); false again after any miss.
+  // Light-sleep idle can only wake on INT, so it needs this.
+  bool hasDataReadyStamps() const { return stampsComplete; }
+
+  // Low-power idle: accelerometer-only cycle mode at POWER_IDLE_WAKE_FREQ
+  // with the motion interrupt armed and INT latched (a level the ESP8266
+  // can wake on). The FIFO stream stops until exitLowPower().
+  void enterLowPower();
+  void exitLowPower();
+  bool isLowPower() const { return lowPower; }
+
+  // After a wake-up: read (and so clear) the interrupt status, plus the
+  // latest sample on data ready (gyro fields zero). Returns SENSOR_EVENT_* bits.
+  uint8_t readWakeEvents(RawSample& sample);
+
+  // Convert between raw samples and g
+  static void sampleToGravity(const RawSample& sample, float& ax, float& ay, float& az);
+  static void gravityToSample(float ax, float ay, float az, RawSample& sample);
+
+  // Altitude of a raw sample in the reference frame (kernel picked by ANGLE_KERNEL)
+  static float sampleAngle(const RawSample& sample, const ReferenceFrame& frame);
+
+  // Gyro counts to degrees per second
+  static float gyroCountsToDps(float counts);
+
 private:
   MPU6050 mpu;
 
@@ -32,8 +89,23 @@ private:
   float last_ay;
   float last_az;
 
+  // FIFO state
+  unsigned long fifoOverflows;
+  bool lowPower;
+
+  // Data-ready stamp health, as of the last drain that read samples
+  bool stampsComplete;
+  uint32_t lastDroppedStamps;
+
   // Read single sample
+  void readRawSample(RawSample& sample);
   void readGravity(float& ax, float& ay, float& az);
+
+  // Configure the sample rate divider (FifoClock) and route accel + gyro into the FIFO
+  void startFifo();
+
+  // Route the MPU6050 data-ready pulse to MPU_INT_PIN
+  void enableDataReadyInterrupt();
 };
 
 #endif // SENSOR_H
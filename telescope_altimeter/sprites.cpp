@@ -0,0 +1,135 @@
+/*
+ * Pre-rendered glyph sprites implementation for Telescope Altimeter
+ */
+
+#include "sprites.h"
+#include <string.h>
+
+// Tile rows on the SSD1306 and bytes per tile row
+#define SPRITE_PANEL_ROWS 8
+#define SPRITE_ROW_BYTES 128
+
+GlyphSprites::GlyphSprites()
+  : glyphs(""),
+    glyphCount(0),
+    pixels(nullptr),
+    totalBytes(0),
+    firstRow(0),
+    bandRows(0) {
+}
+
+GlyphSprites::~GlyphSprites() {
+  delete[] pixels;
+}
+
+int GlyphSprites::renderGlyph(U8G2& display, const uint8_t* font, int baseline, char glyph, uint8_t row) {
+  char text[2] = {glyph, '\0'};
+  display.setBufferCurrTileRow(row);
+  display.clearBuffer();
+  display.setFont(font);
+  return display.drawStr(0, baseline, text);
+}
+
+bool GlyphSprites::capture(U8G2& display, const uint8_t* font, int baseline, const char* glyphList) {
+  const uint8_t tileHeight = display.getBufferTileHeight();
+  const uint8_t* buffer = display.getBufferPtr();
+
+  delete[] pixels;
+  pixels = nullptr;
+  totalBytes = 0;
+  glyphs = glyphList;
+  glyphCount = strlen(glyphList) < SPRITE_MAX_GLYPHS ? strlen(glyphList) : SPRITE_MAX_GLYPHS;
+
+  // Pass 1: advance widths and the tile rows any glyph touches. With a page
+  // buffer each glyph is rendered once per page window.
+  uint8_t usedRows = 0;
+  for (uint8_t window = 0; window < SPRITE_PANEL_ROWS; window += tileHeight) {
+    for (uint8_t i = 0; i < glyphCount; i++) {
+      widths[i] = renderGlyph(display, font, baseline, glyphs[i], window);
+
+      for (uint8_t r = 0; r < tileHeight; r++) {
+        const uint8_t* row = buffer + r * SPRITE_ROW_BYTES;
+        for (uint8_t c = 0; c < widths[i]; c++) {
+          if (row[c]) {
+            usedRows |= 1 << (window + r);
+            break;
+          }
+        }
+      }
+    }
+  }
+  display.setBufferCurrTileRow(0);
+
+  if (usedRows == 0) {
+    return false;
+  }
+
+  firstRow = 0;
+  while (!(usedRows & (1 << firstRow))) {
+    firstRow++;
+  }
+  uint8_t lastRow = SPRITE_PANEL_ROWS - 1;
+  while (!(usedRows & (1 << lastRow))) {
+    lastRow--;
+  }
+  bandRows = lastRow - firstRow + 1;
+
+  for (uint8_t i = 0; i < glyphCount; i++) {
+    offsets[i] = totalBytes;
+    totalBytes += widths[i] * bandRows;
+  }
+  pixels = new uint8_t[totalBytes];
+
+  // Pass 2: copy the band out of the buffer
+  for (uint8_t window = 0; window < SPRITE_PANEL_ROWS; window += tileHeight) {
+    for (uint8_t i = 0; i < glyphCount; i++) {
+      renderGlyph(display, font, baseline, glyphs[i], window);
+
+      for (uint8_t r = 0; r < tileHeight; r++) {
+        uint8_t row = window + r;
+        if (row >= firstRow && row <= lastRow) {
+          memcpy(pixels + offsets[i] + (row - firstRow) * widths[i], buffer + r * SPRITE_ROW_BYTES, widths[i]);
+        }
+      }
+    }
+  }
+  display.setBufferCurrTileRow(0);
+  return true;
+}
+
+int GlyphSprites::draw(U8G2& display, int x, const char* text) const {
+  const int start = x;
+  if (!pixels) {
+    return 0;
+  }
+
+  // Only the band rows inside the current page window
+  const uint8_t window = display.getBufferCurrTileRow();
+  const uint8_t windowEnd = window + display.getBufferTileHeight();
+  const uint8_t fromRow = firstRow > window ? firstRow : window;
+  const uint8_t toRow = firstRow + bandRows < windowEnd ? firstRow + bandRows : windowEnd;
+  uint8_t* buffer = display.getBufferPtr();
+
+  for (; *text; text++) {
+    const char* found = strchr(glyphs, *text);
+    if (!found || found - glyphs >= glyphCount) {
+      continue;
+    }
+    const uint8_t i = found - glyphs;
+    const int width = widths[i];
+
+    // Clip to the panel's columns
+    const int fromCol = x < 0 ? -x : 0;
+    const int toCol = x + width > SPRITE_ROW_BYTES ? SPRITE_ROW_BYTES - x : width;
+
+    for (uint8_t row = fromRow; row < toRow; row++) {
+      const uint8_t* src = pixels + offsets[i] + (row - firstRow) * width;
+      uint8_t* dst = buffer + (row - window) * SPRITE_ROW_BYTES + x;
+      for (int c = fromCol; c < toCol; c++) {
+        dst[c] |= src[c];
+      }
+    }
+    x += width;
+  }
+  return x - start;
+}
@@ -0,0 +1,49 @@
+/*
+ * Pre-rendered glyph sprites for Telescope Altimeter
+ * Renders a font's glyphs once at boot and keeps the tile rows they cover,
+ * so the main screen is drawn with byte copies instead of font decoding
+ */
+
+#ifndef SPRITES_H
+#define SPRITES_H
+
+#include <U8g2lib.h>
+
+#define SPRITE_MAX_GLYPHS 20
+
+class GlyphSprites {
+public:
+  GlyphSprites();
+  ~GlyphSprites();
+
+  // Render each character of glyphs (kept by pointer - pass a literal) in
+  // font at the given baseline, and keep the band of tile rows they cover.
+  // Uses the display's buffer as scratch; clear it afterwards.
+  bool capture(U8G2& display, const uint8_t* font, int baseline, const char* glyphs);
+
+  // OR the cached glyphs of text into the buffer at x (clipped to the
+  // buffer's current page window). Returns the advance, like drawStr();
+  // characters that were not captured are skipped.
+  int draw(U8G2& display, int x, const char* text) const;
+
+  // RAM held by the cached pixels
+  uint16_t getBytes() const { return totalBytes; }
+
+private:
+  const char* glyphs;
+  uint8_t glyphCount;
+  uint8_t widths[SPRITE_MAX_GLYPHS];
+  uint16_t offsets[SPRITE_MAX_GLYPHS];
+
+  // Pixels of glyph i: bandRows rows of widths[i] column bytes, in SSD1306 page format
+  uint8_t* pixels;
+  uint16_t totalBytes;
+  uint8_t firstRow;
+  uint8_t bandRows;
+
+  // Render one glyph at x = 0 and the baseline, with the page window on row;
+  // returns its advance
+  int renderGlyph(U8G2& display, const uint8_t* font, int baseline, char glyph, uint8_t row);
+};
+
+#endif // SPRITES_H
@@ -0,0 +1,147 @@
+/*
+ * Binary telemetry implementation for Telescope Altimeter
+ */
+
+#include "telemetry.h"
+
+size_t cobsEncode(const uint8_t* in, size_t length, uint8_t* out) {
+  size_t codeIndex = 0;
+  size_t write = 1;
+  uint8_t code = 1;
+
+  for (size_t i = 0; i < length; i++) {
+    if (in[i] == 0) {
+      out[codeIndex] = code;
+      codeIndex = write++;
+      code = 1;
+      continue;
+    }
+
+    out[write++] = in[i];
+    code++;
+    if (code == 0xFF) {
+      // Block of 254 non-zero bytes: start a new one
+      out[codeIndex] = code;
+      codeIndex = write++;
+      code = 1;
+    }
+  }
+
+  out[codeIndex] = code;
+  return write;
+}
+
+size_t cobsDecode(const uint8_t* in, size_t length, uint8_t* out, size_t maxOut) {
+  size_t read = 0;
+  size_t write = 0;
+
+  while (read < length) {
+    uint8_t code = in[read++];
+    if (code == 0 || read + code - 1 > length) {
+      return 0;
+    }
+
+    for (uint8_t i = 1; i < code; i++) {
+      if (write >= maxOut || in[read] == 0) {
+        return 0;
+      }
+      out[write++] = in[read++];
+    }
+
+    // A short block implies a zero, except at the very end
+    if (code < 0xFF && read < length) {
+      if (write >= maxOut) {
+        return 0;
+      }
+      out[write++] = 0;
+    }
+  }
+
+  return write;
+}
+
+static void putU16(uint8_t* p, uint16_t v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+}
+
+static void putU32(uint8_t* p, uint32_t v) {
+  p[0] = v & 0xFF;
+  p[1] = (v >> 8) & 0xFF;
+  p[2] = (v >> 16) & 0xFF;
+  p[3] = v >> 24;
+}
+
+static void putFloat(uint8_t* p, float v) {
+  uint32_t bits;
+  memcpy(&bits, &v, sizeof(bits));
+  putU32(p, bits);
+}
+
+TelemetryStream::TelemetryStream(HardwareSerial& port)
+  : port(port), enabled(false), sequence(0), sent(0), dropped(0) {
+}
+
+void TelemetryStream::setEnabled(bool on) {
+  if (on && !enabled) {
+    sequence = 0;
+    sent = 0;
+    dropped = 0;
+
+    // Lone delimiter: the decoder starts clean after any text already sent
+    port.write((uint8_t)0);
+  }
+  enabled = on;
+}
+
+void TelemetryStream::sendSample(uint32_t timestampUs, const RawSample& raw, float rawAngle, float filteredAltitude) {
+  if (!enabled) {
+    return;
+  }
+
+  uint8_t record[TELEMETRY_SAMPLE_BYTES];
+  record[0] = TELEMETRY_RECORD_SAMPLE;
+  putU16(&record[1], sequence++);
+  putU32(&record[3], timestampUs);
+  putU16(&record[7], raw.ax);
+  putU16(&record[9], raw.ay);
+  putU16(&record[11], raw.az);
+  putU16(&record[13], raw.gx);
+  putU16(&record[15], raw.gy);
+  putU16(&record[17], raw.gz);
+  putFloat(&record[19], rawAngle);
+  putFloat(&record[23], filteredAltitude);
+
+  sendRecord(record, sizeof(record));
+}
+
+void TelemetryStream::sendPowerChange(uint32_t timestampUs, PowerMode from, PowerMode to, const PowerStats& stats) {
+  if (!enabled) {
+    return;
+  }
+
+  uint8_t record[TELEMETRY_POWER_BYTES];
+  record[0] = TELEMETRY_RECORD_POWER;
+  putU16(&record[1], sequence++);
+  putU32(&record[3], timestampUs);
+  record[7] = (uint8_t)from;
+  record[8] = (uint8_t)to;
+  putFloat(&record[9], stats.averageMilliamps);
+  putFloat(&record[13], stats.savingPercent);
+
+  sendRecord(record, sizeof(record));
+}
+
+void TelemetryStream::sendRecord(const uint8_t* record, size_t length) {
+  if (port.availableForWrite() < (int)COBS_MAX_ENCODED(length) + 1) {
+    // Never stall the sensor task on the UART; the sequence gap shows the loss
+    dropped++;
+    return;
+  }
+
+  uint8_t frame[TELEMETRY_FRAME_BYTES];
+  size_t encoded = cobsEncode(record, length, frame);
+  frame[encoded++] = 0;
+  port.write(frame, encoded);
+  sent++;
+}
@@ -0,0 +1,77 @@
+/*
+ * Binary telemetry for Telescope Altimeter
+ * Streams every sensor sample over Serial as a COBS-framed record, so
+ * full-rate data can be captured and decoded offline (host/telemetry_decode)
+ *
+ * Sample record (27 bytes, little-endian), COBS-encoded, 0x00-terminated:
+ *   0  uint8   record type (TELEMETRY_RECORD_SAMPLE)
+ *   1  uint16  sequence number (gaps = dropped records)
+ *   3  uint32  sample timestamp (us)
+ *   7  int16   ax, ay, az, gx, gy, gz (raw counts)
+ *  19  float   raw angle of this sample (degrees)
+ *  23  float   latest filtered altitude (degrees)
+ *
+ * Power record (17 bytes), sent on every power mode change (power.h):
+ *   0  uint8   record type (TELEMETRY_RECORD_POWER)
+ *   1  uint16  sequence number (shared with the sample records)
+ *   3  uint32  time of the change (micros())
+ *   7  uint8   previous mode (PowerMode)
+ *   8  uint8   new mode
+ *   9  float   estimated average current so far (mA)
+ *  13  float   estimated saving against always-on (%)
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+#include "sensor.h"
+#include "power.h"
+
+#define TELEMETRY_RECORD_SAMPLE 0x01
+#define TELEMETRY_RECORD_POWER 0x02
+#define TELEMETRY_SAMPLE_BYTES 27
+#define TELEMETRY_POWER_BYTES 17
+
+// COBS adds one byte per 254 plus the leading code byte; then the 0x00
+// delimiter. Sized for the sample record, the longest.
+#define COBS_MAX_ENCODED(n) ((n) + (n) / 254 + 1)
+#define TELEMETRY_FRAME_BYTES (COBS_MAX_ENCODED(TELEMETRY_SAMPLE_BYTES) + 1)
+
+// Consistent Overhead Byte Stuffing: the output contains no 0x00 bytes.
+// Returns the encoded length (at most COBS_MAX_ENCODED(length)).
+size_t cobsEncode(const uint8_t* in, size_t length, uint8_t* out);
+
+// Inverse of cobsEncode for one frame without its delimiter. Returns the
+// decoded length, or 0 if the frame is malformed or does not fit.
+size_t cobsDecode(const uint8_t* in, size_t length, uint8_t* out, size_t maxOut);
+
+class TelemetryStream {
+public:
+  TelemetryStream(HardwareSerial& port);
+
+  void setEnabled(bool on);
+  bool isEnabled() const { return enabled; }
+
+  // Queue one sample record; dropped (and counted) if the UART cannot take
+  // the whole frame without blocking
+  void sendSample(uint32_t timestampUs, const RawSample& raw, float rawAngle, float filteredAltitude);
+
+  // Queue one power record for a mode change (same drop policy)
+  void sendPowerChange(uint32_t timestampUs, PowerMode from, PowerMode to, const PowerStats& stats);
+
+  unsigned long getSent() const { return sent; }
+  unsigned long getDropped() const { return dropped; }
+
+private:
+  // COBS-encode and write one record, or count it as dropped
+  void sendRecord(const uint8_t* record, size_t length);
+
+  HardwareSerial& port;
+  bool enabled;
+  uint16_t sequence;
+  unsigned long sent;
+  unsigned long dropped;
+};
+
+#endif // TELEMETRY_H
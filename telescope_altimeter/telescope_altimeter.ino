@@ -24,6 +24,44 @@
 #include "calibration.h"
 #include "display.h"
 #include "button.h"
+#include "scheduler.h"
+#include "bus.h"
+#include "filter.h"
+#include "bench.h"
+#include "profiler.h"
+#include "telemetry.h"
+#include "format.h"
+#include "power.h"
+#include "ui.h"
+#include "lx200.h"
+#include "azimuth.h"
+#include "recorder.h"
+#include "pipeline.h"
+#include "console.h"
+
+// ==================== FUNCTION PROTOTYPES ====================
+
+// The Arduino IDE generates these; declared here so the sketch also builds as plain C++
+void readSensor();
+void runBusSlot();
+bool sendDisplayPage();
+void updateFilter();
+void refreshDisplay();
+void printTaskStats();
+void handleSerial();
+bool lx200Polling();
+void runCommand(const char* command);
+void onIdle();
+void sleepUntilWake();
+void onPowerModeChange();
+void handleButton();
+void onShortPress();
+void onLongPress();
+bool runUiAction(UiAction action);
+const char* captureMessage(const char* prefix);
+void runAzimuthCommand(const char* command);
+void runRecorderCommand(const char* command);
+void setMode(UIMode mode);
 
 // ==================== GLOBAL OBJECTS ====================
 
@@ -31,6 +69,14 @@ TelescopeSensor sensor;
 CalibrationManager calibration(sensor);
 TelescopeDisplay displayManager;
 ButtonHandler button(BUTTON_PIN);
+Scheduler scheduler;
+BusScheduler bus;
+AltitudeFilter altitudeFilter;
+TelemetryStream telemetry(Serial);
+PowerManager power(sensor);
+Lx200Server lx200(Serial);
+AzimuthEncoder azimuthEncoder(AZIMUTH_PIN_A, AZIMUTH_PIN_B);
+TraceRecorder recorder(calibration);
 
 // ==================== STATE VARIABLES ====================
 
@@ -38,17 +84,32 @@ ButtonHandler button(BUTTON_PIN);
 float currentAltitude = 0.0;
 float filteredAltitude = 0.0;
 float rawAngle = 0.0;
+float currentAzimuth = 0.0;
+uint32_t lastSampleUs = 0;
+int32_t lastSampleTicks = 0;  // Azimuth encoder count latched with lastSampleUs
+
+// Angles and tilt-axis gyro counts accumulated by the sensor task since the last filter run
+float pendingAngleSum = 0.0;
+long pendingRateSum = 0;
+int pendingAngleCount = 0;
+uint32_t filteredSampleUs = 0;  // Timestamp of the last sample the filter consumed
 
 // UI state
 UIMode currentMode = MODE_NORMAL;
 
+// Display task id, for the motion-aware refresh rate
+int displayTask = -1;
+
 // ==================== SETUP ====================
 
 void setup() {
   Serial.begin(115200);
   while (!Serial) delay(10);
 
-  Serial.println("\n=== Telescope Altimeter " VERSION_STRING " ===");
+  // Text stays off the port while an LX200 client polls it
+  console.setHold(lx200Polling);
+
+  console.println("\n=== Telescope Altimeter " VERSION_STRING " ===");
 
   // Initialize I2C
   Wire.begin(I2C_SDA, I2C_SCL);
@@ -57,12 +118,16 @@ void setup() {
   // Initialize button
   button.begin();
 
+#if AZIMUTH_ENCODER
+  azimuthEncoder.begin();
+#endif
+
   // Initialize calibration manager (EEPROM)
   calibration.begin();
 
   // Initialize MPU6050
   if (!sensor.begin()) {
-    Serial.println("ERROR: MPU6050 initialization failed!");
+    console.println("ERROR: MPU6050 initialization failed!");
     displayManager.begin();
     displayManager.showError("MPU6050 FAIL");
     while (1) delay(100);
@@ -70,51 +135,129 @@ void setup() {
 
   // Initialize display
   if (!displayManager.begin()) {
-    Serial.println("ERROR: Display initialization failed!");
+    console.println("ERROR: Display initialization failed!");
     while (1) delay(100);
   }
 
   // Load calibration from EEPROM
   calibration.loadFromEEPROM();
+  azimuthEncoder.setCalibration(calibration.getAzimuthCalibration());
+
+  // Black-box trace (starts with the calibration just loaded)
+  recorder.begin();
 
   // Show startup screen
   displayManager.showStartup();
   delay(2000);
 
-  Serial.println("Setup complete!");
-  Serial.println("Ready to measure altitude.");
+#if BENCHMARK_AT_BOOT
+  runBenchmarks(console, BENCHMARK_ITERATIONS, sensor, calibration, displayManager);
+#endif
+
+  // Sensor reads and display pages share the I2C bus on a fixed slot plan
+  bus.setSensorTransfer(readSensor);
+  bus.setDisplayTransfer(sendDisplayPage);
+
+  // Register tasks (bus first so each pass works on fresh samples)
+  scheduler.addTask("bus", runBusSlot, BUS_SLOT_MS, BUS_SLOT_MS);
+  scheduler.addTask("button", handleButton, BUTTON_TASK_PERIOD_MS, BUTTON_TASK_PERIOD_MS);
+  scheduler.addTask("filter", updateFilter, FILTER_TASK_PERIOD_MS, FILTER_TASK_PERIOD_MS);
+  displayTask = scheduler.addTask("display", refreshDisplay, DISPLAY_TASK_PERIOD_MS, DISPLAY_TASK_PERIOD_MS);
+  scheduler.addTask("stats", printTaskStats, STATS_TASK_PERIOD_MS, STATS_TASK_PERIOD_MS);
+  scheduler.addTask("serial", handleSerial, SERIAL_TASK_PERIOD_MS, SERIAL_TASK_PERIOD_MS);
+  scheduler.setIdleCallback(onIdle);
+
+  // Radio off; refresh rate and idling follow the motion from here on
+  power.begin();
+
+  console.println("Setup complete!");
+  printPipeline(console);
+  console.println("Ready to measure altitude.");
   if (calibration.isCalibrated()) {
-    Serial.println("Calibration loaded from EEPROM.");
+    console.println("Calibration loaded from EEPROM.");
   } else {
-    Serial.println("WARNING: Not calibrated! Long press button to calibrate.");
+    console.println("WARNING: Not calibrated! Long press button to calibrate.");
   }
 }
 
 // ==================== MAIN LOOP ====================
 
 void loop() {
-  // Read sensor
-  readSensor();
+  if (power.getMode() == POWER_IDLE) {
+    // Nothing to refresh: light sleep until the sensor or the button wakes us
+    sleepUntilWake();
+    return;
+  }
+
+  // Bus, button, filter and display run as cooperative tasks
+  scheduler.run();
+}
 
-  // Handle button input
-  handleButton();
+// ==================== I2C BUS ====================
 
-  // Update display based on current mode
-  displayManager.update(currentMode, filteredAltitude, rawAngle, calibration.isCalibrated());
+void runBusSlot() {
+  bus.runSlot();
+}
 
-  // Small delay for stability
-  delay(100); // 10 Hz refresh rate
+bool sendDisplayPage() {
+  return displayManager.sendNextPage();
 }
 
 // ==================== SENSOR READING ====================
 
 void readSensor() {
-  // Get reference gravity vector from calibration
-  float refGravityX, refGravityY, refGravityZ;
-  calibration.getReferenceGravity(refGravityX, refGravityY, refGravityZ);
+  // Reference frame is precomputed at calibration time
+  const ReferenceFrame& frame = calibration.getReferenceFrame();
+
+  // Drain every sample that arrived since the last run
+  TimedSample samples[FIFO_BURST_SAMPLES];
+  int n;
+
+  while ((n = sensor.drainSamples(samples, FIFO_BURST_SAMPLES)) > 0) {
+    float angles[FIFO_BURST_SAMPLES];
+    {
+      PROFILE_SCOPE(PROFILE_ANGLE);
+      for (int i = 0; i < n; i++) {
+        const RawSample& raw = samples[i].raw;
+        angles[i] = sensor.calculateRawAngle(raw, frame);
+        pendingAngleSum += angles[i];
+        pendingRateSum += tiltRateKernel(frame, raw.gx, raw.gy, raw.gz);
+      }
+    }
+
+    if (telemetry.isEnabled()) {
+      for (int i = 0; i < n; i++) {
+        telemetry.sendSample(samples[i].timestampUs, samples[i].raw, angles[i], filteredAltitude);
+      }
+    }
+    if (recorder.isRecording()) {
+      for (int i = 0; i < n; i++) {
+        recorder.recordSample(samples[i]);
+      }
+    }
+    lastSampleUs = samples[n - 1].timestampUs;
+    lastSampleTicks = samples[n - 1].azimuthTicks;
+    pendingAngleCount += n;
+  }
+}
 
-  // Calculate raw angle
-  rawAngle = sensor.calculateRawAngle(refGravityX, refGravityY, refGravityZ);
+// ==================== FILTERING ====================
+
+void updateFilter() {
+  if (pendingAngleCount == 0) {
+    return;  // Nothing new since the last run
+  }
+
+  PROFILE_SCOPE(PROFILE_FILTER);
+
+  // Average of all samples since the last filter run
+  rawAngle = pendingAngleSum / pendingAngleCount;
+  float gyroRate = sensor.gyroCountsToDps((float)pendingRateSum / pendingAngleCount);
+  float dt = (lastSampleUs - filteredSampleUs) / 1000000.0;
+  filteredSampleUs = lastSampleUs;
+  pendingAngleSum = 0.0;
+  pendingRateSum = 0;
+  pendingAngleCount = 0;
 
   // Apply calibration if available
   if (calibration.isCalibrated()) {
@@ -124,105 +267,407 @@ void readSensor() {
     currentAltitude = rawAngle;
   }
 
-  // Apply exponential moving average filter
-  if (filteredAltitude == 0.0) {
-    // Initialize filter on first reading
-    filteredAltitude = currentAltitude;
+  // Smooth (and with FILTER_COMPLEMENTARY, fuse the gyro rate)
+  filteredAltitude = altitudeFilter.update(currentAltitude, gyroRate, dt);
+  lx200.setAltitude(filteredAltitude);
+  recorder.recordFilter(rawAngle, filteredAltitude, filteredSampleUs, altitudeFilter);
+
+  // The encoder needs no smoothing; its count was latched with the newest sample
+  currentAzimuth = azimuthEncoder.toDegrees(lastSampleTicks);
+  lx200.setAzimuth(currentAzimuth);
+
+  // Menus, messages, pending flash commits and a polling LX200 client keep
+  // the full refresh rate (and the chip awake to answer)
+  bool busy = currentMode != MODE_NORMAL || displayManager.isOverlayActive() || calibration.hasPendingCommit() ||
+              lx200.isActive();
+  if (power.update(rawAngle, gyroRate - altitudeFilter.getGyroBias(), busy)) {
+    onPowerModeChange();
+  }
+}
+
+// ==================== POWER ====================
+
+void sleepUntilWake() {
+  power.sleep();
+
+  // Light sleep reprograms the button and encoder pins for level wake-up
+  button.rearm();
+#if AZIMUTH_ENCODER
+  bool turned = azimuthEncoder.rearm();
+#else
+  bool turned = false;
+#endif
+
+  RawSample sample;
+  uint8_t events = sensor.readWakeEvents(sample);
+  float angle = rawAngle;
+  if (events & SENSOR_EVENT_SAMPLE) {
+    angle = sensor.calculateRawAngle(sample, calibration.getReferenceFrame());
+  }
+
+  // The UART keeps receiving while asleep; a held button, an azimuth turn
+  // or a polling LX200 client wakes straight to MOVING
+  handleSerial();
+
+  if (power.onWake(events, angle, button.isPressed() || turned || lx200.isActive())) {
+    onPowerModeChange();
+  }
+}
+
+void onPowerModeChange() {
+  PowerMode mode = power.getMode();
+  uint32_t now = micros();
+  recorder.recordPowerChange(now, power.getPreviousMode(), mode);
+
+  if (mode == POWER_IDLE) {
+    // The bus slots stop: put the rest of the last frame on the screen, and
+    // the trace so far into flash (no idle passes until the next wake-up)
+    displayManager.flush();
+    recorder.flush();
+  } else if (power.getPreviousMode() == POWER_IDLE) {
+    // The FIFO restarted; nothing is pending from before the idle
+    pendingAngleSum = 0.0;
+    pendingRateSum = 0;
+    pendingAngleCount = 0;
+    filteredSampleUs = now;
+  }
+  scheduler.setPeriod(displayTask, mode == POWER_MOVING ? DISPLAY_TASK_PERIOD_MS : DISPLAY_STILL_PERIOD_MS);
+
+  PowerStats stats;
+  power.getStats(stats);
+  if (telemetry.isEnabled()) {
+    telemetry.sendPowerChange(now, power.getPreviousMode(), mode, stats);
   } else {
-    filteredAltitude = ALPHA * currentAltitude + (1.0 - ALPHA) * filteredAltitude;
+    console.print("Power: ");
+    console.print(powerModeName(power.getPreviousMode()));
+    console.print(" -> ");
+    console.print(powerModeName(mode));
+    console.print(" (");
+    console.print(stats.savingPercent, 0);
+    console.println("% saved so far)");
   }
 }
 
-// ==================== BUTTON HANDLING ====================
+// ==================== DISPLAY ====================
 
-void handleButton() {
-  button.update();
+void refreshDisplay() {
+  // Render only - the changed pages go out in the bus slots
+  displayManager.update(currentMode, filteredAltitude, rawAngle, calibration.isCalibrated());
+}
+
+void printTaskStats() {
+  scheduler.printStats(console);
+}
+
+void onIdle() {
+  // LX200 clients time their polls: answer on the next free loop pass
+  // rather than the next serial task run
+  handleSerial();
+
+  // Flash commits block for tens of ms - only do them when nothing is due
+  if (calibration.hasPendingCommit()) {
+    calibration.commitPending();
+  } else if (recorder.hasPendingCommit()) {
+    recorder.commitPending();
+  }
+}
+
+// ==================== SERIAL COMMANDS ====================
+
+bool lx200Polling() {
+  return lx200.isActive();
+}
+
+char commandLine[SERIAL_COMMAND_LENGTH + 1];
+int commandLength = 0;
+
+void handleSerial() {
+  lx200.flush();
 
-  if (button.wasShortPressed()) {
-    onShortPress();
+  while (Serial.available() > 0) {
+    char c = Serial.read();
+
+    // LX200 commands (':...#', ACK) are answered at once; they only start
+    // between text lines
+    if (commandLength == 0 && lx200.feed(c)) {
+      continue;
+    }
+
+    if (c == '\r' || c == '\n') {
+      if (commandLength > 0) {
+        commandLine[commandLength] = '\0';
+        runCommand(commandLine);
+        commandLength = 0;
+      }
+    } else if (commandLength < SERIAL_COMMAND_LENGTH) {
+      commandLine[commandLength++] = c;
+    }
   }
+}
 
-  if (button.wasLongPressed()) {
-    onLongPress();
+void runCommand(const char* command) {
+  if (strcmp(command, "prof") == 0) {
+    profilePrint(console);
+  } else if (strcmp(command, "prof reset") == 0) {
+    profileReset();
+    console.println("Profile cleared");
+  } else if (strcmp(command, "stats") == 0) {
+    scheduler.printStats(console);
+  } else if (strcmp(command, "bus") == 0) {
+    bus.printStats(console);
+  } else if (strcmp(command, "bus reset") == 0) {
+    bus.resetStats();
+    console.println("Bus stats cleared");
+  } else if (strcmp(command, "tel on") == 0) {
+    // Binary from here on - decode the capture with host/telemetry_decode
+    telemetry.setEnabled(true);
+  } else if (strcmp(command, "tel off") == 0) {
+    telemetry.setEnabled(false);
+    console.println();
+    console.print("Telemetry: ");
+    console.print(telemetry.getSent());
+    console.print(" sent, ");
+    console.print(telemetry.getDropped());
+    console.println(" dropped");
+  } else if (strcmp(command, "power") == 0) {
+    power.printStats(console);
+  } else if (strcmp(command, "power reset") == 0) {
+    power.resetStats();
+    console.println("Power stats cleared");
+  } else if (strcmp(command, "power on") == 0) {
+    power.setEnabled(true);
+    console.println("Idle allowed");
+  } else if (strcmp(command, "power off") == 0) {
+    power.setEnabled(false);
+    console.println("Idle off");
+  } else if (strncmp(command, "az", 2) == 0 && (command[2] == '\0' || command[2] == ' ')) {
+    runAzimuthCommand(command + 2);
+  } else if (strncmp(command, "rec", 3) == 0 && (command[3] == '\0' || command[3] == ' ')) {
+    runRecorderCommand(command + 3);
+  } else {
+    console.print("Unknown command: ");
+    console.println(command);
+    console.println("Commands: prof, prof reset, stats, bus, bus reset, tel on, tel off, power, power reset, power on, power off, "
+                   "az, az reset, az sync DEG, az cpr N, az rev, rec, rec on, rec off, rec dump");
   }
 }
 
+// Count at the start of an "az rev" turn (measuring while azimuthRevStarted)
+int32_t azimuthRevStart = 0;
+bool azimuthRevStarted = false;
+
+void runAzimuthCommand(const char* command) {
+  while (*command == ' ') {
+    command++;
+  }
+
+  if (*command == '\0') {
+    azimuthEncoder.printStats(console);
+  } else if (strcmp(command, "reset") == 0) {
+    azimuthEncoder.resetStats();
+    console.println("Encoder stats cleared");
+  } else if (strncmp(command, "sync ", 5) == 0) {
+    // The current position is this azimuth (a known target or landmark)
+    azimuthEncoder.sync(azimuthEncoder.getTicks(), atof(command + 5));
+    azimuthEncoder.printStats(console);
+  } else if (strncmp(command, "cpr ", 4) == 0) {
+    AzimuthCalibration scale = {(int32_t)atol(command + 4)};
+    azimuthEncoder.setCalibration(scale);
+    calibration.saveAzimuthCalibration(scale);
+    recorder.recordCalibration();
+  } else if (strcmp(command, "rev") == 0 && !azimuthRevStarted) {
+    azimuthRevStart = azimuthEncoder.getTicks();
+    azimuthRevStarted = true;
+    console.println("Turn one full revolution east (clockwise from above) back to the same mark, then 'az rev' again");
+  } else if (strcmp(command, "rev") == 0) {
+    azimuthRevStarted = false;
+    int32_t ticks = azimuthEncoder.getTicks() - azimuthRevStart;
+    if (abs(ticks) < AZIMUTH_MIN_TICKS_PER_REV) {
+      console.print("Only ");
+      console.print(ticks);
+      console.println(" ticks - not calibrated (encoder wired?)");
+      return;
+    }
+    AzimuthCalibration scale = {ticks};
+    azimuthEncoder.setCalibration(scale);
+    azimuthEncoder.sync(azimuthEncoder.getTicks(), 0.0);
+    calibration.saveAzimuthCalibration(scale);
+    recorder.recordCalibration();
+    console.print(ticks);
+    console.println(" ticks/rev; 'az sync DEG' sets the heading");
+  } else {
+    console.print("Unknown azimuth command: ");
+    console.println(command);
+  }
+}
+
+void runRecorderCommand(const char* command) {
+  while (*command == ' ') {
+    command++;
+  }
+
+  if (*command == '\0') {
+    recorder.printStats(console);
+  } else if (strcmp(command, "on") == 0) {
+    recorder.start();
+    console.println(recorder.isRecording() ? "Recording (new segment)" : "Cannot record: no file system");
+  } else if (strcmp(command, "off") == 0) {
+    recorder.stop();
+    console.println("Recording stopped");
+  } else if (strcmp(command, "dump") == 0) {
+    // Capture the port to a file and read it with host/flash_replay (binary,
+    // so like telemetry it goes straight to Serial)
+    recorder.dump(Serial);
+  } else {
+    console.print("Unknown recorder command: ");
+    console.println(command);
+  }
+}
+
+// ==================== BUTTON HANDLING ====================
+
+void handleButton() {
+  PROFILE_SCOPE(PROFILE_BUTTON);
+
+  // Everything the ISR queued since the last run, however long that was
+  ButtonEvent event;
+  while (button.nextEvent(event)) {
+    recorder.recordButton(event);
+    switch (event.type) {
+      case BUTTON_SHORT_PRESS:
+        onShortPress();
+        break;
+
+      case BUTTON_LONG_PRESS:
+        onLongPress();
+        break;
+
+      case BUTTON_DOUBLE_PRESS:
+        // No action of its own yet; each of the two presses still counts
+        console.println("Button: Double press");
+        break;
+
+      default:
+        break;
+    }
+  }
+}
+
+// Row of the last short press; its overlay text points into it
+UiTransition pressTransition;
+
 void onShortPress() {
-  Serial.println("Button: Short press");
-
-  switch (currentMode) {
-    case MODE_NORMAL:
-      if (calibration.isCalibrated()) {
-        // Start two-point session sync
-        currentMode = MODE_SESSION_SYNC_A;
-      } else {
-        displayManager.showMessage("ERROR", "Not calibrated!");
-        delay(1500);
-      }
-      break;
+  console.println("Button: Short press");
 
-    case MODE_SESSION_SYNC_A:
-      // Sync at Stop A
-      displayManager.showMessage("SYNCING...", "Please wait");
-      calibration.syncAtStopA();
-      displayManager.showMessage("STOP A", "Synced!");
-      delay(1000);
-      currentMode = MODE_SESSION_SYNC_B;
-      break;
+  if (displayManager.isOverlayActive()) {
+    // First press just acknowledges the message
+    displayManager.dismissOverlay();
+    return;
+  }
 
-    case MODE_SESSION_SYNC_B:
-      // Sync at Stop B
-      displayManager.showMessage("SYNCING...", "Please wait");
-      calibration.syncAtStopB();
-      displayManager.showMessage("SYNCED!", "Ready to observe");
-      delay(1500);
-      currentMode = MODE_NORMAL;
-      break;
+  UiTransition& transition = pressTransition;
+  uiGetTransition(currentMode, transition);
 
-    case MODE_CALIBRATION_MENU:
-      // Start zero calibration
-      currentMode = MODE_ZERO_CALIBRATION;
-      break;
+  if (transition.busyTitle[0] != '\0') {
+    // The action blocks for a capture: say so first
+    displayManager.showMessage(transition.busyTitle, "Please wait");
+  }
 
-    case MODE_ZERO_CALIBRATION:
-      displayManager.showMessage("MEASURING...", "Please wait");
+  if (!runUiAction((UiAction)transition.action)) {
+    displayManager.showOverlay("ERROR", transition.failMessage, MESSAGE_MS);
+    return;
+  }
+
+  if (transition.doneTitle[0] != '\0') {
+    displayManager.showOverlay(transition.doneTitle, captureMessage(transition.donePrefix), transition.doneMs);
+  }
+  setMode((UIMode)transition.next);
+}
+
+void setMode(UIMode mode) {
+  if (mode != currentMode) {
+    currentMode = mode;
+    recorder.recordUiMode(mode);
+  }
+}
+
+bool runUiAction(UiAction action) {
+  switch (action) {
+    case UI_ACTION_NONE:
+      return true;
+
+    case UI_ACTION_REQUIRE_CALIBRATION:
+      return calibration.isCalibrated();
+
+    case UI_ACTION_CALIBRATE_ZERO:
       calibration.calibrateZero();
-      displayManager.showMessage("ZERO SET", "");
-      delay(1500);
-      currentMode = MODE_STOP_A_CALIBRATION;
       break;
 
-    case MODE_STOP_A_CALIBRATION:
-      displayManager.showMessage("MEASURING...", "Please wait");
+    case UI_ACTION_CALIBRATE_STOP_A:
       calibration.calibrateStopA();
-      displayManager.showMessage("STOP A SET", "");
-      delay(1500);
-      currentMode = MODE_STOP_B_CALIBRATION;
       break;
 
-    case MODE_STOP_B_CALIBRATION:
-      displayManager.showMessage("MEASURING...", "Please wait");
+    case UI_ACTION_CALIBRATE_STOP_B:
       calibration.calibrateStopB();
       calibration.saveToEEPROM();
-      displayManager.showMessage("CALIBRATED!", "Saved to memory");
-      delay(2000);
-      currentMode = MODE_NORMAL;
+      break;
+
+    case UI_ACTION_SYNC_STOP_A:
+      calibration.syncAtStopA();
+      break;
+
+    case UI_ACTION_SYNC_STOP_B:
+      calibration.syncAtStopB();
       break;
   }
+
+  // Every capture moves the reference: start the filter over
+  altitudeFilter.reset();
+  recorder.recordCalibration();
+  recorder.recordFilterReset();
+  return true;
+}
+
+// Overlay text with the uncertainty of the last capture, e.g. "Synced! ±0.4'"
+char captureText[24];
+
+const char* captureMessage(const char* prefix) {
+  const CaptureResult& capture = calibration.getLastCapture();
+
+  int length = 0;
+  while (*prefix) {
+    captureText[length++] = *prefix++;
+  }
+  if (length > 0) {
+    captureText[length++] = ' ';
+  }
+
+  // Standard error in tenths of an arcminute
+  float tenths = capture.standardError * 600.0;
+  captureText[length++] = '\xB1';
+  length += formatTenths(captureText + length, tenths < 999.0 ? (int32_t)(tenths + 0.5) : 999);
+  captureText[length++] = '\'';
+
+  if (!capture.converged) {
+    strcpy(captureText + length, " NOISY");
+  } else {
+    captureText[length] = '\0';
+  }
+  return captureText;
 }
 
 void onLongPress() {
-  Serial.println("Button: Long press");
+  console.println("Button: Long press");
+
+  UiTransition transition;
+  uiGetTransition(currentMode, transition);
+  setMode((UIMode)transition.longNext);
 
-  if (currentMode == MODE_NORMAL) {
-    // Enter calibration menu
-    currentMode = MODE_CALIBRATION_MENU;
-    Serial.println("Entering calibration mode");
+  if (transition.longCancels) {
+    // Cancel calibration/sync and return
+    console.println("Operation cancelled");
+    displayManager.showOverlay("CANCELLED", "", MESSAGE_SHORT_MS);
   } else {
-    // Cancel calibration/sync and return to normal
-    currentMode = MODE_NORMAL;
-    Serial.println("Operation cancelled");
-    displayManager.showMessage("CANCELLED", "");
-    delay(1000);
+    console.println("Entering calibration mode");
   }
 }
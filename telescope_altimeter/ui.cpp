@@ -0,0 +1,55 @@
+/*
+ * UI tables for Telescope Altimeter
+ */
+
+#include "ui.h"
+#include "config.h"
+
+static const UiScreen screens[UI_MODE_COUNT] PROGMEM = {
+  // MODE_NORMAL
+  {"ALTITUDE", {"", "", ""}, "\xB0", LIVE_ALTITUDE},
+  // MODE_CALIBRATION_MENU
+  {"CALIBRATION", {"1. Level telescope", "2. Press button", "Hold to cancel"}, "", LIVE_NONE},
+  // MODE_ZERO_CALIBRATION
+  {"STEP 1: ZERO", {"Level telescope", "with bubble level", "Press when ready"}, "\xB0", LIVE_RAW_ANGLE},
+  // MODE_STOP_A_CALIBRATION
+  {"STEP 2: STOP A", {"Move to Stop A", "(low position)", "Press when ready"}, "o", LIVE_RAW_ANGLE},
+  // MODE_STOP_B_CALIBRATION
+  {"STEP 3: STOP B", {"Move to Stop B", "(high position)", "Press when ready"}, "o", LIVE_RAW_ANGLE},
+  // MODE_SESSION_SYNC_A
+  {"SESSION SYNC", {"Move to Stop A", "(low position)", "Press when ready"}, "o", LIVE_RAW_ANGLE},
+  // MODE_SESSION_SYNC_B
+  {"SESSION SYNC", {"Move to Stop B", "(high position)", "Press when ready"}, "o", LIVE_RAW_ANGLE},
+};
+
+static const UiTransition transitions[UI_MODE_COUNT] PROGMEM = {
+  // MODE_NORMAL: start a session sync
+  {UI_ACTION_REQUIRE_CALIBRATION, MODE_SESSION_SYNC_A, MODE_CALIBRATION_MENU, false, 0,
+   "", "", "", "Not calibrated!"},
+  // MODE_CALIBRATION_MENU
+  {UI_ACTION_NONE, MODE_ZERO_CALIBRATION, MODE_NORMAL, true, 0,
+   "", "", "", ""},
+  // MODE_ZERO_CALIBRATION
+  {UI_ACTION_CALIBRATE_ZERO, MODE_STOP_A_CALIBRATION, MODE_NORMAL, true, MESSAGE_MS,
+   "MEASURING...", "ZERO SET", "", ""},
+  // MODE_STOP_A_CALIBRATION
+  {UI_ACTION_CALIBRATE_STOP_A, MODE_STOP_B_CALIBRATION, MODE_NORMAL, true, MESSAGE_MS,
+   "MEASURING...", "STOP A SET", "", ""},
+  // MODE_STOP_B_CALIBRATION
+  {UI_ACTION_CALIBRATE_STOP_B, MODE_NORMAL, MODE_NORMAL, true, MESSAGE_LONG_MS,
+   "MEASURING...", "CALIBRATED!", "Saved", ""},
+  // MODE_SESSION_SYNC_A
+  {UI_ACTION_SYNC_STOP_A, MODE_SESSION_SYNC_B, MODE_NORMAL, true, MESSAGE_SHORT_MS,
+   "SYNCING...", "STOP A", "Synced!", ""},
+  // MODE_SESSION_SYNC_B
+  {UI_ACTION_SYNC_STOP_B, MODE_NORMAL, MODE_NORMAL, true, MESSAGE_MS,
+   "SYNCING...", "SYNCED!", "Ready", ""},
+};
+
+void uiGetScreen(UIMode mode, UiScreen& screen) {
+  memcpy_P(&screen, &screens[mode], sizeof(UiScreen));
+}
+
+void uiGetTransition(UIMode mode, UiTransition& transition) {
+  memcpy_P(&transition, &transitions[mode], sizeof(UiTransition));
+}
@@ -0,0 +1,80 @@
+/*
+ * UI tables for Telescope Altimeter
+ * Each UIMode is a row of data: the screen it shows and what the button
+ * does in it. Both tables live in flash (PROGMEM); adding a mode means
+ * adding a row to each.
+ */
+
+#ifndef UI_H
+#define UI_H
+
+#include <Arduino.h>
+
+// UI Modes (row index into both tables)
+enum UIMode {
+  MODE_NORMAL,
+  MODE_CALIBRATION_MENU,
+  MODE_ZERO_CALIBRATION,
+  MODE_STOP_A_CALIBRATION,
+  MODE_STOP_B_CALIBRATION,
+  MODE_SESSION_SYNC_A,
+  MODE_SESSION_SYNC_B
+};
+
+#define UI_MODE_COUNT 7
+
+// Live value drawn under a screen's instructions
+enum UiLiveValue {
+  LIVE_NONE,
+  LIVE_RAW_ANGLE,  // "Raw: 12.3" and the screen's degree mark
+  LIVE_ALTITUDE    // The main altitude screen (drawn from sprites)
+};
+
+#define UI_SCREEN_LINES 3
+#define UI_TITLE_LENGTH 16
+#define UI_LINE_LENGTH 20
+
+// Title in the yellow zone, up to three instruction lines in the blue zone
+// (empty lines are skipped) and the live value at the bottom
+struct UiScreen {
+  char title[UI_TITLE_LENGTH];
+  char lines[UI_SCREEN_LINES][UI_LINE_LENGTH];
+  char degreeMark[2];
+  uint8_t live;  // UiLiveValue
+};
+
+// Work a short press starts; the sketch runs it (runUiAction())
+enum UiAction {
+  UI_ACTION_NONE,
+  UI_ACTION_REQUIRE_CALIBRATION,  // Refuses (fail overlay) when not calibrated
+  UI_ACTION_CALIBRATE_ZERO,
+  UI_ACTION_CALIBRATE_STOP_A,
+  UI_ACTION_CALIBRATE_STOP_B,     // ...and save the calibration
+  UI_ACTION_SYNC_STOP_A,
+  UI_ACTION_SYNC_STOP_B
+};
+
+#define UI_MESSAGE_LENGTH 16
+#define UI_PREFIX_LENGTH 8
+
+// What the button does in a mode. A short press shows busyTitle (if any)
+// while the action blocks, then moves to next and shows a timed overlay of
+// doneTitle and the capture uncertainty; if the action refuses it stays and
+// shows failMessage instead. A long press moves to longNext.
+struct UiTransition {
+  uint8_t action;      // UiAction
+  uint8_t next;        // UIMode after a short press
+  uint8_t longNext;    // UIMode after a long press
+  bool longCancels;    // Long press shows "CANCELLED"
+  uint16_t doneMs;
+  char busyTitle[UI_MESSAGE_LENGTH];
+  char doneTitle[UI_MESSAGE_LENGTH];
+  char donePrefix[UI_PREFIX_LENGTH];  // Before the uncertainty, e.g. "Synced"
+  char failMessage[UI_MESSAGE_LENGTH];
+};
+
+// Copy a mode's row out of flash
+void uiGetScreen(UIMode mode, UiScreen& screen);
+void uiGetTransition(UIMode mode, UiTransition& transition);
+
+#endif // UI_H